@@ -1,8 +1,35 @@
 #include <cpp-terminal/window.hpp>
+#include <charconv>
 #include <stdexcept>
 #include "private/conversion.hpp"
 
 namespace Term {
+namespace {
+// Longest run of unchanged cells rewritten instead of moving the cursor over
+// them; a cursor movement costs about as many bytes.
+constexpr size_t max_rewrite_gap = 6;
+
+void append_number(std::string& out, size_t value) {
+    char digits[20];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    out.append(digits, result.ptr);
+}
+
+void append_sgr(std::string& out, int code) {
+    out.append("\x1b[");
+    append_number(out, code);
+    out.push_back('m');
+}
+
+void append_move_cursor(std::string& out, size_t row, size_t col) {
+    out.append("\x1b[");
+    append_number(out, row);
+    out.push_back(';');
+    append_number(out, col);
+    out.push_back('H');
+}
+}  // namespace
+
 char32_t Term::Window_24bit::get_char(size_t x, size_t y) {
     return chars[(y - 1) * w + (x - 1)];
 }
@@ -492,64 +519,122 @@ void Term::Window::clear() {
     }
 }
 
-std::string Term::Window::render(int x0, int y0, bool term) {
-    std::string out;
-    if (term) {
-        out.append(cursor_off());
+bool Term::Window::cell_changed(size_t index) {
+    return chars[index] != last_chars[index] || m_fg[index] != last_fg[index] ||
+           m_bg[index] != last_bg[index] ||
+           m_style[index] != last_style[index];
+}
+
+void Term::Window::save_frame() {
+    last_chars = chars;
+    last_fg = m_fg;
+    last_bg = m_bg;
+    last_style = m_style;
+    last_cursor_x = cursor_x;
+    last_cursor_y = cursor_y;
+    has_last_frame = true;
+}
+
+void Term::Window::invalidate() {
+    has_last_frame = false;
+}
+
+const std::string& Term::Window::render(int x0, int y0, bool term) {
+    render_buffer.clear();
+    std::string& out = render_buffer;
+    bool full = !has_last_frame || last_chars.size() != chars.size();
+
+    if (!term) {
+        // Without cursor control there is no way to patch the previous
+        // output, so only skip frames that did not change
+        if (!full && chars == last_chars && m_fg == last_fg &&
+            m_bg == last_bg && m_style == last_style) {
+            return out;
+        }
     }
+
     fg current_fg = fg::reset;
     bg current_bg = bg::reset;
     style current_style = style::reset;
-    for (size_t j = 1; j <= h; j++) {
-        if (term) {
-            out.append(move_cursor(y0 + j - 1, x0));
+
+    auto write_cell = [&](size_t index) {
+        // Set style first, as style::reset will reset colors too. Styles
+        // add up on the terminal, so switching between two of them needs a
+        // reset in between.
+        if (current_style != m_style[index]) {
+            if (current_style != style::reset) {
+                append_sgr(out, static_cast<int>(style::reset));
+                current_fg = fg::reset;
+                current_bg = bg::reset;
+            }
+            current_style = m_style[index];
+            if (current_style != style::reset) {
+                append_sgr(out, static_cast<int>(current_style));
+            }
+        }
+        if (current_fg != m_fg[index]) {
+            current_fg = m_fg[index];
+            append_sgr(out, static_cast<int>(current_fg));
+        }
+        if (current_bg != m_bg[index]) {
+            current_bg = m_bg[index];
+            append_sgr(out, static_cast<int>(current_bg));
         }
+        Private::codepoint_to_utf8(out, chars[index]);
+    };
+
+    // Terminal cursor position, 0 when unknown
+    size_t term_x = 0;
+    size_t term_y = 0;
+    bool wrote = false;
+
+    for (size_t j = 1; j <= h; j++) {
+        size_t row = (j - 1) * w;
         for (size_t i = 1; i <= w; i++) {
-            bool update_fg = false;
-            bool update_bg = false;
-            bool update_style = false;
-            if (current_fg != get_fg(i, j)) {
-                current_fg = get_fg(i, j);
-                update_fg = true;
+            if (term && !full && !cell_changed(row + i - 1)) {
+                continue;
             }
-            if (current_bg != get_bg(i, j)) {
-                current_bg = get_bg(i, j);
-                update_bg = true;
+
+            if (!wrote && term) {
+                out.append(cursor_off());
             }
-            if (current_style != get_style(i, j)) {
-                current_style = get_style(i, j);
-                update_style = true;
-                if (current_style == style::reset) {
-                    // style::reset resets fg and bg colors too, we have to
-                    // set them again if they are non-default, but if fg or
-                    // bg colors are reset, we do not update them, as
-                    // style::reset already did that.
-                    update_fg = (current_fg != fg::reset);
-                    update_bg = (current_bg != bg::reset);
+            wrote = true;
+
+            if (!term) {
+                if (i == 1 && j > 1) {
+                    out.push_back('\n');
+                }
+            } else if (term_y == j && term_x <= i &&
+                       i - term_x <= max_rewrite_gap) {
+                // Rewriting a few unchanged cells is cheaper than moving
+                for (size_t k = term_x; k < i; k++) {
+                    write_cell(row + k - 1);
                 }
+            } else {
+                append_move_cursor(out, y0 + j - 1, x0 + i - 1);
             }
-            // Set style first, as style::reset will reset colors too
-            if (update_style)
-                out.append(color(get_style(i, j)));
-            if (update_fg)
-                out.append(color(get_fg(i, j)));
-            if (update_bg)
-                out.append(color(get_bg(i, j)));
-            Private::codepoint_to_utf8(out, get_char(i, j));
+
+            write_cell(row + i - 1);
+            term_x = i + 1;
+            term_y = j;
         }
-        if (j < h)
-            out.append("\n");
     }
+
     if (current_fg != fg::reset)
         out.append(color(fg::reset));
     if (current_bg != bg::reset)
         out.append(color(bg::reset));
     if (current_style != style::reset)
         out.append(color(style::reset));
-    if (term) {
-        out.append(move_cursor(y0 + cursor_y - 1, x0 + cursor_x - 1));
-        out.append(cursor_on());
+    if (term && (wrote || cursor_x != last_cursor_x ||
+                 cursor_y != last_cursor_y)) {
+        append_move_cursor(out, y0 + cursor_y - 1, x0 + cursor_x - 1);
+        if (wrote) {
+            out.append(cursor_on());
+        }
     }
+
+    save_frame();
     return out;
-};
+}
 }  // namespace Term
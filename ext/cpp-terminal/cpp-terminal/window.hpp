@@ -111,8 +111,23 @@ class Window {
     std::vector<bg> m_bg;
     std::vector<style> m_style;
 
+    // Last frame emitted by render(), used to only write what changed
+    bool has_last_frame{false};
+    size_t last_cursor_x{}, last_cursor_y{};
+    std::vector<char32_t> last_chars;
+    std::vector<fg> last_fg;
+    std::vector<bg> last_bg;
+    std::vector<style> last_style;
+
+    // Output of render(), reused between frames
+    std::string render_buffer;
+
     char32_t get_char(size_t, size_t);
 
+    bool cell_changed(size_t);
+
+    void save_frame();
+
     fg get_fg(size_t, size_t);
 
     bg get_bg(size_t, size_t);
@@ -160,10 +175,15 @@ class Window {
 
     void clear();
 
-    // TODO: add Window/Screen parameter here, to be used like this:
-    // old_scr = scr;
-    // scr.print_str(...)
-    // scr.render(1, 1, old_scr)
-    std::string render(int, int, bool);
+    // Forget the last frame, so the next render() writes every cell again.
+    // Use it when something else wrote to the terminal.
+    void invalidate();
+
+    // Returns what has to be written to bring the terminal from the last
+    // rendered frame to the current one: only the changed cells, with minimal
+    // cursor movement and color changes. The returned buffer is reused by the
+    // next call. Without terminal control (term = false) unchanged frames
+    // render to nothing and changed frames are written whole.
+    const std::string& render(int, int, bool);
 };
 }  // namespace Term
@@ -4,13 +4,17 @@
 #define BLAMITE__CONSOLE__COMMAND_HPP
 
 #include <string>
+#include <string_view>
+#include <vector>
 #include <functional>
 #include <cstdint>
 
 namespace Blamite::Engine {
     class ConsoleCommand {
     public:
-        using function_t = std::function<bool (std::vector<std::string> &)>;
+        /** Command arguments; every view is null-terminated, so data() can be used as a C string */
+        using arguments_t = std::vector<std::string_view>;
+        using function_t = std::function<bool (arguments_t &)>;
 
         enum Result : std::uint8_t {
             COMMAND_RESULT_SUCCESS,
@@ -22,12 +26,24 @@ namespace Blamite::Engine {
         /**
          * Get command name
          */
-        std::string name() noexcept;
+        const std::string &name() const noexcept;
+
+        /**
+         * Check if command can run on a worker thread instead of the tick thread
+         */
+        bool run_in_background() const noexcept;
 
         /**
          * Execute command function
          */
-        Result execute(std::string args) noexcept;
+        Result execute(arguments_t &args) noexcept;
+
+        /**
+         * Split a command line into arguments
+         * Quotes and escapes are resolved in place and every argument is null-terminated inside the line, so the
+         * line must outlive the arguments. Arguments vector is cleared first and can be reused between calls.
+         */
+        static void split_arguments(std::string &line, arguments_t &args) noexcept;
 
         /**
          * Constructor for command
@@ -35,8 +51,9 @@ namespace Blamite::Engine {
          * @param min_args  Minimum arguments for command function
          * @param max_args  Maximum arguments for command function
          * @param function  Function to be executed
+         * @param run_in_background     Function does not touch engine state and can run on a worker thread
          */
-        ConsoleCommand(std::string name, std::size_t min_args, std::size_t max_args, function_t function) noexcept;
+        ConsoleCommand(std::string name, std::size_t min_args, std::size_t max_args, function_t function, bool run_in_background = false) noexcept;
 
     private:
         /** Command name */
@@ -49,15 +66,10 @@ namespace Blamite::Engine {
         std::size_t m_max_args;
 
         /** Execute command function in another thread */
-        bool run_in_background;
+        bool m_run_in_background;
 
         /** Command function */
         function_t m_function;
-
-        /**
-         * Split command arguments
-         */
-        static std::vector<std::string> split_arguments(std::string args) noexcept;
     };
 
     namespace Commands {}
@@ -0,0 +1,172 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BLAMITE__CONSOLE__COMMAND_JOBS_HPP
+#define BLAMITE__CONSOLE__COMMAND_JOBS_HPP
+
+#include <mutex>
+#include <deque>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <string>
+#include <functional>
+#include <condition_variable>
+#include "command.hpp"
+#include "command_output.hpp"
+
+namespace Blamite::Engine {
+    /**
+     * Worker threads for console commands that are safe to run away from the tick thread.
+     * Jobs are queued and picked up in order by a small pool of workers, started on first use. Commands print
+     * through the console, which is safe from any thread, and should check cancelled() while working.
+     */
+    class CommandJobs {
+    public:
+        using job_id_t = std::uint32_t;
+
+        /** Called on each worker thread when it starts */
+        using thread_init_t = std::function<void ()>;
+
+        /** Called on the worker once the command returns */
+        using finish_t = std::function<void (const ConsoleCommand &, ConsoleCommand::Result, bool cancelled)>;
+
+        struct JobInfo {
+            /** Job identifier */
+            job_id_t id;
+
+            /** Command name */
+            std::string name;
+
+            /** Command line */
+            std::string line;
+
+            /** Job was picked up by a worker */
+            bool running;
+
+            /** Job was asked to stop */
+            bool cancelled;
+
+            /** Time since job was queued */
+            std::chrono::steady_clock::duration age;
+        };
+
+        /**
+         * Queue a command
+         * @param command   Command to run
+         * @param line      Command line; it is copied and split again for the job
+         * @param output    Output to collect what the command prints, or null to print to the console
+         * @return          Job identifier
+         */
+        job_id_t submit(ConsoleCommand &command, std::string_view line, std::shared_ptr<CommandOutput> output = nullptr) noexcept;
+
+        /**
+         * Ask a job to stop; queued jobs are dropped without running
+         * @return      False if there is no such job
+         */
+        bool cancel(job_id_t id) noexcept;
+
+        /**
+         * Get queued and running jobs
+         */
+        std::vector<JobInfo> list() const noexcept;
+
+        /**
+         * Set function run by each worker thread before its first job
+         * NOTE: Workers start on first submit; this has no effect on workers already running
+         */
+        void set_thread_init(thread_init_t thread_init) noexcept;
+
+        /**
+         * Check if the job running on this thread was asked to stop
+         * NOTE: This is always false on threads other than workers
+         */
+        static bool cancelled() noexcept;
+
+        /**
+         * Constructor for command jobs
+         * @param workers   Number of worker threads
+         * @param finish    Function called when a job ends
+         */
+        CommandJobs(std::size_t workers, finish_t finish) noexcept;
+
+        /**
+         * Cancel every job and wait for workers
+         */
+        ~CommandJobs() noexcept;
+
+    private:
+        struct Job {
+            /** Job identifier */
+            job_id_t id;
+
+            /** Command */
+            ConsoleCommand *command;
+
+            /** Command line as typed */
+            std::string line;
+
+            /** Split copy of command line; arguments point into it */
+            std::string split_line;
+
+            /** Command arguments */
+            ConsoleCommand::arguments_t arguments;
+
+            /** Output of the command; finished when the job ends */
+            std::shared_ptr<CommandOutput> output;
+
+            /** Time of queueing */
+            std::chrono::steady_clock::time_point queued;
+
+            /** Job was picked up by a worker */
+            bool running = false;
+
+            /** Job was asked to stop */
+            std::atomic<bool> cancelled{false};
+        };
+
+        /** Number of worker threads */
+        std::size_t m_workers_count;
+
+        /** Function run by workers when they start */
+        thread_init_t m_thread_init;
+
+        /** Function called when a job ends */
+        finish_t m_finish;
+
+        /** Protects everything below */
+        mutable std::mutex m_mutex;
+
+        /** Signals new jobs and shutdown */
+        std::condition_variable m_condition;
+
+        /** Queued and running jobs */
+        std::vector<std::shared_ptr<Job>> m_jobs;
+
+        /** Jobs waiting for a worker */
+        std::deque<std::shared_ptr<Job>> m_queue;
+
+        /** Worker threads */
+        std::vector<std::thread> m_workers;
+
+        /** Next job identifier */
+        job_id_t m_next_id = 1;
+
+        /** Workers must exit */
+        bool m_stopping = false;
+
+        /**
+         * Worker thread body
+         */
+        void work() noexcept;
+
+        /**
+         * Remove a job from the jobs list
+         * NOTE: Mutex must be held
+         */
+        void forget(const Job &job) noexcept;
+    };
+}
+
+#endif
@@ -0,0 +1,58 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BLAMITE__CONSOLE__COMMAND_OUTPUT_HPP
+#define BLAMITE__CONSOLE__COMMAND_OUTPUT_HPP
+
+#include <mutex>
+#include <string>
+#include <string_view>
+
+namespace Blamite::Engine {
+    /**
+     * Collects what a command prints instead of showing it on the console.
+     * While an output is set as current on a thread, console prints from that thread land here. It is filled by
+     * the thread running the command and read by whoever asked for it, so it is locked.
+     */
+    class CommandOutput {
+    public:
+        /**
+         * Add a line
+         */
+        void write(std::string_view line) noexcept;
+
+        /**
+         * Mark command as done
+         */
+        void finish() noexcept;
+
+        /**
+         * Move collected text out
+         * @param text  String the text is appended to
+         * @return      True if command is done and everything was taken
+         */
+        bool take(std::string &text) noexcept;
+
+        /**
+         * Get output set for this thread
+         * @return      Output, or null if prints should go to the console
+         */
+        static CommandOutput *current() noexcept;
+
+        /**
+         * Set output for this thread
+         */
+        static void set_current(CommandOutput *output) noexcept;
+
+    private:
+        /** Protects everything below */
+        std::mutex m_mutex;
+
+        /** Collected text */
+        std::string m_text;
+
+        /** Command is done */
+        bool m_finished = false;
+    };
+}
+
+#endif
@@ -0,0 +1,84 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BLAMITE__CONSOLE__COMMAND_REGISTRY_HPP
+#define BLAMITE__CONSOLE__COMMAND_REGISTRY_HPP
+
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+#include "command.hpp"
+
+namespace Blamite::Engine {
+    /**
+     * Console commands by name.
+     * Lookup is a hash of the name view, and names are also kept in a prefix trie for completion.
+     */
+    class CommandRegistry {
+    public:
+        /**
+         * Add a command
+         * @return      False if a command with the same name exists
+         */
+        bool add(std::unique_ptr<ConsoleCommand> command) noexcept;
+
+        /**
+         * Find a command
+         * @return      Command, or null if there is no command with that name
+         */
+        ConsoleCommand *find(std::string_view name) const noexcept;
+
+        /**
+         * Get names of commands starting with a prefix, in alphabetical order
+         * @param prefix    Name prefix
+         * @param names     Vector to be filled; it is cleared first
+         * @param limit     Maximum number of names
+         */
+        void complete(std::string_view prefix, std::vector<std::string_view> &names, std::size_t limit = SIZE_MAX) const noexcept;
+
+        /**
+         * Get the longest name prefix shared by every command starting with a prefix
+         * @return      Shared prefix, or an empty view if no command starts with the prefix
+         */
+        std::string_view common_prefix(std::string_view prefix) const noexcept;
+
+        /**
+         * Get number of commands
+         */
+        std::size_t size() const noexcept;
+
+        /**
+         * Constructor for command registry
+         */
+        CommandRegistry() noexcept;
+
+    private:
+        struct TrieNode {
+            /** Children by next character, sorted */
+            std::vector<std::pair<char, std::uint32_t>> children;
+
+            /** Command ending at this node */
+            const ConsoleCommand *command = nullptr;
+        };
+
+        /** Commands by name; keys point to command names */
+        std::unordered_map<std::string_view, std::unique_ptr<ConsoleCommand>> m_commands;
+
+        /** Trie nodes; first node is the root */
+        std::vector<TrieNode> m_nodes;
+
+        /**
+         * Get node reached by a prefix
+         * @return      Node index, or SIZE_MAX if no name starts with the prefix
+         */
+        std::size_t find_node(std::string_view prefix) const noexcept;
+
+        /**
+         * Collect names under a node
+         */
+        void collect(std::size_t node, std::vector<std::string_view> &names, std::size_t limit) const noexcept;
+    };
+}
+
+#endif
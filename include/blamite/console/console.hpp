@@ -3,15 +3,25 @@
 #ifndef BLAMITE__CONSOLE__CONSOLE_HPP
 #define BLAMITE__CONSOLE__CONSOLE_HPP
 
+#include <mutex>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <deque>
 #include <memory>
 #include <utility>
 #include <optional>
+#include <chrono>
+#include <cstdarg>
+#include <algorithm>
 #include <cpp-terminal/base.hpp>
 #include <cpp-terminal/window.hpp>
 #include "command.hpp"
+#include "command_jobs.hpp"
+#include "command_registry.hpp"
+#include "log.hpp"
+#include "log_queue.hpp"
+#include "scrollback.hpp"
 
 namespace Blamite::Engine {
     class Console {
@@ -21,8 +31,38 @@ namespace Blamite::Engine {
 
         /**
          * Initialize console
+         * @param headless      Skip terminal handling and write plain lines to stdout
+         * @param command_fifo  FIFO commands are read from in headless mode; stdin is used if null and not a terminal
+         * @param read_stdin    Allow reading commands from stdin; only one console in a process should
          */
-        void init() noexcept;
+        void init(bool headless = false, const char *command_fifo = nullptr, bool read_stdin = true) noexcept;
+
+        /**
+         * Set text put before each line in headless mode, to tell apart consoles sharing stdout
+         */
+        void set_line_prefix(std::string prefix) noexcept;
+
+        /**
+         * Check if console runs without a terminal
+         */
+        bool headless() const noexcept;
+
+        struct Stats {
+            /** Screen renders so far */
+            std::size_t renders = 0;
+
+            /** Ticks where nothing had to be rendered */
+            std::size_t idle_ticks = 0;
+
+            /** Time spent reading input and rendering on last tick */
+            std::chrono::steady_clock::duration last_tick_time{};
+
+            /** Time spent on last render */
+            std::chrono::steady_clock::duration last_render_time{};
+
+            /** Messages dropped because log queue was full */
+            std::size_t dropped_messages = 0;
+        };
 
         /**
          * Read console input
@@ -30,34 +70,59 @@ namespace Blamite::Engine {
          */
         void read_input() noexcept;
 
+        /**
+         * Take queued messages and render screen if input, output or terminal size changed since last render
+         * NOTE: This is meant to be called once at the end of each tick
+         */
+        void render() noexcept;
+
+        /**
+         * Get console stats
+         */
+        const Stats &stats() const noexcept;
+
         /**
          * Display a message with color
+         * NOTE: Messages are queued and shown on next render; this is safe to call from any thread and never blocks
          */
-        void print(Color color, std::string out) noexcept;
+        void print(Color color, std::string_view out) noexcept;
 
         /**
          * Display a message
          */
-        void print(std::string out = {}) noexcept;
+        void print(std::string_view out = {}) noexcept;
 
         /**
          * Display a formatted message with color
+         * The format is checked against the arguments at compile time and the text is formatted straight into the log queue.
          */
-        template<typename... Args> void printf(Color color, const char *format, Args... args) noexcept {
-            char buff[256];
-            std::snprintf(buff, sizeof(buff), format, args...);
-            print(color, buff);
-        }
+        void printf(Color color, const char *format, ...) noexcept __attribute__((format(printf, 3, 4)));
 
         /**
          * Display a formatted message
          */
-        template<typename... Args> void printf(const char *format, Args... args) noexcept {
-            char buff[256];
-            std::snprintf(buff, sizeof(buff), format, args...);
-            print(buff);
+        void printf(const char *format, ...) noexcept __attribute__((format(printf, 2, 3)));
+
+        /**
+         * Log a message; use CONSOLE_LOG macros instead so format is checked and low levels are compiled out
+         */
+        template<typename... Args> void log(LogLevel level, const char *format, const Args &... args) noexcept {
+            m_log_queue.push_deferred(level_color(level), format, args...);
         }
 
+        /**
+         * Queue a command line to be run on the tick thread
+         * NOTE: This can be called from any thread
+         * @param line      Command line
+         * @param output    Output collecting what the command prints; it is finished once the command ends
+         */
+        void execute(std::string_view line, std::shared_ptr<CommandOutput> output) noexcept;
+
+        /**
+         * Get background command jobs
+         */
+        CommandJobs &jobs() noexcept;
+
         /**
          * Print a empty line
          */
@@ -79,20 +144,42 @@ namespace Blamite::Engine {
         Console(Console &) = delete;
 
     private:
-        struct ScreenBufferLine {
-            std::string text;
-            Color color;
+        enum DirtyFlags : std::uint8_t {
+            DIRTY_INPUT = 1 << 0,
+            DIRTY_OUTPUT = 1 << 1,
+            DIRTY_SIZE = 1 << 2
         };
 
         /** Console prompt */
         const std::string c_prompt = "blamite( ";
         
-        /** Maximum screen buffer entries */
-        const std::size_t c_max_screen_buffer_size = 100;
+        /** Maximum lines kept in scrollback */
+        const std::size_t c_max_scrollback_size = 100000;
+
+        /** Maximum command names listed on completion */
+        const std::size_t c_max_completions = 32;
+
+        /** Worker threads for background commands */
+        static constexpr std::size_t c_command_workers = 2;
 
         /** Maximum commands in history */
         const std::size_t c_max_commands_history_size = 20;
 
+        /** Console runs without a terminal */
+        bool m_headless = false;
+
+        /** Command input in headless mode, or -1 */
+        int m_command_fd = -1;
+
+        /** Partial command line read in headless mode */
+        std::string m_command_input;
+
+        /** Lines waiting to be written in headless mode */
+        std::string m_output_buffer;
+
+        /** Text put before each line in headless mode */
+        std::string m_line_prefix;
+
         /** Terminal itself */
         std::unique_ptr<Term::Terminal> m_terminal;
 
@@ -102,8 +189,14 @@ namespace Blamite::Engine {
         /** Console screen */
         std::unique_ptr<Term::Window> m_screen;
 
-        /** Screen buffer */
-        std::deque<ScreenBufferLine> m_screen_buffer;
+        /** Output history */
+        Scrollback m_scrollback{c_max_scrollback_size};
+
+        /** Rows scrolled up from the bottom of the output */
+        std::size_t m_scroll_offset = 0;
+
+        /** Messages waiting to be added to screen buffer */
+        LogQueue m_log_queue;
 
         /** Input buffer */
         std::string m_input_buffer;
@@ -124,18 +217,93 @@ namespace Blamite::Engine {
         std::int8_t m_history_pos;
 
         /** Commands */
-        std::vector<std::unique_ptr<ConsoleCommand>> m_commands;
+        CommandRegistry m_commands;
+
+        /** Copy of command line being executed; arguments point into it */
+        std::string m_command_line;
+
+        /** Arguments of command being executed */
+        ConsoleCommand::arguments_t m_command_arguments;
+
+        /** Completion buffer for input suggestion */
+        mutable std::vector<std::string_view> m_suggestions;
+
+        struct QueuedCommand {
+            /** Command line */
+            std::string line;
+
+            /** Command output */
+            std::shared_ptr<CommandOutput> output;
+        };
+
+        /** Protects queued commands */
+        std::mutex m_queued_commands_mutex;
+
+        /** Commands from other threads waiting for the tick thread */
+        std::vector<QueuedCommand> m_queued_commands;
+
+        /** Queued commands being run on this tick */
+        std::vector<QueuedCommand> m_running_commands;
+
+        /** Background commands; declared last so workers stop before anything they print to goes away */
+        CommandJobs m_jobs{c_command_workers, [this](const ConsoleCommand &command, ConsoleCommand::Result result, bool cancelled) {
+            if(cancelled) {
+                printf(Color::gray, "Command \"%s\" was cancelled.", command.name().c_str());
+            }
+            else {
+                report_result(command, result);
+            }
+        }};
+
+        /** Parts of the screen changed since last render */
+        std::uint8_t m_dirty = 0;
+
+        /** Time spent reading input on current tick */
+        std::chrono::steady_clock::duration m_input_time{};
+
+        /** Stats */
+        Stats m_stats;
+
+        /**
+         * Display a formatted message from a list of arguments
+         */
+        void vprintf(Color color, const char *format, std::va_list args) noexcept;
 
         /**
          * Get console dimentions
          */
         std::pair<int, int> get_size() const noexcept;
 
+        /**
+         * Open command input for headless mode
+         */
+        void open_command_input(const char *command_fifo, bool read_stdin) noexcept;
+
+        /**
+         * Read and execute commands from headless command input
+         */
+        void read_command_input() noexcept;
+
+        /**
+         * Get number of rows moved by a scroll key
+         */
+        std::size_t scroll_page() const noexcept;
+
         /** 
          * Process input key code
          */
         std::optional<std::string> process_input(int key_code) noexcept;
 
+        /**
+         * Get color of a log level
+         */
+        static Color level_color(LogLevel level) noexcept;
+
+        /**
+         * Move queued messages to scrollback
+         */
+        void drain_log_queue() noexcept;
+
         /**
          * Render screen buffer
          */
@@ -143,8 +311,26 @@ namespace Blamite::Engine {
 
         /**
          * Execute a command
+         * @param line      Command line
+         * @param output    Output collecting what the command prints, or null to print to the console
+         */
+        void execute_command(std::string_view line, std::shared_ptr<CommandOutput> output = nullptr) noexcept;
+
+        /**
+         * Print argument errors of a command
+         * NOTE: This can be called from any thread
+         */
+        void report_result(const ConsoleCommand &command, ConsoleCommand::Result result) noexcept;
+
+        /**
+         * Complete command name in input
+         */
+        void complete_command() noexcept;
+
+        /**
+         * Get rest of the first command name matching the input, if any
          */
-        void execute_command(std::string command) noexcept;
+        std::string_view input_suggestion() const noexcept;
 
         /**
          * Register commands
@@ -0,0 +1,51 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BLAMITE__CONSOLE__LOG_HPP
+#define BLAMITE__CONSOLE__LOG_HPP
+
+#include <cstdint>
+
+/**
+ * Lowest log level compiled in; messages below it are removed along with their arguments
+ */
+#ifndef BLAMITE_LOG_LEVEL
+#define BLAMITE_LOG_LEVEL 0
+#endif
+
+namespace Blamite::Engine {
+    enum LogLevel : std::uint8_t {
+        LOG_LEVEL_TRACE = 0,
+        LOG_LEVEL_DEBUG,
+        LOG_LEVEL_INFO,
+        LOG_LEVEL_WARNING,
+        LOG_LEVEL_ERROR
+    };
+
+    /**
+     * Never called; lets the compiler check log formats against their arguments
+     */
+    inline void check_log_format(const char *, ...) noexcept __attribute__((format(printf, 1, 2)));
+    inline void check_log_format(const char *, ...) noexcept {}
+}
+
+/**
+ * Log a message to a console.
+ * Format must be a string literal. Only the format pointer and raw arguments are captured; formatting happens
+ * when the console takes the message. Strings are copied, so temporaries are fine.
+ */
+#define CONSOLE_LOG(console, level, format, ...) do { \
+    if constexpr((level) >= BLAMITE_LOG_LEVEL) { \
+        if(false) { \
+            ::Blamite::Engine::check_log_format(format, ##__VA_ARGS__); \
+        } \
+        (console).log(level, "" format, ##__VA_ARGS__); \
+    } \
+} while(0)
+
+#define CONSOLE_TRACE(console, format, ...) CONSOLE_LOG(console, ::Blamite::Engine::LOG_LEVEL_TRACE, format, ##__VA_ARGS__)
+#define CONSOLE_DEBUG(console, format, ...) CONSOLE_LOG(console, ::Blamite::Engine::LOG_LEVEL_DEBUG, format, ##__VA_ARGS__)
+#define CONSOLE_INFO(console, format, ...) CONSOLE_LOG(console, ::Blamite::Engine::LOG_LEVEL_INFO, format, ##__VA_ARGS__)
+#define CONSOLE_WARNING(console, format, ...) CONSOLE_LOG(console, ::Blamite::Engine::LOG_LEVEL_WARNING, format, ##__VA_ARGS__)
+#define CONSOLE_ERROR(console, format, ...) CONSOLE_LOG(console, ::Blamite::Engine::LOG_LEVEL_ERROR, format, ##__VA_ARGS__)
+
+#endif
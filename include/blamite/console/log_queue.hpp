@@ -0,0 +1,217 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BLAMITE__CONSOLE__LOG_QUEUE_HPP
+#define BLAMITE__CONSOLE__LOG_QUEUE_HPP
+
+#include <atomic>
+#include <memory>
+#include <tuple>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+#include <cpp-terminal/base.hpp>
+
+namespace Blamite::Engine {
+    /**
+     * Bounded multi-producer single-consumer queue of console lines.
+     * Any thread can push without locking or blocking; when the queue is full the line is dropped and
+     * counted. Only the console drains it, once per tick.
+     * Records hold either formatted text or a format pointer with raw arguments to be formatted by the consumer.
+     */
+    class LogQueue {
+    public:
+        /** Formats captured arguments into a buffer and returns the untruncated length */
+        using formatter_t = std::size_t (*)(const char *data, char *out, std::size_t size);
+
+        struct Record {
+            /** Formatter for captured arguments; null if text is already formatted */
+            formatter_t formatter;
+
+            /** Text color */
+            Term::fg color;
+
+            /** Length of text or captured arguments */
+            std::uint16_t length;
+
+            /** Text, or format pointer followed by arguments; not null-terminated, use length */
+            char text[490];
+        };
+
+        /** Maximum text length of a record */
+        static constexpr std::size_t MAX_TEXT_LENGTH = sizeof(Record::text);
+
+        /**
+         * Get record storage for writing
+         * @return      Record to be filled and committed, or null if queue is full
+         */
+        Record *reserve() noexcept;
+
+        /**
+         * Publish a reserved record
+         * @param record    Reserved record
+         * @param length    Length of text written to record; text longer than the record is cut and marked with an ellipsis
+         */
+        void commit(Record *record, std::size_t length) noexcept;
+
+        /**
+         * Push a line; text longer than a record is cut and marked with an ellipsis
+         * @return      False if queue is full and line was dropped
+         */
+        bool push(Term::fg color, std::string_view text) noexcept;
+
+        /**
+         * Push a line to be formatted by the consumer
+         * Numbers and pointers are copied as they are and C strings are copied up to the space left in the record.
+         * @param format    Format string; it must outlive the queue, so it should be a string literal
+         * @return          False if queue is full and line was dropped
+         */
+        template<typename... Args> bool push_deferred(Term::fg color, const char *format, const Args &... args) noexcept {
+            constexpr std::size_t reserved = sizeof(format) + (argument_size<std::decay_t<Args>>() + ... + 0);
+            static_assert(reserved <= MAX_TEXT_LENGTH, "too many log arguments");
+
+            auto *record = reserve();
+            if(!record) {
+                return false;
+            }
+
+            char *cursor = record->text;
+            std::size_t spare = MAX_TEXT_LENGTH - reserved;
+            std::memcpy(cursor, &format, sizeof(format));
+            cursor += sizeof(format);
+            (capture_argument<std::decay_t<Args>>(cursor, spare, args), ...);
+
+            record->formatter = format_arguments<stored_t<std::decay_t<Args>>...>;
+            record->color = color;
+            record->length = cursor - record->text;
+            publish(record);
+            return true;
+        }
+
+        /**
+         * Get text of a record, formatting it if needed
+         * @param record    Record
+         * @param buffer    Buffer for formatted text; at least MAX_TEXT_LENGTH bytes long
+         * @return          Record text
+         */
+        static std::string_view text(const Record &record, char *buffer) noexcept;
+
+        /**
+         * Pop a line
+         * NOTE: Only the console thread may call this
+         * @return      Record to be read and released, or null if queue is empty
+         */
+        const Record *front() noexcept;
+
+        /**
+         * Release popped record
+         */
+        void pop() noexcept;
+
+        /**
+         * Get and reset number of dropped lines
+         */
+        std::size_t take_dropped() noexcept;
+
+        /**
+         * Constructor for log queue
+         * @param capacity  Number of records; rounded up to a power of two
+         */
+        LogQueue(std::size_t capacity = 1024) noexcept;
+
+        /**
+         * Deleted copy constructor
+         */
+        LogQueue(const LogQueue &) = delete;
+
+    private:
+        template<typename T> static constexpr bool is_string = std::is_same_v<T, const char *> || std::is_same_v<T, char *>;
+        template<typename T> using stored_t = std::conditional_t<is_string<T>, const char *, T>;
+
+        /**
+         * Get bytes always taken by an argument; strings take their terminator
+         */
+        template<typename T> static constexpr std::size_t argument_size() noexcept {
+            if constexpr(is_string<T>) {
+                return 1;
+            }
+            else {
+                static_assert(std::is_trivially_copyable_v<T>, "log arguments must be numbers, pointers or C strings");
+                return sizeof(T);
+            }
+        }
+
+        template<typename T> static void capture_argument(char *&cursor, std::size_t &spare, const T &value) noexcept {
+            if constexpr(is_string<T>) {
+                const char *string = value ? value : "(null)";
+                auto length = strnlen(string, spare);
+                std::memcpy(cursor, string, length);
+                cursor[length] = '\0';
+                cursor += length + 1;
+                spare -= length;
+            }
+            else {
+                std::memcpy(cursor, &value, sizeof(T));
+                cursor += sizeof(T);
+            }
+        }
+
+        template<typename T> static T extract_argument(const char *&cursor) noexcept {
+            if constexpr(is_string<T>) {
+                const char *string = cursor;
+                cursor += std::strlen(string) + 1;
+                return string;
+            }
+            else {
+                T value;
+                std::memcpy(&value, cursor, sizeof(T));
+                cursor += sizeof(T);
+                return value;
+            }
+        }
+
+        template<typename... Args> static std::size_t format_arguments(const char *data, char *out, std::size_t size) {
+            const char *format;
+            std::memcpy(&format, data, sizeof(format));
+            data += sizeof(format);
+
+            // Braced initialization reads arguments in order
+            std::tuple<Args...> arguments{extract_argument<Args>(data)...};
+            auto length = std::apply([&](auto... values) {
+                return std::snprintf(out, size, format, values...);
+            }, arguments);
+            return length > 0 ? length : 0;
+        }
+
+        /**
+         * Make a filled record visible to the consumer
+         */
+        void publish(Record *record) noexcept;
+
+        struct Cell {
+            /** Record; kept first so a record pointer is also its cell pointer */
+            Record record;
+
+            /** Sequence number telling whether cell is free or published */
+            std::atomic<std::size_t> sequence;
+        };
+
+        /** Cells */
+        std::unique_ptr<Cell[]> m_cells;
+
+        /** Capacity mask */
+        std::size_t m_mask;
+
+        /** Next position to be reserved by producers */
+        alignas(64) std::atomic<std::size_t> m_enqueue_position{0};
+
+        /** Next position to be read by the consumer */
+        alignas(64) std::size_t m_dequeue_position = 0;
+
+        /** Lines dropped because queue was full */
+        alignas(64) std::atomic<std::size_t> m_dropped{0};
+    };
+}
+
+#endif
@@ -0,0 +1,119 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BLAMITE__CONSOLE__SCROLLBACK_HPP
+#define BLAMITE__CONSOLE__SCROLLBACK_HPP
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <string_view>
+#include <cpp-terminal/base.hpp>
+
+namespace Blamite::Engine {
+    /**
+     * Console output history.
+     * Lines live in a fixed-capacity ring; once it is full the oldest line is overwritten and its string storage
+     * reused. Each line knows how many screen rows it wraps to at the current width and where its first row is,
+     * so finding a screen row is a binary search and wrapping is only recomputed when the width changes.
+     */
+    class Scrollback {
+    public:
+        struct Row {
+            /** Row text */
+            std::string_view text;
+
+            /** Text color */
+            Term::fg color;
+
+            /** Row continues a wrapped line and should be indented */
+            bool continuation;
+        };
+
+        /** Indentation of wrapped rows */
+        static constexpr std::size_t CONTINUATION_INDENT = 2;
+
+        /**
+         * Add a line
+         * @return      Number of rows taken by the line
+         */
+        std::size_t push(std::string_view text, Term::fg color) noexcept;
+
+        /**
+         * Remove every line
+         */
+        void clear() noexcept;
+
+        /**
+         * Set wrap width; rows are recomputed only if it changed
+         */
+        void set_width(std::size_t width) noexcept;
+
+        /**
+         * Get number of lines
+         */
+        std::size_t size() const noexcept;
+
+        /**
+         * Get number of rows of all lines at current width
+         */
+        std::size_t total_rows() const noexcept;
+
+        /**
+         * Get a row
+         * @param index     Row index; 0 is the first row of the oldest line
+         */
+        Row row(std::size_t index) const noexcept;
+
+        /**
+         * Constructor for scrollback
+         * @param capacity  Maximum number of lines
+         * @param width     Initial wrap width
+         */
+        Scrollback(std::size_t capacity, std::size_t width = 80) noexcept;
+
+    private:
+        struct Line {
+            /** Text */
+            std::string text;
+
+            /** Text color */
+            Term::fg color;
+
+            /** Row number of first row */
+            std::uint64_t first_row;
+
+            /** Number of rows */
+            std::uint32_t rows;
+        };
+
+        /** Lines ring */
+        std::vector<Line> m_lines;
+
+        /** Maximum number of lines */
+        std::size_t m_capacity;
+
+        /** Ring index of oldest line */
+        std::size_t m_start = 0;
+
+        /** Number of lines */
+        std::size_t m_count = 0;
+
+        /** Wrap width */
+        std::size_t m_width;
+
+        /** Row number for next line */
+        std::uint64_t m_next_row = 0;
+
+        /**
+         * Get line by age; 0 is the oldest
+         */
+        const Line &line(std::size_t index) const noexcept;
+
+        /**
+         * Get number of rows a text wraps to
+         */
+        std::uint32_t count_rows(std::size_t length) const noexcept;
+    };
+}
+
+#endif
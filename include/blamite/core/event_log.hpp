@@ -0,0 +1,284 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BLAMITE__CORE__EVENT_LOG_HPP
+#define BLAMITE__CORE__EVENT_LOG_HPP
+
+#include <cstdio>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <blamite/memory/struct.hpp>
+
+namespace Blamite::Engine {
+    /**
+     * Event log record types.
+     * Values are part of the file format; only append new ones.
+     */
+    enum EventType : std::uint16_t {
+        EVENT_TYPE_CONNECT = 1,
+        EVENT_TYPE_REFUSE,
+        EVENT_TYPE_DISCONNECT,
+        EVENT_TYPE_TICK_STATS,
+        EVENT_TYPE_DROPPED
+    };
+
+    enum DisconnectReason : std::uint8_t {
+        DISCONNECT_REASON_CLIENT = 0,
+        DISCONNECT_REASON_TIMEOUT,
+        DISCONNECT_REASON_HANDSHAKE_TIMEOUT,
+        DISCONNECT_REASON_SHUTDOWN
+    };
+
+    /**
+     * Get disconnect reason name
+     */
+    const char *disconnect_reason_name(DisconnectReason reason) noexcept;
+
+    /**
+     * Get event type name
+     */
+    const char *event_type_name(EventType type) noexcept;
+
+    /**
+     * Event log file header
+     */
+    struct PACKED EventLogHeader {
+        /** File magic */
+        char magic[8];
+
+        /** Format version */
+        std::uint32_t version;
+
+        /** File creation time in microseconds since the Unix epoch */
+        std::uint64_t start_time;
+
+        static constexpr char MAGIC[8] = {'B', 'L', 'M', 'E', 'V', 'L', 'O', 'G'};
+        static constexpr std::uint32_t VERSION = 1;
+    };
+
+    /**
+     * Header preceding every record; readers skip records of unknown types by their size
+     */
+    struct PACKED EventHeader {
+        /** Record type */
+        std::uint16_t type;
+
+        /** Payload size */
+        std::uint16_t size;
+
+        /** Event time in microseconds since the Unix epoch */
+        std::uint64_t time;
+    };
+
+    struct PACKED ConnectEvent {
+        static constexpr EventType TYPE = EVENT_TYPE_CONNECT;
+
+        /** Client identifier */
+        std::uint32_t client_id;
+
+        /** IPv4 address in host order */
+        std::uint32_t address;
+
+        /** UDP port */
+        std::uint16_t port;
+    };
+
+    struct PACKED RefuseEvent {
+        static constexpr EventType TYPE = EVENT_TYPE_REFUSE;
+
+        /** IPv4 address in host order */
+        std::uint32_t address;
+
+        /** UDP port */
+        std::uint16_t port;
+
+        /** Refuse reason sent to the client */
+        std::uint32_t reason;
+    };
+
+    struct PACKED DisconnectEvent {
+        static constexpr EventType TYPE = EVENT_TYPE_DISCONNECT;
+
+        /** Client identifier */
+        std::uint32_t client_id;
+
+        /** Why the client was dropped */
+        std::uint8_t reason;
+    };
+
+    struct PACKED TickStatsEvent {
+        static constexpr EventType TYPE = EVENT_TYPE_TICK_STATS;
+
+        /** Tick number */
+        std::uint64_t tick;
+
+        /** Tick work time in microseconds */
+        std::uint32_t duration;
+
+        /** Connected clients */
+        std::uint16_t clients;
+
+        /** Live entities */
+        std::uint32_t entities;
+    };
+
+    struct PACKED DroppedEvent {
+        static constexpr EventType TYPE = EVENT_TYPE_DROPPED;
+
+        /** Records lost because the writer fell behind */
+        std::uint64_t count;
+    };
+
+    /**
+     * Append-only binary event log.
+     * Records are appended to a memory buffer under a short lock; a writer thread swaps the buffer out and writes
+     * it in one go, so the tick thread never waits on the disk. When the file grows past its size limit it is
+     * rotated to "<path>.1", older files shifting up until the oldest one is deleted. Records never span files and
+     * every file starts with its own header, so any of them can be decoded alone.
+     */
+    class EventLog {
+    public:
+        struct Stats {
+            /** Bytes written to disk */
+            std::uint64_t written_bytes;
+
+            /** Records lost because the buffer was full */
+            std::uint64_t dropped_records;
+
+            /** Files rotated out */
+            std::uint64_t rotations;
+        };
+
+        /**
+         * Append a typed record
+         */
+        template<typename T> void write(const T &event) noexcept {
+            write(T::TYPE, &event, sizeof(event));
+        }
+
+        /**
+         * Append a record
+         * @param type      Record type
+         * @param payload   Record payload
+         * @param size      Payload size
+         */
+        void write(EventType type, const void *payload, std::uint16_t size) noexcept;
+
+        /**
+         * Get log stats
+         */
+        Stats stats() noexcept;
+
+        /**
+         * Get current file path
+         */
+        const std::string &path() const noexcept;
+
+        /**
+         * Constructor for event log
+         * An existing file at the path is rotated out first.
+         * @param path              Log file path
+         * @param max_file_size     Size after which the file is rotated
+         * @param max_files         Files kept including the current one
+         * @throws std::runtime_error if the file cannot be created
+         */
+        EventLog(std::string path, std::size_t max_file_size = 64 * 1024 * 1024, std::size_t max_files = 4);
+
+        /**
+         * Deleted copy constructor
+         */
+        EventLog(const EventLog &) = delete;
+
+        /**
+         * Destructor for event log; writes everything still buffered
+         */
+        ~EventLog() noexcept;
+
+    private:
+        /** Log file path */
+        std::string m_path;
+
+        /** Size after which the file is rotated */
+        std::size_t m_max_file_size;
+
+        /** Files kept including the current one */
+        std::size_t m_max_files;
+
+        /** Current file */
+        std::FILE *m_file = nullptr;
+
+        /** Current file size */
+        std::size_t m_file_size = 0;
+
+        /** Records waiting for the writer */
+        std::vector<std::byte> m_pending;
+
+        /** Buffer being written; owned by the writer thread */
+        std::vector<std::byte> m_writing;
+
+        /** Records dropped since the writer last looked */
+        std::uint64_t m_unreported_drops = 0;
+
+        /** Stats */
+        Stats m_stats = {};
+
+        /** Writer stop flag */
+        bool m_stop = false;
+
+        /** Guards pending buffer, stop flag and stats */
+        std::mutex m_mutex;
+
+        /** Wakes the writer */
+        std::condition_variable m_wake;
+
+        /** Writer thread */
+        std::thread m_writer;
+
+        /** Buffered size that wakes the writer early */
+        static constexpr std::size_t c_flush_size = 256 * 1024;
+
+        /** Buffered size after which records are dropped */
+        static constexpr std::size_t c_max_pending_size = 8 * 1024 * 1024;
+
+        /** Longest time a record stays buffered */
+        static constexpr std::chrono::milliseconds c_flush_interval{500};
+
+        /**
+         * Writer thread loop
+         */
+        void writer_loop() noexcept;
+
+        /**
+         * Append a record to a buffer
+         */
+        static void append(std::vector<std::byte> &buffer, EventType type, const void *payload, std::uint16_t size) noexcept;
+
+        /**
+         * Write the writing buffer to the file
+         * @return      Bytes written
+         */
+        std::size_t write_out() noexcept;
+
+        /**
+         * Move current file away, shifting older ones, and start a new one
+         * @return      False if the new file could not be created
+         */
+        bool rotate() noexcept;
+
+        /**
+         * Create the file and write its header
+         */
+        bool open_file() noexcept;
+
+        /**
+         * Get path of a rotated file
+         */
+        std::string rotated_path(std::size_t index) const;
+    };
+}
+
+#endif
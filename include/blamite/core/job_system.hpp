@@ -0,0 +1,245 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BLAMITE__CORE__JOB_SYSTEM_HPP
+#define BLAMITE__CORE__JOB_SYSTEM_HPP
+
+#include <mutex>
+#include <deque>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <condition_variable>
+
+namespace Blamite::Engine {
+    class JobSystem;
+
+    /**
+     * Set of tasks with dependencies between them.
+     * A task only starts once every task it depends on is done. Dependencies can only point at tasks added earlier,
+     * so a graph is never cyclic. Clearing a graph keeps its tasks around, so a graph rebuilt every tick with the
+     * same shape does not allocate.
+     */
+    class TaskGraph {
+        friend JobSystem;
+    public:
+        using task_id_t = std::uint32_t;
+
+        /** Task body; plain tasks get an empty range */
+        using function_t = std::function<void (std::size_t begin, std::size_t end)>;
+
+        /**
+         * Add a task
+         * @param function      Task body, called with no arguments
+         * @param dependencies  Tasks that must be done first
+         * @return              Task identifier
+         */
+        template<typename T> task_id_t add(T &&function, std::initializer_list<task_id_t> dependencies = {}) noexcept {
+            return add_task([function = std::forward<T>(function)](std::size_t, std::size_t) mutable {
+                function();
+            }, 0, 0, dependencies);
+        }
+
+        /**
+         * Add tasks splitting a range in chunks
+         * @param count         Range size
+         * @param grain         Largest chunk size
+         * @param function      Chunk body, called with the chunk range
+         * @param dependencies  Tasks that must be done before any chunk
+         * @return              Identifier of a task that is done once every chunk is
+         */
+        task_id_t add_range(std::size_t count, std::size_t grain, const function_t &function, std::initializer_list<task_id_t> dependencies = {}) noexcept;
+
+        /**
+         * Remove every task
+         */
+        void clear() noexcept;
+
+        /**
+         * Get number of tasks
+         */
+        std::size_t size() const noexcept;
+
+    private:
+        struct Task {
+            /** Task body */
+            function_t function;
+
+            /** Range given to the body */
+            std::size_t begin;
+            std::size_t end;
+
+            /** Tasks waiting for this one */
+            std::vector<task_id_t> successors;
+
+            /** Number of tasks this one waits for */
+            std::uint32_t dependencies;
+
+            /** Dependencies not done yet while running */
+            std::atomic<std::uint32_t> pending;
+
+            /** Owner graph */
+            TaskGraph *graph;
+        };
+
+        /** Tasks; only the first m_size are in use */
+        std::vector<std::unique_ptr<Task>> m_tasks;
+
+        /** Number of tasks in use */
+        std::size_t m_size = 0;
+
+        /** Tasks not done yet while running */
+        std::atomic<std::size_t> m_remaining{0};
+
+        /**
+         * Add a task with a range
+         */
+        task_id_t add_task(function_t function, std::size_t begin, std::size_t end, std::initializer_list<task_id_t> dependencies) noexcept;
+
+        /**
+         * Make a task wait for another
+         */
+        void add_dependency(task_id_t task, task_id_t dependency) noexcept;
+    };
+
+    /**
+     * Work-stealing task scheduler.
+     * Every worker has its own deque: it pushes and pops tasks at the bottom, while idle workers steal from the top
+     * of the others. Tasks made ready by a worker go to its own deque, so chains of tasks tend to stay on one core.
+     * Threads that are not workers hand tasks over through a shared queue and help running tasks until their
+     * graph is done, so several threads can run graphs at the same time. Idle workers spin a little before
+     * sleeping. With no workers, graphs simply run on the calling thread.
+     */
+    class JobSystem {
+    public:
+        /**
+         * Run a graph and wait for every task in it
+         * NOTE: Tasks may run on any thread, including the calling one.
+         */
+        void run(TaskGraph &graph) noexcept;
+
+        /**
+         * Get number of worker threads
+         */
+        std::size_t workers_count() const noexcept;
+
+        /**
+         * Constructor for job system
+         * @param workers   Number of worker threads; the threads calling run() work too
+         */
+        JobSystem(std::size_t workers) noexcept;
+
+        /**
+         * Deleted copy constructor
+         */
+        JobSystem(const JobSystem &) = delete;
+
+        /**
+         * Stop workers
+         */
+        ~JobSystem() noexcept;
+
+    private:
+        using Task = TaskGraph::Task;
+
+        /**
+         * Chase-Lev deque of fixed capacity
+         */
+        class Deque {
+        public:
+            /**
+             * Push a task at the bottom; owner only
+             * @return      False if the deque is full
+             */
+            bool push(Task *task) noexcept;
+
+            /**
+             * Pop a task from the bottom; owner only
+             */
+            Task *pop() noexcept;
+
+            /**
+             * Take a task from the top; any thread
+             */
+            Task *steal() noexcept;
+
+        private:
+            static constexpr std::int64_t c_capacity = 4096;
+
+            /** Next index to steal from */
+            alignas(64) std::atomic<std::int64_t> m_top{0};
+
+            /** Next index to push to */
+            alignas(64) std::atomic<std::int64_t> m_bottom{0};
+
+            /** Tasks ring */
+            std::atomic<Task *> m_tasks[c_capacity] = {};
+        };
+
+        struct Worker {
+            /** Worker tasks */
+            Deque deque;
+
+            /** Worker thread */
+            std::thread thread;
+        };
+
+        /** Workers */
+        std::vector<std::unique_ptr<Worker>> m_workers;
+
+        /** Tasks from threads that are not workers */
+        std::deque<Task *> m_injected;
+
+        /** Guards injected tasks */
+        std::mutex m_injected_mutex;
+
+        /** Tasks scheduled and not taken yet */
+        std::atomic<std::size_t> m_queued{0};
+
+        /** Workers sleeping or about to */
+        std::atomic<std::size_t> m_sleeping{0};
+
+        /** Guards sleeping workers */
+        std::mutex m_sleep_mutex;
+
+        /** Wakes sleeping workers */
+        std::condition_variable m_wake;
+
+        /** Workers must exit */
+        std::atomic<bool> m_stopping{false};
+
+        /** Failed attempts to find a task before a worker sleeps */
+        static constexpr std::size_t c_spin_count = 256;
+
+        /**
+         * Worker thread body
+         */
+        void work(Worker &self) noexcept;
+
+        /**
+         * Queue a task that is ready to run
+         */
+        void schedule(Task *task) noexcept;
+
+        /**
+         * Take a task to run, looking at the own deque, then shared queue, then other workers
+         * @param self  Worker of the calling thread, or null
+         */
+        Task *find_task(Worker *self) noexcept;
+
+        /**
+         * Run a task and schedule successors it makes ready
+         */
+        void execute(Task *task) noexcept;
+
+        /**
+         * Get worker of the calling thread if it is one of ours
+         */
+        Worker *current_worker() noexcept;
+    };
+}
+
+#endif
@@ -0,0 +1,208 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BLAMITE__CORE__METRICS_HPP
+#define BLAMITE__CORE__METRICS_HPP
+
+#include <array>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace Blamite::Engine {
+    /** Number of slots each counter and histogram is split into */
+    constexpr std::size_t METRIC_SHARDS = 16;
+
+    /**
+     * Get metric slot of the calling thread
+     * Threads get slots in turn, so up to METRIC_SHARDS threads never write the same cache line.
+     */
+    inline std::size_t metric_shard() noexcept {
+        static std::atomic<std::size_t> next_shard{0};
+        thread_local std::size_t shard = next_shard.fetch_add(1, std::memory_order_relaxed) % METRIC_SHARDS;
+        return shard;
+    }
+
+    /**
+     * Monotonic counter.
+     * Every thread adds to its own cache line and readers sum them, so counting never contends.
+     */
+    class Counter {
+    public:
+        /**
+         * Add to counter
+         */
+        void add(std::uint64_t value = 1) noexcept {
+            m_shards[metric_shard()].value.fetch_add(value, std::memory_order_relaxed);
+        }
+
+        /**
+         * Get counter value
+         */
+        std::uint64_t value() const noexcept;
+
+    private:
+        struct alignas(64) Shard {
+            std::atomic<std::uint64_t> value{0};
+        };
+
+        /** Per-thread counts */
+        std::array<Shard, METRIC_SHARDS> m_shards;
+    };
+
+    /**
+     * Value that goes up and down, e.g. a queue depth
+     */
+    class alignas(64) Gauge {
+    public:
+        /**
+         * Set gauge value
+         */
+        void set(std::int64_t value) noexcept {
+            m_value.store(value, std::memory_order_relaxed);
+        }
+
+        /**
+         * Add to gauge value
+         */
+        void add(std::int64_t value) noexcept {
+            m_value.fetch_add(value, std::memory_order_relaxed);
+        }
+
+        /**
+         * Get gauge value
+         */
+        std::int64_t value() const noexcept {
+            return m_value.load(std::memory_order_relaxed);
+        }
+
+    private:
+        /** Value */
+        std::atomic<std::int64_t> m_value{0};
+    };
+
+    /**
+     * Histogram with fixed buckets, sharded per thread like counters
+     */
+    class Histogram {
+    public:
+        /** Maximum number of bucket bounds */
+        static constexpr std::size_t MAX_BUCKETS = 15;
+
+        struct Snapshot {
+            /** Bucket upper bounds */
+            std::vector<double> bounds;
+
+            /** Observations in each bucket, not cumulative; the last one is above every bound */
+            std::vector<std::uint64_t> counts;
+
+            /** Sum of observations */
+            double sum;
+        };
+
+        /**
+         * Record an observation
+         */
+        void observe(double value) noexcept;
+
+        /**
+         * Get bucket counts and sum
+         */
+        Snapshot snapshot() const noexcept;
+
+        /**
+         * Constructor for histogram
+         * @param bounds    Bucket upper bounds in ascending order; only the first MAX_BUCKETS are used
+         */
+        Histogram(const std::vector<double> &bounds) noexcept;
+
+    private:
+        struct alignas(64) Shard {
+            /** Observations per bucket */
+            std::atomic<std::uint64_t> counts[MAX_BUCKETS + 1] = {};
+
+            /** Sum of observations */
+            std::atomic<double> sum{0.0};
+        };
+
+        /** Bucket upper bounds */
+        std::array<double, MAX_BUCKETS> m_bounds;
+
+        /** Number of bucket bounds */
+        std::size_t m_bounds_count;
+
+        /** Per-thread buckets */
+        std::array<Shard, METRIC_SHARDS> m_shards;
+    };
+
+    /**
+     * Named metrics, rendered in the Prometheus text exposition format.
+     * Metrics are registered once and then updated through the returned reference from any thread; rendering
+     * only reads their atomics, so it can run on another thread while the tick goes on.
+     */
+    class Metrics {
+    public:
+        /**
+         * Register a counter
+         * @param name      Metric name; metrics sharing a name must have the same type and differ in labels
+         * @param help      Metric description
+         * @param labels    Labels, e.g. type="encrypted", or empty
+         */
+        Counter &counter(const std::string &name, const std::string &help, const std::string &labels = {}) noexcept;
+
+        /**
+         * Register a gauge
+         */
+        Gauge &gauge(const std::string &name, const std::string &help, const std::string &labels = {}) noexcept;
+
+        /**
+         * Register a histogram
+         * @param bounds    Bucket upper bounds in ascending order
+         */
+        Histogram &histogram(const std::string &name, const std::string &help, const std::vector<double> &bounds, const std::string &labels = {}) noexcept;
+
+        /**
+         * Render every metric in the Prometheus text format
+         */
+        std::string render() const noexcept;
+
+    private:
+        enum Type {
+            TYPE_COUNTER,
+            TYPE_GAUGE,
+            TYPE_HISTOGRAM
+        };
+
+        struct Entry {
+            /** Metric name */
+            std::string name;
+
+            /** Metric description */
+            std::string help;
+
+            /** Metric labels */
+            std::string labels;
+
+            /** Metric type; only the matching pointer is set */
+            Type type;
+            std::unique_ptr<Counter> counter = nullptr;
+            std::unique_ptr<Gauge> gauge = nullptr;
+            std::unique_ptr<Histogram> histogram = nullptr;
+        };
+
+        /** Registered metrics, in order */
+        std::vector<Entry> m_entries;
+
+        /** Guards the list, not the values */
+        mutable std::mutex m_mutex;
+
+        /**
+         * Add an entry
+         */
+        void add(Entry entry) noexcept;
+    };
+}
+
+#endif
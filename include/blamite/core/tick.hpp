@@ -5,18 +5,26 @@
 
 #include <chrono>
 #include <ratio>
+#include <cstdint>
 
 namespace Blamite::Engine {
     /**
-     * The number of ticks per second.
-     * 30 ticks per second by default.
+     * The number of ticks per second unless told otherwise.
+     * Engines can run at another rate, picked at startup or changed while running.
      */
-    constexpr std::uint8_t TICK_RATE = 30;
+    constexpr std::uint16_t DEFAULT_TICK_RATE = 30;
 
     /**
-     * Tick duration
+     * Resolution of timers in ticks per second, and the highest tick rate.
+     * Timers count in these regardless of the engine tick rate, so delays keep their length when the rate changes.
+     * Tick rates dividing it advance timers by a whole number of steps every tick.
      */
-    using tick_t = std::chrono::duration<std::uint32_t, std::ratio<1, TICK_RATE>>;
+    constexpr std::uint16_t TIMER_RATE = 120;
+
+    /**
+     * Timer duration
+     */
+    using timer_tick_t = std::chrono::duration<std::uint32_t, std::ratio<1, TIMER_RATE>>;
 }
 
 #endif
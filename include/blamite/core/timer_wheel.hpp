@@ -0,0 +1,161 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BLAMITE__CORE__TIMER_WHEEL_HPP
+#define BLAMITE__CORE__TIMER_WHEEL_HPP
+
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <functional>
+#include "tick.hpp"
+
+namespace Blamite::Engine {
+    /**
+     * Hierarchical timer wheel advanced in timer ticks, TIMER_RATE per second.
+     * Timers are kept in intrusive lists so scheduling and cancelling are O(1),
+     * and advancing only touches the timers that are due on the current tick.
+     */
+    class TimerWheel {
+    public:
+        using callback_t = std::function<void ()>;
+
+        class Handle {
+            friend TimerWheel;
+        public:
+            /**
+             * Check if handle refers to a scheduled timer
+             * NOTE: A handle stays valid after its timer fires; use TimerWheel::pending to check that.
+             */
+            bool valid() const noexcept {
+                return m_index != INVALID_INDEX;
+            }
+
+        private:
+            static constexpr std::uint32_t INVALID_INDEX = UINT32_MAX;
+
+            /** Timer slot index */
+            std::uint32_t m_index = INVALID_INDEX;
+
+            /** Timer slot generation */
+            std::uint32_t m_generation = 0;
+        };
+
+        /**
+         * Schedule a timer
+         * @param delay     Timer ticks until the timer fires, at least one
+         * @param callback  Function to be called when the timer fires
+         * @return          Handle for the scheduled timer
+         */
+        Handle schedule(timer_tick_t delay, callback_t callback) noexcept;
+
+        /**
+         * Cancel a timer
+         * @param handle    Timer handle; it is invalidated after this call
+         * @return          True if the timer was pending, false if it already fired or was cancelled
+         */
+        bool cancel(Handle &handle) noexcept;
+
+        /**
+         * Check if a timer is still pending
+         */
+        bool pending(const Handle &handle) const noexcept;
+
+        /**
+         * Advance wheel one timer tick and fire expired timers
+         */
+        void advance() noexcept;
+
+        /**
+         * Get number of pending timers
+         */
+        std::size_t size() const noexcept;
+
+        /**
+         * Get current wheel tick
+         */
+        std::uint64_t current_tick() const noexcept;
+
+        /**
+         * Constructor for timer wheel
+         */
+        TimerWheel() noexcept;
+
+        /**
+         * Deleted copy constructor
+         */
+        TimerWheel(const TimerWheel &) = delete;
+
+    private:
+        struct Timer {
+            /** Tick when timer expires */
+            std::uint64_t expiry;
+
+            /** Previous timer in slot list */
+            std::uint32_t prev;
+
+            /** Next timer in slot list or in free list */
+            std::uint32_t next;
+
+            /** Wheel slot where timer is linked */
+            std::uint32_t slot;
+
+            /** Generation for handle validation */
+            std::uint32_t generation;
+
+            /** Timer callback */
+            callback_t callback;
+        };
+
+        /** Null timer index */
+        static constexpr std::uint32_t c_null = UINT32_MAX;
+
+        /** Bits of tick resolved by each level */
+        static constexpr std::size_t c_level_bits = 6;
+
+        /** Slots per level */
+        static constexpr std::size_t c_level_slots = 1 << c_level_bits;
+
+        /** Number of levels; four levels cover about a day and a half of timer ticks */
+        static constexpr std::size_t c_levels = 4;
+
+        /** Maximum delay that can be scheduled */
+        static constexpr std::uint64_t c_max_delay = (std::uint64_t(1) << (c_level_bits * c_levels)) - 1;
+
+        /** Timers storage */
+        std::vector<Timer> m_timers;
+
+        /** First free timer */
+        std::uint32_t m_free_head = c_null;
+
+        /** Slot list heads */
+        std::array<std::uint32_t, c_level_slots * c_levels> m_slots;
+
+        /** Current tick */
+        std::uint64_t m_tick = 0;
+
+        /** Pending timers count */
+        std::size_t m_size = 0;
+
+        /**
+         * Link timer to the slot matching its expiry
+         */
+        void link(std::uint32_t index) noexcept;
+
+        /**
+         * Unlink timer from its slot
+         */
+        void unlink(std::uint32_t index) noexcept;
+
+        /**
+         * Release timer storage
+         */
+        void release(std::uint32_t index) noexcept;
+
+        /**
+         * Move timers of a slot to lower levels
+         */
+        void cascade(std::size_t level) noexcept;
+    };
+}
+
+#endif
@@ -0,0 +1,178 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BLAMITE__CORE__TRACE_HPP
+#define BLAMITE__CORE__TRACE_HPP
+
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace Blamite::Engine {
+    /**
+     * Timeline of what every thread was doing, for finding out why a given tick was slow.
+     * Traced scopes record an event with their name, start and end into a ring owned by the calling thread, so
+     * threads never contend while tracing. Rings are made on the first event of each thread and outlive it.
+     * Events can be written out as Chrome trace_event JSON, to be opened in chrome://tracing or Perfetto.
+     * While tracing is off a traced scope costs a relaxed load and a branch.
+     * NOTE: There is a single tracer per process, shared by every engine.
+     */
+    class Tracer {
+    public:
+        /** Events kept per thread */
+        static constexpr std::size_t RING_SIZE = 1 << 15;
+
+        struct DumpStats {
+            /** Events written */
+            std::size_t events;
+
+            /** Threads with events written */
+            std::size_t threads;
+        };
+
+        /**
+         * Start or stop recording events
+         */
+        void set_enabled(bool enabled) noexcept;
+
+        /**
+         * Check if events are being recorded
+         */
+        bool enabled() const noexcept {
+            return m_enabled.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * Get current trace timestamp in nanoseconds
+         */
+        std::uint64_t now() const noexcept {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_epoch).count();
+        }
+
+        /**
+         * Record an event on the calling thread
+         * @param name      Event name; must outlive the tracer, e.g. a string literal
+         * @param begin     Event start timestamp
+         * @param end       Event end timestamp
+         */
+        void record(const char *name, std::uint64_t begin, std::uint64_t end) noexcept;
+
+        /**
+         * Name the calling thread in written traces
+         */
+        void set_thread_name(std::string name) noexcept;
+
+        /**
+         * Write recent events as Chrome trace_event JSON
+         * @param path      File path
+         * @param seconds   Only write events that ended this recently; every event kept if longer than the trace
+         * @param stats     What was written
+         * @return          False if the file cannot be written
+         */
+        bool write_chrome_trace(const std::string &path, double seconds, DumpStats &stats) noexcept;
+
+        /**
+         * Get process tracer
+         */
+        static Tracer &get() noexcept {
+            return s_tracer;
+        }
+
+    private:
+        struct Event {
+            /** Event name */
+            std::atomic<const char *> name{nullptr};
+
+            /** Event start and end timestamps */
+            std::atomic<std::uint64_t> begin{0};
+            std::atomic<std::uint64_t> end{0};
+        };
+
+        struct Ring {
+            /** Thread identifier in written traces */
+            std::uint32_t thread_id;
+
+            /** Thread name; guarded by the tracer mutex */
+            std::string thread_name;
+
+            /** Events; slot of event i is i % RING_SIZE */
+            std::unique_ptr<Event[]> events;
+
+            /** Events ever recorded */
+            alignas(64) std::atomic<std::uint64_t> head{0};
+        };
+
+        /** Events are being recorded */
+        std::atomic<bool> m_enabled{false};
+
+        /** Timestamps are nanoseconds since this */
+        std::chrono::steady_clock::time_point m_epoch = std::chrono::steady_clock::now();
+
+        /** Every thread ring */
+        std::vector<std::unique_ptr<Ring>> m_rings;
+
+        /** Guards the ring list and thread names */
+        std::mutex m_mutex;
+
+        /** Process tracer */
+        static Tracer s_tracer;
+
+        /**
+         * Get ring of the calling thread, making it on first use
+         */
+        Ring &thread_ring() noexcept;
+    };
+
+    /**
+     * Records an event spanning its lifetime
+     */
+    class TraceScope {
+    public:
+        /**
+         * Start traced scope
+         * @param name      Event name; must outlive the tracer, e.g. a string literal
+         */
+        TraceScope(const char *name) noexcept {
+            auto &tracer = Tracer::get();
+            if(tracer.enabled()) {
+                m_name = name;
+                m_begin = tracer.now();
+            }
+        }
+
+        /**
+         * Deleted copy constructor
+         */
+        TraceScope(const TraceScope &) = delete;
+
+        /**
+         * End traced scope
+         */
+        ~TraceScope() noexcept {
+            if(m_name) {
+                auto &tracer = Tracer::get();
+                tracer.record(m_name, m_begin, tracer.now());
+            }
+        }
+
+    private:
+        /** Event name, or null if tracing was off when the scope started */
+        const char *m_name = nullptr;
+
+        /** Event start timestamp */
+        std::uint64_t m_begin = 0;
+    };
+}
+
+#define BLAMITE_TRACE_CONCAT_(a, b) a##b
+#define BLAMITE_TRACE_CONCAT(a, b) BLAMITE_TRACE_CONCAT_(a, b)
+
+/**
+ * Trace the rest of the enclosing scope under a name, which must be a string literal
+ */
+#define TRACE_SCOPE(name) ::Blamite::Engine::TraceScope BLAMITE_TRACE_CONCAT(trace_scope_, __LINE__)("" name)
+
+#endif
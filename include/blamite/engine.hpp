@@ -7,34 +7,184 @@
 #include <winsock2.h>
 #endif
 #include <iostream>
+#include <atomic>
 #include <chrono>
 #include "console/console.hpp"
+#include "core/event_log.hpp"
+#include "core/job_system.hpp"
+#include "core/metrics.hpp"
 #include "core/tick.hpp"
+#include "game/entities.hpp"
+#include "memory/frame_arena.hpp"
+#include "network/metrics_server.hpp"
+#include "network/rcon.hpp"
 #include "network/server.hpp"
 
 namespace Blamite::Engine {
+    class EngineHost;
+
     class Engine {
+        friend EngineHost;
     public:
+        /**
+         * Initialize console
+         * NOTE: Server initialization does this with defaults if it was not done before
+         * @param headless      Run without a terminal, writing plain lines to stdout
+         * @param command_fifo  FIFO to read commands from in headless mode
+         * @param read_stdin    Read commands from stdin in headless mode when there is no FIFO
+         */
+        void init_console(bool headless = false, const char *command_fifo = nullptr, bool read_stdin = true) noexcept;
+
         /**
          * Initialize blamite server stuff
          */
         void init_server(int port) noexcept;
 
         /**
-         * Start engine
+         * Initialize blamite server stuff over a given transport, e.g. a loopback one for tests and benchmarks
+         */
+        void init_server(std::unique_ptr<Network::Transport> transport) noexcept;
+
+        /**
+         * Start remote console
+         * @param port      TCP port
+         * @param password  Session password
+         */
+        void start_rcon(int port, std::string password) noexcept;
+
+        /**
+         * Start serving metrics over HTTP
+         * @param port      TCP port
+         */
+        void start_metrics(int port) noexcept;
+
+        /**
+         * Start recording events to a binary log
+         * @param path      Log file path
+         */
+        void start_event_log(std::string path) noexcept;
+
+        /**
+         * Start recording inbound traffic for replay
+         * @param path      Recording file path
+         */
+        void start_traffic_recording(std::string path) noexcept;
+
+        /**
+         * Set tick rate
+         * The new rate is used from the next tick on, unless the engine is idling at its idle rate.
+         * @param ticks_per_second  Tick rate, from 1 to TIMER_RATE
+         */
+        void set_tick_rate(std::uint16_t ticks_per_second) noexcept;
+
+        /**
+         * Get tick rate set
+         */
+        std::uint16_t tick_rate() const noexcept;
+
+        /**
+         * Set tick rate used while no clients are connected, to save CPU on empty servers
+         * The engine idles once it has had no clients and no traffic for a while, and any datagram brings it back
+         * to the set rate; the first datagram of a connection waits up to one idle tick.
+         * @param ticks_per_second  Idle tick rate, from 1 to TIMER_RATE, or 0 to tick at the same rate when idle
+         */
+        void set_idle_tick_rate(std::uint16_t ticks_per_second) noexcept;
+
+        /**
+         * Get idle tick rate
+         * @return      Idle tick rate, or 0 if the engine does not idle
+         */
+        std::uint16_t idle_tick_rate() const noexcept;
+
+        /**
+         * Get tick rate the engine is running at, which is the idle rate while idling
+         */
+        std::uint16_t active_tick_rate() const noexcept;
+
+        /**
+         * Get time between ticks at the rate the engine is running at
+         */
+        std::chrono::steady_clock::duration tick_period() const noexcept;
+
+        /**
+         * Set job system used to run tick phases in parallel
+         * @param jobs      Job system, possibly shared with other engines; null runs the tick serially
+         */
+        void set_job_system(JobSystem *jobs) noexcept;
+
+        /**
+         * Start engine and run its main loop on this thread until it is stopped
          */
         void start() noexcept;
 
+        /**
+         * Run one tick without waiting for the next one
+         * NOTE: The engine must be bound to the calling thread
+         */
+        void tick() noexcept;
+
+        /**
+         * Ask the engine to stop; its main loop exits after the current tick
+         * NOTE: This is safe from any thread
+         */
+        void stop() noexcept;
+
+        /**
+         * Check if the engine was asked to stop
+         */
+        bool stopped() const noexcept;
+
+        /**
+         * Make this the engine returned by get() on the calling thread
+         */
+        void bind() noexcept;
+
         /**
          * Get engine console
          */
         Console &console() noexcept;
 
+        /**
+         * Get game server
+         */
+        Network::Server &server() noexcept;
+
+        /**
+         * Get game entities
+         */
+        EntityStore &entities() noexcept;
+
+        /**
+         * Get event log
+         * @return      Event log, or nullptr if events are not being recorded
+         */
+        EventLog *event_log() noexcept;
+
+        /**
+         * Get engine metrics
+         */
+        Metrics &metrics() noexcept;
+
+        /**
+         * Get arena for data that only lives until the end of the tick
+         */
+        FrameArena &frame_arena() noexcept;
+
+        /**
+         * Get number of heap allocations the engine thread made during the last tick
+         */
+        std::size_t tick_allocations() const noexcept;
+
         /**
          * Get tick count
          */
         std::size_t tick_count() const noexcept;
 
+        /**
+         * Get time the current tick started at
+         */
+        std::chrono::steady_clock::time_point tick_start() const noexcept;
+
         /**
          * Get current tick timestamp in milliseconds
          */
@@ -42,17 +192,24 @@ namespace Blamite::Engine {
 
         /**
          * Constructor for engine
+         * @param datagram_pool     Pool the server takes received datagrams from, shared with other engines ticking
+         *                          on the same thread; the server makes its own if null
+         */
+        Engine(BufferPool *datagram_pool = nullptr) noexcept;
+
+        /**
+         * Deleted copy constructor
          */
-        Engine() noexcept;
+        Engine(const Engine &) = delete;
 
-        /** 
-         * Main loop stop flag
-         * When this is set, the main loop exits.
+        /**
+         * Destructor for engine
          */
-        static bool m_main_loop_stop_flag;
+        ~Engine() noexcept;
 
         /**
-         * Get instance pointer
+         * Get engine bound to the calling thread
+         * Console commands use this to reach the engine that runs them.
          */
         static Engine &get() noexcept;
 
@@ -60,30 +217,148 @@ namespace Blamite::Engine {
         /** Initialized */
         bool m_initialized = false;
 
+        /** Console initialized */
+        bool m_console_initialized = false;
+
+        /** Main loop stop flag */
+        std::atomic<bool> m_stop_flag{false};
+
+        /** Shared pool for received datagrams, or null */
+        BufferPool *m_datagram_pool;
+
+        /** Job system for parallel tick phases, or null */
+        JobSystem *m_job_system = nullptr;
+
+        /** Tick phases; rebuilt every tick */
+        TaskGraph m_tick_graph;
+
+        /** Entities advanced by each simulation task */
+        static constexpr std::size_t c_entity_chunk_size = 4096;
+
+        /** Tick rate set */
+        std::uint16_t m_tick_rate = DEFAULT_TICK_RATE;
+
+        /** Idle tick rate, or 0 */
+        std::uint16_t m_idle_tick_rate = 0;
+
+        /** Time without clients or traffic before idling */
+        static constexpr std::chrono::seconds c_idle_delay{1};
+
+        /** Start of the last tick with clients or traffic, or when the server started */
+        std::chrono::steady_clock::time_point m_last_activity;
+
+        /** Tick rate the engine is running at */
+        std::uint16_t m_active_tick_rate = 0;
+
+        /** Time between ticks at the active rate */
+        std::chrono::steady_clock::duration m_tick_period;
+
+        /** A tick is running; tick rate changes wait for it to end */
+        bool m_ticking = false;
+
+        /** Tick body specialized for the active rate */
+        void (Engine::*m_tick_function)() noexcept;
+
+        /** Timer ticks owed by previous ticks, at rates that do not divide TIMER_RATE */
+        std::size_t m_timer_credit = 0;
+
         /** Tick count */
-        tick_t m_ticks_count;
+        std::size_t m_ticks_count = 0;
 
         /** Last tick timestamp */
         std::chrono::steady_clock::duration m_last_tick_timestamp;
 
+        /** Current tick start */
+        std::chrono::steady_clock::time_point m_tick_start;
+
+        /** Transient tick data; reset at the end of every tick */
+        FrameArena m_frame_arena;
+
+        /** Heap allocations during the last tick */
+        std::size_t m_tick_allocations = 0;
+
+        /** Metrics; outlive the server, which updates them until it is gone */
+        Metrics m_metrics;
+
+        /** Ticks run */
+        Counter *m_ticks_metric;
+
+        /** Tick durations */
+        Histogram *m_tick_duration_metric;
+
+        /** Heap allocations during the last tick */
+        Gauge *m_tick_allocations_metric;
+
+        /** Tick rate the engine is running at */
+        Gauge *m_tick_rate_metric;
+
+        /** Connected clients */
+        Gauge *m_clients_metric;
+
+        /** Game entities */
+        Gauge *m_entities_metric;
+
         /** Sockpp RAII object */
         sockpp::socket_initializer m_sock_init;
 
         /** Console handle */
         Console m_console;
 
+        /** Event log; outlives the server so shutdown disconnections are recorded */
+        std::unique_ptr<EventLog> m_event_log;
+
         /** Server */
         std::unique_ptr<Network::Server> m_server;
 
+        /** Remote console */
+        std::unique_ptr<Network::RconServer> m_rcon;
+
+        /** Metrics endpoint */
+        std::unique_ptr<Network::MetricsServer> m_metrics_server;
+
+        /** Game entities */
+        EntityStore m_entities;
+
+        /** View radius of clients around the entities they own */
+        const float c_client_view_radius = 128.0f;
+
         /**
-         * Engine main loop
+         * Run one tick at a given rate
+         * Rates the tick is specialized for have their tick length and timer steps worked out at compile time;
+         * rate 0 works them out from the active rate.
          */
-        void main_loop() noexcept;
+        template<std::uint16_t Rate> void tick_at() noexcept;
 
-        /** 
-         * Singleton
+        /**
+         * Switch to the idle rate or back to the set rate if needed
          */
-        static Engine *instance;
+        void update_tick_rate() noexcept;
+
+        /**
+         * Switch the tick body and period to a rate
+         */
+        void apply_tick_rate(std::uint16_t ticks_per_second) noexcept;
+
+        /**
+         * Read datagrams and process them, then fire due timers
+         * @param timer_steps   Timer ticks elapsed since the last tick
+         */
+        void receive(std::size_t timer_steps) noexcept;
+
+        /**
+         * Feed entity changes to server replication
+         */
+        void replicate_entities() noexcept;
+
+        /**
+         * Print banner and listening address
+         */
+        void announce() noexcept;
+
+        /**
+         * Engine main loop
+         */
+        void main_loop() noexcept;
     };
 }
 
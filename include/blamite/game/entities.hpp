@@ -0,0 +1,213 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BLAMITE__GAME__ENTITIES_HPP
+#define BLAMITE__GAME__ENTITIES_HPP
+
+#include <vector>
+#include <cstdint>
+#include <blamite/math/vector.hpp>
+
+namespace Blamite::Engine {
+    /**
+     * Entity storage with components in separate contiguous arrays.
+     * Live entities are kept packed at the front of every component array, so per-tick systems walk plain
+     * arrays and never see dead entries. Handles point to slots that map to the packed index; slots are
+     * recycled through a free list and carry a generation so stale handles are rejected.
+     */
+    class EntityStore {
+    public:
+        class Handle {
+            friend EntityStore;
+        public:
+            /**
+             * Get handle value; low 16 bits are the slot and high 16 bits the generation
+             */
+            std::uint32_t value() const noexcept {
+                return m_value;
+            }
+
+            /**
+             * Check if handle was ever assigned
+             */
+            bool valid() const noexcept {
+                return m_value != INVALID_VALUE;
+            }
+
+            bool operator==(const Handle &other) const noexcept {
+                return m_value == other.m_value;
+            }
+
+            bool operator!=(const Handle &other) const noexcept {
+                return m_value != other.m_value;
+            }
+
+        private:
+            static constexpr std::uint32_t INVALID_VALUE = UINT32_MAX;
+
+            /** Handle value */
+            std::uint32_t m_value = INVALID_VALUE;
+
+            /**
+             * Get handle slot
+             */
+            std::uint16_t slot() const noexcept {
+                return m_value & 0xFFFF;
+            }
+
+            /**
+             * Get handle generation
+             */
+            std::uint16_t generation() const noexcept {
+                return m_value >> 16;
+            }
+        };
+
+        /** Owner value of entities not owned by a client */
+        static constexpr std::uint32_t NO_OWNER = UINT32_MAX;
+
+        /** Maximum number of entities */
+        static constexpr std::size_t MAX_ENTITIES = 0xFFFF;
+
+        /**
+         * Create an entity
+         * @param position  Initial position
+         * @param velocity  Initial velocity in world units per second
+         * @param health    Initial health
+         * @param owner     Owner client identifier
+         * @return          Entity handle; invalid if store is full
+         */
+        Handle create(const Vector3D &position, const Vector3D &velocity, float health, std::uint32_t owner = NO_OWNER) noexcept;
+
+        /**
+         * Destroy an entity
+         * @return      True if entity was alive
+         */
+        bool destroy(Handle handle) noexcept;
+
+        /**
+         * Check if entity is alive
+         */
+        bool alive(Handle handle) const noexcept;
+
+        /**
+         * Get entity position
+         * @return      Pointer to position, or null if entity is dead
+         */
+        Vector3D *position(Handle handle) noexcept;
+
+        /**
+         * Get entity velocity
+         * @return      Pointer to velocity, or null if entity is dead
+         */
+        Vector3D *velocity(Handle handle) noexcept;
+
+        /**
+         * Get entity health
+         * @return      Pointer to health, or null if entity is dead
+         */
+        float *health(Handle handle) noexcept;
+
+        /**
+         * Get entity owner
+         * @return      Owner client identifier, or NO_OWNER
+         */
+        std::uint32_t owner(Handle handle) const noexcept;
+
+        /**
+         * Advance entities
+         * @param delta     Elapsed time in seconds
+         */
+        void tick(float delta) noexcept;
+
+        /**
+         * Advance a range of live entities; ranges that do not overlap can be advanced from different threads
+         * @param delta     Elapsed time in seconds
+         * @param begin     First entity of the range
+         * @param end       Entity after the last one of the range
+         */
+        void tick(float delta, std::size_t begin, std::size_t end) noexcept;
+
+        /**
+         * Get number of live entities
+         */
+        std::size_t size() const noexcept;
+
+        /**
+         * Get handles of entities created since last clear
+         * NOTE: Entities destroyed after being created are listed in both lists.
+         */
+        const std::vector<Handle> &created() const noexcept;
+
+        /**
+         * Get handles of entities destroyed since last clear
+         */
+        const std::vector<Handle> &destroyed() const noexcept;
+
+        /**
+         * Forget created and destroyed entities
+         */
+        void clear_changes() noexcept;
+
+        /**
+         * Call a function for every live entity
+         * The function gets the entity handle, position, velocity, health and owner.
+         */
+        template<typename T> void for_each(T &&function) const {
+            for(std::size_t i = 0; i < m_dense_slots.size(); i++) {
+                function(make_handle(m_dense_slots[i]), m_positions[i], m_velocities[i], m_health[i], m_owners[i]);
+            }
+        }
+
+        /**
+         * Reserve component storage
+         */
+        void reserve(std::size_t count) noexcept;
+
+    private:
+        /** Slot used by no entity */
+        static constexpr std::uint32_t c_no_index = UINT32_MAX;
+
+        /** Packed index of each slot */
+        std::vector<std::uint32_t> m_slot_indices;
+
+        /** Generation of each slot */
+        std::vector<std::uint16_t> m_slot_generations;
+
+        /** Free slots */
+        std::vector<std::uint16_t> m_free_slots;
+
+        /** Slot of each packed entity */
+        std::vector<std::uint16_t> m_dense_slots;
+
+        /** Positions */
+        std::vector<Vector3D> m_positions;
+
+        /** Velocities */
+        std::vector<Vector3D> m_velocities;
+
+        /** Health */
+        std::vector<float> m_health;
+
+        /** Owner client identifiers */
+        std::vector<std::uint32_t> m_owners;
+
+        /** Entities created since last clear */
+        std::vector<Handle> m_created;
+
+        /** Entities destroyed since last clear */
+        std::vector<Handle> m_destroyed;
+
+        /**
+         * Build a handle for a slot
+         */
+        Handle make_handle(std::uint16_t slot) const noexcept;
+
+        /**
+         * Get packed index of a handle
+         * @return      Packed index, or c_no_index if entity is dead
+         */
+        std::uint32_t index_of(Handle handle) const noexcept;
+    };
+}
+
+#endif
@@ -0,0 +1,82 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BLAMITE__ENGINE__HOST_HPP
+#define BLAMITE__ENGINE__HOST_HPP
+
+#include <vector>
+#include <memory>
+#include "engine.hpp"
+
+namespace Blamite::Engine {
+    /**
+     * Runs several independent engines in one process.
+     * Engines are spread over a fixed number of threads, so N servers do not need N threads; each thread ticks the
+     * engines that are due one after another and then sleeps until the next one is, and every engine keeps its own
+     * tick rate. Engines on the same thread share a pool for received datagrams, since they never touch it at the
+     * same time, and every engine shares one job system for the parallel parts of its tick. Everything else stays
+     * per engine.
+     * The first engine added is the primary one: once it stops, every other engine is stopped too.
+     */
+    class EngineHost {
+    public:
+        /**
+         * Create an engine
+         * Engines are given to threads in turn. The engine must be initialized before the host is run.
+         * @return      Engine; it is owned by the host
+         */
+        Engine &add() noexcept;
+
+        /**
+         * Get engines
+         */
+        const std::vector<std::unique_ptr<Engine>> &engines() const noexcept;
+
+        /**
+         * Run every engine until the primary one stops
+         */
+        void run() noexcept;
+
+        /**
+         * Stop every engine
+         * NOTE: This is safe from any thread
+         */
+        void stop() noexcept;
+
+        /**
+         * Constructor for engine host
+         * @param threads   Number of threads ticking engines
+         * @param workers   Number of job system workers helping engines with their ticks
+         */
+        EngineHost(std::size_t threads, std::size_t workers = 0) noexcept;
+
+        /**
+         * Deleted copy constructor
+         */
+        EngineHost(const EngineHost &) = delete;
+
+    private:
+        struct Group {
+            /** Received datagrams buffers shared by the group engines */
+            BufferPool datagram_pool{Network::Server::MAX_DATAGRAM_SIZE, 64};
+
+            /** Engines ticked by the group thread */
+            std::vector<Engine *> engines;
+        };
+
+        /** Engine groups, one per thread; declared first so pools outlive the engines */
+        std::vector<std::unique_ptr<Group>> m_groups;
+
+        /** Job system shared by every engine, or null */
+        std::unique_ptr<JobSystem> m_job_system;
+
+        /** Engines */
+        std::vector<std::unique_ptr<Engine>> m_engines;
+
+        /**
+         * Tick the engines of a group until all of them stop
+         */
+        void run_group(Group &group) noexcept;
+    };
+}
+
+#endif
@@ -0,0 +1,33 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BLAMITE__MATH__VECTOR_HPP
+#define BLAMITE__MATH__VECTOR_HPP
+
+namespace Blamite::Engine {
+    struct Vector3D {
+        float x = 0.0f;
+        float y = 0.0f;
+        float z = 0.0f;
+
+        Vector3D operator+(const Vector3D &other) const noexcept {
+            return {x + other.x, y + other.y, z + other.z};
+        }
+
+        Vector3D operator-(const Vector3D &other) const noexcept {
+            return {x - other.x, y - other.y, z - other.z};
+        }
+
+        Vector3D operator*(float scale) const noexcept {
+            return {x * scale, y * scale, z * scale};
+        }
+
+        /**
+         * Get squared length of vector
+         */
+        float length_squared() const noexcept {
+            return x * x + y * y + z * z;
+        }
+    };
+}
+
+#endif
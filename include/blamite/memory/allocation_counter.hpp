@@ -0,0 +1,16 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BLAMITE__MEMORY__ALLOCATION_COUNTER_HPP
+#define BLAMITE__MEMORY__ALLOCATION_COUNTER_HPP
+
+#include <cstddef>
+
+namespace Blamite::Engine {
+    /**
+     * Get number of global heap allocations made by the calling thread so far
+     * Linking the engine replaces the global operator new to keep this count.
+     */
+    std::size_t heap_allocations() noexcept;
+}
+
+#endif
@@ -0,0 +1,122 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BLAMITE__MEMORY__BUFFER_POOL_HPP
+#define BLAMITE__MEMORY__BUFFER_POOL_HPP
+
+#include <vector>
+#include <memory>
+#include <cstddef>
+
+namespace Blamite::Engine {
+    /**
+     * Pool of fixed size buffers.
+     * Buffers are allocated once and recycled, so steady traffic does not hit the heap.
+     * NOTE: This is not thread safe and must outlive every buffer acquired from it.
+     */
+    class BufferPool {
+    public:
+        class Buffer {
+            friend BufferPool;
+        public:
+            /**
+             * Get buffer data
+             */
+            std::byte *data() const noexcept {
+                return m_data;
+            }
+
+            /**
+             * Get buffer capacity
+             */
+            std::size_t capacity() const noexcept;
+
+            /**
+             * Check if buffer holds memory
+             */
+            explicit operator bool() const noexcept {
+                return m_data != nullptr;
+            }
+
+            /**
+             * Give buffer back to its pool
+             */
+            void release() noexcept;
+
+            /**
+             * Default constructor
+             */
+            Buffer() = default;
+
+            /**
+             * Move constructor
+             */
+            Buffer(Buffer &&other) noexcept;
+
+            /**
+             * Move assignment
+             */
+            Buffer &operator=(Buffer &&other) noexcept;
+
+            /**
+             * Deleted copy constructor
+             */
+            Buffer(const Buffer &) = delete;
+
+            /**
+             * Destructor for buffer
+             */
+            ~Buffer() noexcept;
+
+        private:
+            /** Owner pool */
+            BufferPool *m_pool = nullptr;
+
+            /** Buffer memory */
+            std::byte *m_data = nullptr;
+        };
+
+        /**
+         * Get a buffer from the pool, allocating a new one if none is free
+         */
+        Buffer acquire() noexcept;
+
+        /**
+         * Get size of pool buffers
+         */
+        std::size_t buffer_size() const noexcept;
+
+        /**
+         * Get number of buffers allocated by the pool
+         */
+        std::size_t allocated() const noexcept;
+
+        /**
+         * Get number of buffers waiting to be reused
+         */
+        std::size_t available() const noexcept;
+
+        /**
+         * Constructor for buffer pool
+         * @param buffer_size   Size of each buffer
+         * @param reserve       Buffers allocated upfront
+         */
+        BufferPool(std::size_t buffer_size, std::size_t reserve = 0) noexcept;
+
+        /**
+         * Deleted copy constructor
+         */
+        BufferPool(const BufferPool &) = delete;
+
+    private:
+        /** Size of each buffer */
+        std::size_t m_buffer_size;
+
+        /** Buffers memory */
+        std::vector<std::unique_ptr<std::byte[]>> m_storage;
+
+        /** Free buffers */
+        std::vector<std::byte *> m_free;
+    };
+}
+
+#endif
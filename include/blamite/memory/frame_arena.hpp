@@ -0,0 +1,91 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BLAMITE__MEMORY__FRAME_ARENA_HPP
+#define BLAMITE__MEMORY__FRAME_ARENA_HPP
+
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <memory_resource>
+
+namespace Blamite::Engine {
+    /**
+     * Bump allocator for data that only lives until the end of the tick.
+     * Allocating moves a pointer forward and deallocating does nothing; reset() drops everything at once. When a
+     * tick needs more than the block holds, the excess comes from the heap and the block is grown on the next
+     * reset, so a steady workload stops touching the heap after a few ticks.
+     * Containers use it through std::pmr, e.g. std::pmr::vector<std::byte> buffer(&arena).
+     * NOTE: This is not thread safe; only one tick phase may use it at a time.
+     */
+    class FrameArena : public std::pmr::memory_resource {
+    public:
+        struct Stats {
+            /** Bytes allocated since the last reset */
+            std::size_t used;
+
+            /** Bytes allocated during the tick before the last reset */
+            std::size_t last;
+
+            /** Most bytes allocated within one tick */
+            std::size_t peak;
+
+            /** Block size */
+            std::size_t capacity;
+
+            /** Ticks that needed more than the block */
+            std::size_t overflows;
+        };
+
+        /**
+         * Release everything allocated since the last reset
+         */
+        void reset() noexcept;
+
+        /**
+         * Get arena stats
+         */
+        Stats stats() const noexcept;
+
+        /**
+         * Constructor for frame arena
+         * @param capacity  Initial block size
+         */
+        FrameArena(std::size_t capacity = 64 * 1024) noexcept;
+
+        /**
+         * Deleted copy constructor
+         */
+        FrameArena(const FrameArena &) = delete;
+
+    private:
+        /** Block memory */
+        std::unique_ptr<std::byte[]> m_block;
+
+        /** Block size */
+        std::size_t m_capacity;
+
+        /** Next free byte of the block */
+        std::size_t m_offset = 0;
+
+        /** Memory taken from the heap this tick because the block was full */
+        std::vector<std::pair<void *, std::size_t>> m_overflow;
+
+        /** Bytes allocated this tick, including overflow */
+        std::size_t m_used = 0;
+
+        /** Bytes allocated during the tick before the last reset */
+        std::size_t m_last = 0;
+
+        /** Most bytes allocated within one tick */
+        std::size_t m_peak = 0;
+
+        /** Ticks that needed more than the block */
+        std::size_t m_overflows = 0;
+
+        void *do_allocate(std::size_t bytes, std::size_t alignment) override;
+        void do_deallocate(void *pointer, std::size_t bytes, std::size_t alignment) override;
+        bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override;
+    };
+}
+
+#endif
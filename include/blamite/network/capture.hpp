@@ -0,0 +1,115 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BLAMITE__ENGINE__NETWORK__CAPTURE_HPP
+#define BLAMITE__ENGINE__NETWORK__CAPTURE_HPP
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <sockpp/inet_address.h>
+
+namespace Blamite::Engine::Network {
+    /**
+     * Ring of the most recent datagrams sent and received by the server.
+     * Recording copies the datagram into the next slot and never blocks or allocates; once the ring is full the
+     * oldest datagrams are overwritten. Slots are guarded by sequence numbers, so a snapshot can be taken from
+     * any thread and simply skips slots being written meanwhile.
+     */
+    class PacketCapture {
+    public:
+        enum Direction : std::uint8_t {
+            DIRECTION_IN,
+            DIRECTION_OUT
+        };
+
+        struct Record {
+            /** Unix time in microseconds */
+            std::uint64_t time;
+
+            /** Whether the server received or sent it */
+            Direction direction;
+
+            /** Remote address */
+            sockpp::inet_address peer;
+
+            /** Datagram size on the wire */
+            std::size_t size;
+
+            /** Captured bytes, up to SNAPSHOT_LENGTH */
+            std::vector<std::byte> data;
+        };
+
+        struct Stats {
+            /** Datagrams recorded since capture started */
+            std::size_t recorded;
+
+            /** Ring slots */
+            std::size_t slots;
+        };
+
+        /** Bytes kept of each datagram */
+        static constexpr std::size_t SNAPSHOT_LENGTH = 1500;
+
+        /** Most datagrams a ring can keep, about 100 MB worth of slots */
+        static constexpr std::size_t MAX_SLOTS = 1 << 16;
+
+        /**
+         * Record a datagram
+         */
+        void record(Direction direction, const sockpp::inet_address &peer, const void *data, std::size_t size) noexcept;
+
+        /**
+         * Copy datagrams in the ring, oldest first
+         */
+        std::vector<Record> snapshot() const noexcept;
+
+        /**
+         * Get capture stats
+         */
+        Stats stats() const noexcept;
+
+        /**
+         * Write records to a pcap file as IPv4 UDP packets between a local address and their peers
+         * @return      False if the file cannot be written
+         */
+        static bool write_pcap(const std::string &path, const sockpp::inet_address &local, const std::vector<Record> &records) noexcept;
+
+        /**
+         * Constructor for packet capture
+         * @param slots     Datagrams kept, up to MAX_SLOTS
+         * @throws std::runtime_error if there are too many slots or they cannot be allocated
+         */
+        PacketCapture(std::size_t slots);
+
+        /**
+         * Deleted copy constructor
+         */
+        PacketCapture(const PacketCapture &) = delete;
+
+    private:
+        struct Slot {
+            /** Odd while being written; 2 * (index + 1) once the datagram with that index is in */
+            std::atomic<std::uint64_t> sequence{0};
+
+            std::uint64_t time;
+            Direction direction;
+            std::uint32_t address;
+            std::uint16_t port;
+            std::uint32_t size;
+            std::byte data[SNAPSHOT_LENGTH];
+        };
+
+        /** Ring */
+        std::unique_ptr<Slot[]> m_slots;
+
+        /** Ring size */
+        std::size_t m_slots_count;
+
+        /** Index of the next datagram */
+        std::atomic<std::uint64_t> m_next{0};
+    };
+}
+
+#endif
@@ -0,0 +1,186 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BLAMITE__ENGINE__NETWORK__FRAGMENT_HPP
+#define BLAMITE__ENGINE__NETWORK__FRAGMENT_HPP
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <blamite/core/timer_wheel.hpp>
+#include <blamite/memory/buffer_pool.hpp>
+#include <blamite/memory/struct.hpp>
+
+namespace Blamite::Engine::Network {
+    struct PACKED FragmentHeader {
+        /** Message identifier */
+        std::uint16_t message_id;
+
+        /** Fragment index */
+        std::uint8_t index;
+
+        /** Number of fragments of the message */
+        std::uint8_t count;
+    };
+
+    /**
+     * Inbound message reassembler.
+     * Fragments stay in the pooled datagram buffers they were received into and the complete message
+     * is handed out as a list of slices over them, so nothing is copied on the way. Memory held per
+     * client is bounded and incomplete messages are dropped after a timeout.
+     */
+    class Reassembler {
+    public:
+        struct Fragment {
+            /** Datagram holding the fragment */
+            BufferPool::Buffer datagram;
+
+            /** Fragment payload offset in datagram */
+            std::size_t offset = 0;
+
+            /** Fragment payload size */
+            std::size_t size = 0;
+
+            /**
+             * Get fragment payload
+             */
+            const std::byte *data() const noexcept {
+                return datagram.data() + offset;
+            }
+        };
+
+        class Message {
+            friend Reassembler;
+        public:
+            /**
+             * Get message size
+             */
+            std::size_t size() const noexcept {
+                return m_size;
+            }
+
+            /**
+             * Get number of slices
+             */
+            std::size_t slices() const noexcept {
+                return m_count;
+            }
+
+            /**
+             * Get a message slice
+             */
+            const Fragment &slice(std::size_t index) const noexcept {
+                return m_fragments[index];
+            }
+
+            /**
+             * Copy message into a contiguous buffer
+             * @param output    Buffer of at least size() bytes
+             */
+            void copy_to(std::byte *output) const noexcept;
+
+        private:
+            /** Message slices */
+            const Fragment *m_fragments;
+
+            /** Number of slices */
+            std::size_t m_count;
+
+            /** Message size */
+            std::size_t m_size;
+        };
+
+        using handler_t = std::function<void (const Message &)>;
+
+        /** Maximum fragments of a single message */
+        static constexpr std::size_t MAX_FRAGMENTS = 64;
+
+        /**
+         * Push a received fragment
+         * @param datagram  Datagram buffer; ownership is taken if the fragment has to be kept
+         * @param offset    Offset of the fragment header in datagram
+         * @param size      Size of the fragment including its header
+         * @param handler   Function called when a message is complete
+         * @return          False if the fragment was malformed or did not fit in the reassembly budget
+         */
+        bool push(BufferPool::Buffer &datagram, std::size_t offset, std::size_t size, const handler_t &handler) noexcept;
+
+        /**
+         * Get number of fragments held
+         */
+        std::size_t held_fragments() const noexcept;
+
+        /**
+         * Get number of messages dropped because they were stale or did not fit
+         */
+        std::size_t dropped_messages() const noexcept;
+
+        /**
+         * Constructor for reassembler
+         * @param timers    Timer wheel used to expire stale messages
+         * @param timeout   Time given to a message to complete
+         */
+        Reassembler(TimerWheel &timers, timer_tick_t timeout) noexcept;
+
+        /**
+         * Deleted copy constructor
+         */
+        Reassembler(const Reassembler &) = delete;
+
+        /**
+         * Destructor for reassembler
+         */
+        ~Reassembler() noexcept;
+
+    private:
+        struct Slot {
+            /** Slot is in use */
+            bool active = false;
+
+            /** Message identifier */
+            std::uint16_t message_id;
+
+            /** Number of fragments of the message */
+            std::size_t count;
+
+            /** Number of fragments received */
+            std::size_t received;
+
+            /** Bytes received */
+            std::size_t size;
+
+            /** Timer for dropping the message if it does not complete */
+            TimerWheel::Handle timeout_timer;
+
+            /** Fragments by index */
+            std::array<Fragment, MAX_FRAGMENTS> fragments;
+        };
+
+        /** Messages that can be reassembled at once */
+        static constexpr std::size_t c_max_messages = 4;
+
+        /** Fragments that can be held at once */
+        static constexpr std::size_t c_max_held_fragments = MAX_FRAGMENTS * 2;
+
+        /** Timer wheel */
+        TimerWheel &m_timers;
+
+        /** Message timeout */
+        timer_tick_t m_timeout;
+
+        /** Reassembly slots */
+        std::array<Slot, c_max_messages> m_slots;
+
+        /** Fragments held */
+        std::size_t m_held_fragments = 0;
+
+        /** Messages dropped */
+        std::size_t m_dropped_messages = 0;
+
+        /**
+         * Free a slot and give its buffers back
+         */
+        void release(Slot &slot) noexcept;
+    };
+}
+
+#endif
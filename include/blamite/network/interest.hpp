@@ -0,0 +1,202 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BLAMITE__ENGINE__NETWORK__INTEREST_HPP
+#define BLAMITE__ENGINE__NETWORK__INTEREST_HPP
+
+#include <vector>
+#include <cstdint>
+#include <unordered_map>
+#include <blamite/math/vector.hpp>
+
+namespace Blamite::Engine::Network {
+    /**
+     * Interest management over a uniform spatial hash grid.
+     * Objects live in the grid cell under their position and observers watch every cell within their view
+     * radius on the horizontal plane. An object is relevant to an observer while it is in one of its watched
+     * cells. Relevance is updated incrementally: only cell changes of objects and observers produce work, and
+     * they are reported as enter and leave events.
+     */
+    class InterestManager {
+    public:
+        using object_id_t = std::uint32_t;
+        using observer_id_t = std::uint32_t;
+
+        /** Most cells an observer view spans on each axis; larger views are cut down to it */
+        static constexpr std::int32_t MAX_VIEW_CELLS = 64;
+
+        struct Event {
+            /** Observer */
+            observer_id_t observer;
+
+            /** Object that became relevant or irrelevant */
+            object_id_t object;
+        };
+
+        /**
+         * Add an object or move it
+         */
+        void update_object(object_id_t object, const Vector3D &position) noexcept;
+
+        /**
+         * Remove an object
+         */
+        void remove_object(object_id_t object) noexcept;
+
+        /**
+         * Add an observer or move it
+         * @param observer  Observer
+         * @param position  View position
+         * @param radius    View radius
+         * @return          False if the position is not finite or the radius is negative or not finite
+         */
+        bool update_observer(observer_id_t observer, const Vector3D &position, float radius) noexcept;
+
+        /**
+         * Remove an observer
+         */
+        void remove_observer(observer_id_t observer) noexcept;
+
+        /**
+         * Check if an object is relevant to an observer
+         */
+        bool relevant(observer_id_t observer, object_id_t object) const noexcept;
+
+        /**
+         * Get number of objects relevant to an observer
+         */
+        std::size_t relevant_count(observer_id_t observer) const noexcept;
+
+        /**
+         * Get squared distance between an observer and an object
+         */
+        float distance_squared(observer_id_t observer, object_id_t object) const noexcept;
+
+        /**
+         * Get observers an object is relevant to
+         */
+        const std::vector<observer_id_t> &watchers(object_id_t object) const noexcept;
+
+        /**
+         * Get objects updated since changes were last cleared
+         */
+        const std::vector<object_id_t> &updated_objects() const noexcept;
+
+        /**
+         * Get objects that became relevant since changes were last cleared
+         */
+        const std::vector<Event> &entered() const noexcept;
+
+        /**
+         * Get objects that stopped being relevant since changes were last cleared
+         */
+        const std::vector<Event> &left() const noexcept;
+
+        /**
+         * Clear updated objects and relevance events
+         */
+        void clear_changes() noexcept;
+
+        /**
+         * Constructor for interest manager
+         * @param cell_size     Grid cell size in world units
+         */
+        InterestManager(float cell_size = 8.0f) noexcept;
+
+    private:
+        using cell_key_t = std::uint64_t;
+
+        struct CellRange {
+            std::int32_t min_x, min_y, max_x, max_y;
+
+            bool contains(std::int32_t x, std::int32_t y) const noexcept {
+                return x >= min_x && x <= max_x && y >= min_y && y <= max_y;
+            }
+        };
+
+        struct Cell {
+            /** Objects in cell */
+            std::vector<object_id_t> objects;
+
+            /** Observers watching cell */
+            std::vector<observer_id_t> watchers;
+        };
+
+        struct Object {
+            /** Position */
+            Vector3D position;
+
+            /** Cell coordinates */
+            std::int32_t cell_x, cell_y;
+
+            /** Index in cell objects */
+            std::size_t cell_index;
+
+            /** Object is in updated objects list */
+            bool updated;
+        };
+
+        struct Observer {
+            /** View position */
+            Vector3D position;
+
+            /** Watched cells */
+            CellRange range;
+
+            /** Number of relevant objects */
+            std::size_t relevant_count;
+        };
+
+        /** Grid cell size */
+        float m_cell_size;
+
+        /** Grid cells */
+        std::unordered_map<cell_key_t, Cell> m_cells;
+
+        /** Objects */
+        std::unordered_map<object_id_t, Object> m_objects;
+
+        /** Observers */
+        std::unordered_map<observer_id_t, Observer> m_observers;
+
+        /** Objects updated since last clear */
+        std::vector<object_id_t> m_updated_objects;
+
+        /** Enter events since last clear */
+        std::vector<Event> m_entered;
+
+        /** Leave events since last clear */
+        std::vector<Event> m_left;
+
+        /**
+         * Get cell coordinate of a position component
+         */
+        std::int32_t cell_coord(float value) const noexcept;
+
+        /**
+         * Get cell key from cell coordinates
+         */
+        static cell_key_t cell_key(std::int32_t x, std::int32_t y) noexcept;
+
+        /**
+         * Remove an object from its cell
+         */
+        void unlink_object(Object &entry) noexcept;
+
+        /**
+         * Stop watching a cell
+         */
+        void unwatch_cell(observer_id_t observer, Observer &entry, std::int32_t x, std::int32_t y) noexcept;
+
+        /**
+         * Start watching a cell
+         */
+        void watch_cell(observer_id_t observer, Observer &entry, std::int32_t x, std::int32_t y) noexcept;
+
+        /**
+         * Drop cell if nothing uses it anymore
+         */
+        void collect_cell(cell_key_t key) noexcept;
+    };
+}
+
+#endif
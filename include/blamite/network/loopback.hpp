@@ -0,0 +1,186 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BLAMITE__ENGINE__NETWORK__LOOPBACK_HPP
+#define BLAMITE__ENGINE__NETWORK__LOOPBACK_HPP
+
+#include <queue>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <cstdint>
+#include <unordered_map>
+#include "transport.hpp"
+
+namespace Blamite::Engine::Network {
+    class LoopbackTransport;
+
+    /**
+     * In-process datagram network with a virtual clock.
+     * Datagrams sent between loopback transports are delivered once the network clock reaches their arrival time,
+     * so nothing depends on the kernel or on wall time. Loss, latency and jitter can be injected; jitter makes
+     * datagrams overtake each other, which is how reordering shows up. All randomness comes from a seeded
+     * generator, so a run with the same seed and the same sends is repeated exactly.
+     * NOTE: This is not thread safe.
+     */
+    class LoopbackNetwork {
+        friend LoopbackTransport;
+    public:
+        using duration_t = std::chrono::microseconds;
+
+        struct Conditions {
+            /** Chance of a datagram being dropped, from 0 to 1 */
+            double loss = 0.0;
+
+            /** Delay every datagram takes */
+            duration_t latency = duration_t(0);
+
+            /** Largest random delay added on top of latency */
+            duration_t jitter = duration_t(0);
+        };
+
+        struct Stats {
+            /** Datagrams sent */
+            std::size_t sent;
+
+            /** Datagrams dropped on purpose */
+            std::size_t lost;
+
+            /** Datagrams sent to an address nobody has */
+            std::size_t unreachable;
+
+            /** Datagrams taken by receivers */
+            std::size_t delivered;
+        };
+
+        /**
+         * Set conditions applied to datagrams sent from now on
+         */
+        void set_conditions(const Conditions &conditions) noexcept;
+
+        /**
+         * Move network clock forward
+         */
+        void advance(duration_t duration) noexcept;
+
+        /**
+         * Get network clock
+         */
+        duration_t now() const noexcept;
+
+        /**
+         * Get network stats
+         */
+        Stats stats() const noexcept;
+
+        /**
+         * Constructor for loopback network
+         * @param seed  Seed for loss and jitter
+         */
+        LoopbackNetwork(std::uint32_t seed = 0) noexcept;
+
+        /**
+         * Deleted copy constructor
+         */
+        LoopbackNetwork(const LoopbackNetwork &) = delete;
+
+    private:
+        struct Datagram {
+            /** Network time the datagram can be received at */
+            duration_t arrival;
+
+            /** Send order, so datagrams arriving together keep it */
+            std::uint64_t sequence;
+
+            /** Sender address */
+            sockpp::inet_address sender;
+
+            /** Datagram data */
+            std::vector<std::byte> data;
+        };
+
+        struct LaterArrival {
+            bool operator()(const Datagram &a, const Datagram &b) const noexcept {
+                return a.arrival != b.arrival ? a.arrival > b.arrival : a.sequence > b.sequence;
+            }
+        };
+
+        using inbox_t = std::priority_queue<Datagram, std::vector<Datagram>, LaterArrival>;
+
+        /** Transports by address */
+        std::unordered_map<std::uint64_t, LoopbackTransport *> m_transports;
+
+        /** Current conditions */
+        Conditions m_conditions;
+
+        /** Network clock */
+        duration_t m_now = duration_t(0);
+
+        /** Next datagram sequence */
+        std::uint64_t m_next_sequence = 0;
+
+        /** Loss and jitter generator */
+        std::mt19937 m_random;
+
+        /** Data buffers of delivered datagrams, reused by later sends */
+        std::vector<std::vector<std::byte>> m_free_buffers;
+
+        /** Stats */
+        Stats m_stats = {};
+
+        /**
+         * Get map key of an address
+         */
+        static std::uint64_t key(const sockpp::inet_address &address) noexcept;
+
+        /**
+         * Queue a datagram for the transport at an address
+         */
+        void send(const sockpp::inet_address &sender, const void *data, std::size_t size, const sockpp::inet_address &address) noexcept;
+
+        /**
+         * Take the next datagram that arrived at a transport
+         */
+        ssize_t receive(inbox_t &inbox, void *buffer, std::size_t capacity, sockpp::inet_address *sender) noexcept;
+    };
+
+    /**
+     * Endpoint of a loopback network
+     */
+    class LoopbackTransport : public Transport {
+        friend LoopbackNetwork;
+    public:
+        ssize_t send_to(const void *data, std::size_t size, const sockpp::inet_address &address) noexcept override;
+        ssize_t receive_from(void *buffer, std::size_t capacity, sockpp::inet_address *sender) noexcept override;
+        sockpp::inet_address address() const noexcept override;
+
+        /**
+         * Constructor for loopback transport
+         * @param network   Network to attach to; it must outlive the transport
+         * @param address   Address of the transport in the network
+         * @throws std::runtime_error if the address is taken
+         */
+        LoopbackTransport(LoopbackNetwork &network, sockpp::inet_address address);
+
+        /**
+         * Deleted copy constructor
+         */
+        LoopbackTransport(const LoopbackTransport &) = delete;
+
+        /**
+         * Detach from network, dropping datagrams not received yet
+         */
+        ~LoopbackTransport() noexcept;
+
+    private:
+        /** Network */
+        LoopbackNetwork &m_network;
+
+        /** Address */
+        sockpp::inet_address m_address;
+
+        /** Datagrams on their way to this transport */
+        LoopbackNetwork::inbox_t m_inbox;
+    };
+}
+
+#endif
@@ -0,0 +1,85 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BLAMITE__ENGINE__NETWORK__METRICS_SERVER_HPP
+#define BLAMITE__ENGINE__NETWORK__METRICS_SERVER_HPP
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <sockpp/tcp_acceptor.h>
+#include <blamite/core/metrics.hpp>
+
+namespace Blamite::Engine::Network {
+    /**
+     * HTTP endpoint serving metrics in the Prometheus text format at /metrics.
+     * Requests are answered one at a time on a background thread, which renders the metrics from their atomics,
+     * so a scrape never waits for or stalls the tick thread.
+     */
+    class MetricsServer {
+    public:
+        /**
+         * Get the listening address
+         */
+        std::string listening_address() const noexcept;
+
+        /**
+         * Get number of scrapes served
+         */
+        std::size_t scrapes() const noexcept;
+
+        /**
+         * Constructor for metrics server
+         * @param metrics   Metrics to serve
+         * @param port      TCP port to listen on, on localhost
+         * @throws std::runtime_error if the port cannot be opened
+         */
+        MetricsServer(const Metrics &metrics, in_port_t port);
+
+        /**
+         * Deleted copy constructor
+         */
+        MetricsServer(const MetricsServer &) = delete;
+
+        /**
+         * Stop serving thread
+         */
+        ~MetricsServer() noexcept;
+
+    private:
+        /** Maximum request size */
+        static constexpr std::size_t c_max_request_size = 8192;
+
+        /** Time given to a client to send its request or read the response, in milliseconds */
+        static constexpr int c_request_timeout = 1000;
+
+        /** Serving thread wake up interval in milliseconds, to notice it must exit */
+        static constexpr int c_poll_interval = 100;
+
+        /** Metrics */
+        const Metrics &m_metrics;
+
+        /** Listening socket */
+        sockpp::tcp_acceptor m_acceptor;
+
+        /** Scrapes served */
+        std::atomic<std::size_t> m_scrapes{0};
+
+        /** Serving thread must exit */
+        std::atomic<bool> m_stopping{false};
+
+        /** Serving thread */
+        std::thread m_thread;
+
+        /**
+         * Serving thread body
+         */
+        void run() noexcept;
+
+        /**
+         * Read a request and answer it
+         */
+        void serve(sockpp::tcp_socket &socket) noexcept;
+    };
+}
+
+#endif
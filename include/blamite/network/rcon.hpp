@@ -0,0 +1,152 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BLAMITE__ENGINE__NETWORK__RCON_HPP
+#define BLAMITE__ENGINE__NETWORK__RCON_HPP
+
+#include <deque>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sockpp/tcp_acceptor.h>
+#include <blamite/console/console.hpp>
+
+namespace Blamite::Engine::Network {
+    /**
+     * Remote console over TCP.
+     * A session sends its password as first line and then one command per line. Commands go through the console
+     * registry: tick thread commands are picked up on the next tick and background commands go to the workers.
+     * Output of each command is sent back as one frame, a "#<sequence> <size>" header line followed by size bytes
+     * of text. Sockets are served by a reactor thread, so the tick thread never touches them.
+     */
+    class RconServer {
+    public:
+        /**
+         * Get the listening address
+         */
+        std::string listening_address() const noexcept;
+
+        /**
+         * Get number of open sessions
+         */
+        std::size_t sessions() const noexcept;
+
+        /**
+         * Constructor for RCON server
+         * @param console   Console commands are run on
+         * @param port      TCP port to listen on
+         * @param password  Session password
+         * @throws std::runtime_error if the port cannot be opened
+         */
+        RconServer(Console &console, in_port_t port, std::string password);
+
+        /**
+         * Close sessions and stop reactor thread
+         */
+        ~RconServer() noexcept;
+
+    private:
+        struct Session {
+            /** Session socket */
+            sockpp::tcp_socket socket;
+
+            /** Peer address */
+            std::string address;
+
+            /** Received bytes not yet split into lines */
+            std::string input;
+
+            /** Bytes waiting to be sent */
+            std::string output;
+
+            /** Text of the oldest pending command collected so far */
+            std::string frame;
+
+            /** Outputs of sent commands, in order */
+            std::deque<std::shared_ptr<CommandOutput>> pending;
+
+            /** Next frame sequence number */
+            std::uint32_t sequence = 0;
+
+            /** Password was accepted */
+            bool authenticated = false;
+
+            /** Close once output is sent */
+            bool closing = false;
+        };
+
+        /** Maximum open sessions */
+        static constexpr std::size_t c_max_sessions = 8;
+
+        /** Maximum command line length */
+        static constexpr std::size_t c_max_line_length = 1024;
+
+        /** Maximum commands waiting for output per session */
+        static constexpr std::size_t c_max_pending_commands = 16;
+
+        /** Maximum unsent bytes per session before it is dropped */
+        static constexpr std::size_t c_max_output_size = 1024 * 1024;
+
+        /** Reactor wake up interval in milliseconds, to pick up command outputs */
+        static constexpr int c_poll_interval = 10;
+
+        /** Console */
+        Console &m_console;
+
+        /** Listening socket */
+        sockpp::tcp_acceptor m_acceptor;
+
+        /** Session password */
+        std::string m_password;
+
+        /** Open sessions */
+        std::vector<std::unique_ptr<Session>> m_sessions;
+
+        /** Number of open sessions, readable from other threads */
+        std::atomic<std::size_t> m_sessions_count{0};
+
+        /** Reactor must exit */
+        std::atomic<bool> m_stopping{false};
+
+        /** Reactor thread */
+        std::thread m_thread;
+
+        /**
+         * Reactor thread body
+         */
+        void run() noexcept;
+
+        /**
+         * Accept pending connections
+         */
+        void accept_sessions() noexcept;
+
+        /**
+         * Read from a session and handle complete lines
+         */
+        void read_session(Session &session) noexcept;
+
+        /**
+         * Handle a line from a session
+         */
+        void process_line(Session &session, std::string_view line) noexcept;
+
+        /**
+         * Move finished command outputs to session output
+         */
+        void collect_output(Session &session) noexcept;
+
+        /**
+         * Send as much session output as possible
+         */
+        void flush_session(Session &session) noexcept;
+
+        /**
+         * Append a frame to session output
+         */
+        static void append_frame(Session &session, std::string_view text) noexcept;
+    };
+}
+
+#endif
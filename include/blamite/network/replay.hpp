@@ -0,0 +1,264 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BLAMITE__ENGINE__NETWORK__REPLAY_HPP
+#define BLAMITE__ENGINE__NETWORK__REPLAY_HPP
+
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <blamite/memory/struct.hpp>
+#include "transport.hpp"
+
+namespace Blamite::Engine::Network {
+    /**
+     * Traffic recording file header
+     */
+    struct PACKED TrafficFileHeader {
+        /** File magic */
+        char magic[8];
+
+        /** Format version */
+        std::uint16_t version;
+
+        /** Tick rate of the recording server when recording started */
+        std::uint16_t tick_rate;
+
+        /** Seed of the recording server random generator */
+        std::uint32_t seed;
+
+        static constexpr char MAGIC[8] = {'B', 'L', 'M', 'T', 'R', 'A', 'F', 'F'};
+        static constexpr std::uint16_t VERSION = 2;
+    };
+
+    /**
+     * Header of each record, followed by its data
+     */
+    struct PACKED TrafficRecordHeader {
+        /** Record type */
+        std::uint8_t type;
+
+        /** Server tick the datagram was read on, or the tick rate change took effect on */
+        std::uint32_t tick;
+
+        /** Microseconds into the tick the datagram was read at */
+        std::uint32_t offset;
+
+        /** Sender address and port, in host order */
+        std::uint32_t address;
+        std::uint16_t port;
+
+        /** Data size */
+        std::uint16_t size;
+
+        /** Inbound datagram */
+        static constexpr std::uint8_t TYPE_DATAGRAM = 0;
+
+        /** Tick rate change; the data is the new tick rate */
+        static constexpr std::uint8_t TYPE_TICK_RATE = 1;
+    };
+
+    /**
+     * Writes inbound datagrams to a traffic recording.
+     * Records go through a large stdio buffer, so recording a datagram is mostly a copy.
+     */
+    class TrafficRecorder {
+    public:
+        /**
+         * Record a datagram
+         */
+        void record(std::uint32_t tick, std::uint32_t offset, const sockpp::inet_address &sender, const void *data, std::size_t size) noexcept;
+
+        /**
+         * Record a tick rate change
+         * @param tick          First tick running at the new rate
+         * @param tick_rate     New tick rate
+         */
+        void record_tick_rate(std::uint32_t tick, std::uint16_t tick_rate) noexcept;
+
+        /**
+         * Get number of datagrams recorded
+         */
+        std::size_t recorded() const noexcept;
+
+        /**
+         * Get recording path
+         */
+        const std::string &path() const noexcept;
+
+        /**
+         * Constructor for traffic recorder
+         * @param path      Recording file path; an existing file is replaced
+         * @param seed      Seed the server uses for its random generator from now on
+         * @param tick_rate Tick rate of the server
+         * @throws std::runtime_error if the file cannot be created
+         */
+        TrafficRecorder(std::string path, std::uint32_t seed, std::uint16_t tick_rate);
+
+        /**
+         * Deleted copy constructor
+         */
+        TrafficRecorder(const TrafficRecorder &) = delete;
+
+        /**
+         * Flush and close recording
+         */
+        ~TrafficRecorder() noexcept;
+
+    private:
+        /** File path */
+        std::string m_path;
+
+        /** Recording file */
+        std::FILE *m_file;
+
+        /** File buffer */
+        std::unique_ptr<char[]> m_buffer;
+
+        /** Datagrams recorded */
+        std::size_t m_recorded = 0;
+    };
+
+    /**
+     * Read-only view of a traffic recording, memory-mapped
+     */
+    class TrafficReplay {
+    public:
+        struct Datagram {
+            /** Record header */
+            TrafficRecordHeader header;
+
+            /** Datagram data, inside the mapping */
+            const std::byte *data;
+        };
+
+        /**
+         * Read next datagram
+         * @return      False at the end of the recording or at a truncated record
+         */
+        bool next(Datagram &datagram) noexcept;
+
+        /**
+         * Get file header
+         */
+        const TrafficFileHeader &header() const noexcept;
+
+        /**
+         * Constructor for traffic replay
+         * @param path      Recording file path
+         * @throws std::runtime_error if the file cannot be mapped or is not a recording
+         */
+        TrafficReplay(const std::string &path);
+
+        /**
+         * Deleted copy constructor
+         */
+        TrafficReplay(const TrafficReplay &) = delete;
+
+        /**
+         * Unmap recording
+         */
+        ~TrafficReplay() noexcept;
+
+    private:
+        /** Mapped file */
+        const std::byte *m_data = nullptr;
+
+        /** Mapped size */
+        std::size_t m_size = 0;
+
+        /** Read position */
+        std::size_t m_position = sizeof(TrafficFileHeader);
+
+        /** File header */
+        TrafficFileHeader m_header;
+
+        #ifdef _WIN32
+        /** File contents where mapping is not available */
+        std::vector<std::byte> m_contents;
+        #endif
+
+        /**
+         * Release mapping
+         */
+        void unmap() noexcept;
+    };
+
+    /**
+     * Transport feeding a traffic recording to the server one tick at a time.
+     * Datagrams recorded on a tick are received on the matching replay tick, in recording order, and everything the
+     * server sends is counted and dropped. The server must tick at tick_rate() for the replay to match the recording.
+     */
+    class ReplayTransport : public Transport {
+    public:
+        ssize_t send_to(const void *data, std::size_t size, const sockpp::inet_address &address) noexcept override;
+        ssize_t receive_from(void *buffer, std::size_t capacity, sockpp::inet_address *sender) noexcept override;
+        sockpp::inet_address address() const noexcept override;
+
+        /**
+         * Move to the next recorded tick; call before each server tick
+         */
+        void advance() noexcept;
+
+        /**
+         * Get tick rate the recording server ran the current tick at
+         */
+        std::uint16_t tick_rate() const noexcept;
+
+        /**
+         * Check if every datagram was received
+         */
+        bool finished() const noexcept;
+
+        /**
+         * Get number of datagrams received by the server
+         */
+        std::size_t received() const noexcept;
+
+        /**
+         * Get number of datagrams sent by the server
+         */
+        std::size_t sent() const noexcept;
+
+        /**
+         * Get recording
+         */
+        const TrafficReplay &replay() const noexcept;
+
+        /**
+         * Constructor for replay transport
+         * @param replay    Recording to feed
+         * @param address   Address the server claims to be on
+         */
+        ReplayTransport(std::unique_ptr<TrafficReplay> replay, sockpp::inet_address address) noexcept;
+
+    private:
+        /** Recording */
+        std::unique_ptr<TrafficReplay> m_replay;
+
+        /** Server address */
+        sockpp::inet_address m_address;
+
+        /** Next datagram, if any */
+        TrafficReplay::Datagram m_next;
+        bool m_has_next;
+
+        /** Recording tick being replayed */
+        std::uint64_t m_tick = 0;
+
+        /** Tick rate of the current tick */
+        std::uint16_t m_tick_rate;
+
+        /** No tick started yet */
+        bool m_started = false;
+
+        /** Datagrams received */
+        std::size_t m_received = 0;
+
+        /** Datagrams sent */
+        std::size_t m_sent = 0;
+    };
+}
+
+#endif
@@ -0,0 +1,155 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BLAMITE__ENGINE__NETWORK__SCHEDULER_HPP
+#define BLAMITE__ENGINE__NETWORK__SCHEDULER_HPP
+
+#include <vector>
+#include <cstdint>
+#include <unordered_map>
+#include <blamite/core/tick.hpp>
+#include "packet.hpp"
+
+namespace Blamite::Engine::Network {
+    /**
+     * Per-client outbound scheduler.
+     * Every tick the client earns a slice of its bandwidth budget, every pending object update adds
+     * its priority to an accumulator, and the updates with the highest accumulated priority are packed
+     * until the budget or the packet size runs out. Updates left behind keep their accumulated priority,
+     * so low priority objects still get through eventually.
+     */
+    class OutboundScheduler {
+    public:
+        using object_id_t = std::uint32_t;
+
+        /** Largest update payload the header can describe */
+        static constexpr std::size_t MAX_PAYLOAD_SIZE = UINT16_MAX;
+
+        struct PACKED UpdateHeader {
+            /** Replicated object */
+            object_id_t object;
+
+            /** Update payload size */
+            std::uint16_t size;
+        };
+
+        struct Stats {
+            /** Budget available on last tick in bytes */
+            std::size_t budget = 0;
+
+            /** Bytes sent on last tick */
+            std::size_t sent = 0;
+
+            /** Updates packed on last build */
+            std::size_t sent_updates = 0;
+
+            /** Updates deferred on last build */
+            std::size_t deferred_updates = 0;
+
+            /** Updates dropped because they could not fit a packet at the path MTU */
+            std::size_t dropped_updates = 0;
+
+            /** Total bytes sent */
+            std::size_t total_sent = 0;
+
+            /**
+             * Get budget utilisation of last tick, from 0 to 1
+             */
+            float utilisation() const noexcept {
+                return budget > 0 ? static_cast<float>(sent) / budget : 0.0f;
+            }
+        };
+
+        /**
+         * Set bandwidth budget
+         */
+        void set_bandwidth(std::size_t bytes_per_second) noexcept;
+
+        /**
+         * Get bandwidth budget in bytes per second
+         */
+        std::size_t bandwidth() const noexcept;
+
+        /**
+         * Set number of ticks per second the budget is split into
+         */
+        void set_tick_rate(std::uint16_t ticks_per_second) noexcept;
+
+        /**
+         * Queue an object update, replacing any pending update of the same object
+         * @param object    Replicated object
+         * @param priority  Priority added to the object accumulator every tick the update waits
+         * @param data      Update payload
+         * @param size      Update payload size
+         * @return          False if the payload is larger than MAX_PAYLOAD_SIZE and was not queued
+         */
+        bool queue_update(object_id_t object, float priority, const std::byte *data, std::size_t size) noexcept;
+
+        /**
+         * Forget an object, dropping its pending update
+         */
+        void remove_object(object_id_t object) noexcept;
+
+        /**
+         * Charge bytes sent to the client against the budget
+         */
+        void consume(std::size_t bytes) noexcept;
+
+        /**
+         * Start a new tick and pack pending updates
+         * Updates that would not fit even an otherwise empty packet are dropped, so they do not wait forever.
+         * @param packet    Output packet holding its header; packed updates are appended to it
+         * @param mtu       Maximum packet size
+         * @return          Number of updates packed
+         */
+        std::size_t build(raw_packet_t &packet, std::size_t mtu) noexcept;
+
+        /**
+         * Get scheduler stats
+         */
+        const Stats &stats() const noexcept;
+
+    private:
+        struct Entry {
+            /** Object identifier */
+            object_id_t object;
+
+            /** Priority earned every tick */
+            float priority;
+
+            /** Accumulated priority */
+            float accumulator;
+
+            /** Update is waiting to be sent */
+            bool pending;
+
+            /** Update payload */
+            std::vector<std::byte> payload;
+        };
+
+        /** Bandwidth budget in bytes per second */
+        std::size_t m_bandwidth = 16 * 1024;
+
+        /** Ticks per second */
+        std::uint16_t m_tick_rate = DEFAULT_TICK_RATE;
+
+        /** Bytes that can be sent; goes negative when packets outside the scheduler overdraw it */
+        std::int64_t m_credit = 0;
+
+        /** Budget available on current tick */
+        std::size_t m_tick_budget = 0;
+
+        /** Bytes sent on current tick */
+        std::size_t m_consumed = 0;
+
+        /** Replicated objects */
+        std::unordered_map<object_id_t, Entry> m_entries;
+
+        /** Pending entries sorted by accumulated priority; reused between ticks */
+        std::vector<Entry *> m_candidates;
+
+        /** Stats */
+        Stats m_stats;
+    };
+}
+
+#endif
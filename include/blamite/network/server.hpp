@@ -4,17 +4,65 @@
 #define BLAMITE__ENGINE__NETWORK__SERVER_HPP
 
 #include <vector>
-#include <queue>
 #include <memory>
 #include <chrono>
+#include <random>
 #include <utility>
-#include <sockpp/udp_socket.h>
+#include <memory_resource>
+#include <blamite/core/event_log.hpp>
+#include <blamite/core/job_system.hpp>
+#include <blamite/core/metrics.hpp>
+#include <blamite/core/timer_wheel.hpp>
+#include <blamite/memory/buffer_pool.hpp>
+#include <unordered_map>
+#include "capture.hpp"
+#include "fragment.hpp"
+#include "interest.hpp"
 #include "packet.hpp"
+#include "replay.hpp"
+#include "scheduler.hpp"
+#include "transport.hpp"
+
+namespace Blamite::Engine {
+    class Engine;
+}
 
 namespace Blamite::Engine::Network {
     class Server {
     public:
-        using udp_socket = sockpp::udp_socket;
+        /** Largest datagram that can be received; shared datagram pools need buffers this big */
+        static constexpr std::size_t MAX_DATAGRAM_SIZE = 1024 * 4;
+
+        /** Smallest path MTU; packets must fit their headers and at least a byte of payload */
+        static constexpr std::size_t MIN_PATH_MTU = sizeof(Packet) + sizeof(FragmentHeader) + 1;
+
+        using object_id_t = OutboundScheduler::object_id_t;
+
+        struct ClientInfo {
+            /** Client identifier */
+            std::uint32_t id;
+
+            /** Client address */
+            std::string address;
+
+            /** Bandwidth budget in bytes per second */
+            std::size_t bandwidth;
+
+            /** Outbound scheduler stats */
+            OutboundScheduler::Stats stats;
+
+            /** Messages received */
+            std::size_t received_messages;
+
+            /** Fragments waiting for reassembly */
+            std::size_t held_fragments;
+
+            /** Incomplete messages dropped */
+            std::size_t dropped_messages;
+
+            /** Objects relevant to the client */
+            std::size_t relevant_objects;
+        };
 
         /**
          * Get the listening address
@@ -31,10 +79,180 @@ namespace Blamite::Engine::Network {
          */
         void process_received_data() noexcept;
 
+        /**
+         * Advance client timers and fire the ones that are due
+         * @param steps     Timer ticks elapsed since the last call
+         */
+        void process_timers(std::size_t steps = 1) noexcept;
+
+        /**
+         * Set number of ticks per second client bandwidth budgets are split into
+         */
+        void set_tick_rate(std::uint16_t ticks_per_second) noexcept;
+
+        /**
+         * Queue a replicated object update for a client
+         * @param address   Client address
+         * @param object    Replicated object
+         * @param priority  Update priority
+         * @param data      Update payload
+         * @param size      Update payload size
+         * @return          True if update was queued, false if client doesn't exists or the update cannot fit a packet.
+         */
+        bool queue_update(sockpp::inet_address address, object_id_t object, float priority, const std::byte *data, std::size_t size) noexcept;
+
+        /**
+         * Add or update a replicated object
+         * The object state is queued for every client the object is relevant to.
+         * @param object    Replicated object
+         * @param position  Object position
+         * @param priority  Update priority for nearby clients
+         * @param state     Object state
+         * @param size      Object state size
+         */
+        void update_object(object_id_t object, const Vector3D &position, float priority, const std::byte *state, std::size_t size) noexcept;
+
+        /**
+         * Remove a replicated object
+         */
+        void remove_object(object_id_t object) noexcept;
+
+        /**
+         * Set client view used to find relevant objects
+         * @param client_id     Client identifier
+         * @param position      View position
+         * @param radius        View radius
+         * @return              True if view was set, false if client doesn't exists or the view is invalid.
+         */
+        bool set_client_view(std::uint32_t client_id, const Vector3D &position, float radius) noexcept;
+
+        /**
+         * Send a message to a client, fragmenting it at the path MTU
+         * @param address   Client address
+         * @param data      Message data
+         * @param size      Message size
+         * @return          True if message was sent, false if client doesn't exists or message is too big.
+         */
+        bool send_message(sockpp::inet_address address, const std::byte *data, std::size_t size) noexcept;
+
+        /**
+         * Set path MTU used for outbound packets
+         * @param mtu       Path MTU; clamped between MIN_PATH_MTU and MAX_DATAGRAM_SIZE
+         */
+        void set_path_mtu(std::size_t mtu) noexcept;
+
+        /**
+         * Get path MTU used for outbound packets
+         */
+        std::size_t path_mtu() const noexcept;
+
+        /**
+         * Pack and send scheduled updates within each client budget
+         * @param jobs      Job system to pack packets of different clients in parallel, or null
+         */
+        void send_scheduled_updates(JobSystem *jobs = nullptr) noexcept;
+
+        /**
+         * Set bandwidth budget of each client
+         */
+        void set_client_bandwidth(std::size_t bytes_per_second) noexcept;
+
+        /**
+         * Get bandwidth budget of each client in bytes per second
+         */
+        std::size_t client_bandwidth() const noexcept;
+
+        /**
+         * Get connected clients info
+         */
+        std::vector<ClientInfo> clients_info() const noexcept;
+
+        /**
+         * Start recording datagrams into a capture ring, replacing any previous one
+         * @param slots     Datagrams kept
+         * @throws std::runtime_error if the ring cannot be made
+         */
+        void start_capture(std::size_t slots);
+
+        /**
+         * Stop recording datagrams and drop the capture ring
+         */
+        void stop_capture() noexcept;
+
+        /**
+         * Get capture ring
+         * @return      Capture ring, or nullptr if not capturing
+         */
+        PacketCapture *capture() noexcept;
+
+        struct CaptureDump {
+            /** Datagrams written */
+            std::size_t datagrams;
+
+            /** Datagrams written with their payload decrypted */
+            std::size_t decrypted;
+        };
+
+        /**
+         * Write captured datagrams to a pcap file
+         * @param path      File path
+         * @param decrypt   Replace encrypted payloads from connected clients with their plain text
+         * @param dump      What was written
+         * @return          False if not capturing or the file cannot be written
+         */
+        bool dump_capture(const std::string &path, bool decrypt, CaptureDump &dump) noexcept;
+
+        /**
+         * Start recording inbound datagrams for replay, replacing any previous recording
+         * The random generator is reseeded with a seed stored in the recording, so a replay makes the same keys.
+         * Datagrams are recorded with the engine tick they were read on, and the recording with the current tick
+         * rate.
+         * @param path      Recording file path
+         * @throws std::runtime_error if the file cannot be created
+         */
+        void start_recording(std::string path);
+
+        /**
+         * Stop recording inbound datagrams
+         */
+        void stop_recording() noexcept;
+
+        /**
+         * Get traffic recorder
+         * @return      Recorder, or nullptr if not recording
+         */
+        TrafficRecorder *recorder() noexcept;
+
+        /**
+         * Seed random generator used for client keys
+         */
+        void set_random_seed(std::uint32_t seed) noexcept;
+
+        /**
+         * Get number of connected clients
+         */
+        std::size_t clients_count() const noexcept;
+
+        /**
+         * Get number of datagrams read on the last tick
+         */
+        std::size_t received_count() const noexcept;
+
         /**
          * Constructor for server
+         * @param engine            Engine the server belongs to
+         * @param port              UDP port
+         * @param datagram_pool     Pool to take received datagrams from; the server makes its own if null
+         */
+        Server(Engine &engine, in_port_t port, BufferPool *datagram_pool = nullptr);
+
+        /**
+         * Constructor for server over a given transport
+         * @param engine            Engine the server belongs to
+         * @param transport         Transport to send and receive through
+         * @param datagram_pool     Pool to take received datagrams from; the server makes its own if null
          */
-        Server(in_port_t port);
+        Server(Engine &engine, std::unique_ptr<Transport> transport, BufferPool *datagram_pool = nullptr) noexcept;
 
         /**
          * Deleted copy constructor
@@ -55,14 +273,130 @@ namespace Blamite::Engine::Network {
         /** Maximum number of clients */
         const std::size_t c_max_client_number = 16;
 
-        /** Socket inself */
-    	udp_socket m_socket;
+        /** Datagrams read per tick at most; the rest stay in the socket buffer, so a flood cannot grow the pool */
+        const std::size_t c_max_datagrams_per_tick = 4096;
 
-        /** Received packets raw data to be processed */
-        std::queue<std::pair<sockpp::inet_address, raw_packet_t>> m_received_raw_data;
+        /** Time without receiving data before a client is dropped */
+        const timer_tick_t c_client_timeout = std::chrono::duration_cast<timer_tick_t>(std::chrono::seconds(30));
+
+        /** Time without sending data before a keepalive is sent */
+        const timer_tick_t c_keepalive_interval = std::chrono::duration_cast<timer_tick_t>(std::chrono::seconds(1));
+
+        /** Time before resending an unacknowledged handshake */
+        const timer_tick_t c_retransmit_interval = std::chrono::duration_cast<timer_tick_t>(std::chrono::milliseconds(500));
+
+        /** Maximum handshake retransmissions before dropping the client */
+        const std::size_t c_max_retransmits = 5;
+
+        /** Time given to a fragmented message to complete */
+        const timer_tick_t c_fragment_timeout = std::chrono::duration_cast<timer_tick_t>(std::chrono::seconds(5));
+
+        /** Maximum size of outbound packets */
+        std::size_t m_path_mtu = 1400;
+
+        /** Bandwidth budget of each client in bytes per second */
+        std::size_t m_client_bandwidth = 16 * 1024;
+
+        /** Ticks per second */
+        std::uint16_t m_tick_rate = DEFAULT_TICK_RATE;
+
+        struct ReceivedDatagram {
+            /** Sender address */
+            sockpp::inet_address address;
+
+            /** Datagram data */
+            BufferPool::Buffer buffer;
+
+            /** Datagram size */
+            std::size_t size;
+        };
+
+        struct ServerMetrics {
+            /** Datagrams received and sent by packet type; the last one counts unknown types */
+            std::vector<Counter *> packets_received;
+            std::vector<Counter *> packets_sent;
+
+            /** Bytes received and sent */
+            Counter *bytes_received;
+            Counter *bytes_sent;
+
+            /** Handshake challenges answered */
+            Counter *challenges;
+
+            /** Handshakes accepted */
+            Counter *handshakes;
+
+            /** Refused connections by reason, from REASON_INCOMPATIBLE_NETWORK_PROTOCOL_VERSION on */
+            std::vector<Counter *> refusals;
+
+            /** Time spent resolving handshake challenges */
+            Histogram *challenge_time;
+
+            /** Time spent generating client keys */
+            Histogram *key_time;
+
+            /** Datagrams read on the last tick, waiting to be processed */
+            Gauge *received_queue;
+
+            /** Object updates deferred by client schedulers on the last tick */
+            Gauge *deferred_updates;
+        };
+
+        /** Engine the server belongs to */
+        Engine &m_engine;
+
+        /** Server metrics, owned by the engine */
+        ServerMetrics m_metrics;
+
+        /** Transport datagrams go through */
+        std::unique_ptr<Transport> m_transport;
+
+        /** Capture ring, or null when not capturing */
+        std::unique_ptr<PacketCapture> m_capture;
+
+        /** Inbound traffic recorder, or null when not recording */
+        std::unique_ptr<TrafficRecorder> m_recorder;
+
+        /** Client keys generator */
+        std::mt19937 m_random{std::random_device{}()};
+
+        /** Client timers */
+        TimerWheel m_timers;
+
+        /** Received datagrams buffers, unless a shared pool is used */
+        std::unique_ptr<BufferPool> m_own_datagram_pool;
+
+        /** Pool received datagrams are taken from */
+        BufferPool *m_datagram_pool;
+
+        /** Received datagrams to be processed */
+        std::vector<ReceivedDatagram> m_received_datagrams;
+
+        /** Datagrams read on the last tick */
+        std::size_t m_received_count = 0;
 
         /** Clients */
-        std::vector<Client> m_clients;
+        std::vector<std::unique_ptr<Client>> m_clients;
+
+        /** Next client identifier */
+        std::uint32_t m_next_client_id = 0;
+
+        struct ReplicatedObject {
+            /** Update priority */
+            float priority;
+
+            /** Latest state */
+            std::vector<std::byte> state;
+        };
+
+        /** Replicated objects */
+        std::unordered_map<object_id_t, ReplicatedObject> m_objects;
+
+        /** Replicated objects relevance */
+        InterestManager m_interest;
+
+        /** Tasks packing outbound packets */
+        TaskGraph m_send_graph;
 
         /** Packet handler */
         // PacketHandler packet_handler;
@@ -73,22 +407,91 @@ namespace Blamite::Engine::Network {
          */
         Client *get_client(sockpp::inet_address address) noexcept;
 
+        /**
+         * Get client from identifier
+         * @return      Return client if exists
+         */
+        Client *get_client(std::uint32_t id) noexcept;
+
         /**
          * Send packet to client
          * @return      True if packet is sent, false if client doesn't exists.
          */
         bool send_packet(sockpp::inet_address address, raw_packet_t packet_data) noexcept;
 
+        /**
+         * Send packet to client and charge it to the client budget
+         */
+        void send_packet(Client &client, const raw_packet_t &packet_data) noexcept;
+
+        /**
+         * Send packet to client from raw memory and charge it to the client budget
+         */
+        void send_packet(Client &client, const std::byte *data, std::size_t size) noexcept;
+
+        /**
+         * Send a message to client, fragmenting it at the path MTU
+         */
+        bool send_message(Client &client, const std::byte *data, std::size_t size) noexcept;
+
+        /**
+         * Queue relevant object changes into client schedulers
+         */
+        void replicate_objects() noexcept;
+
+        /**
+         * Queue an object state for a client
+         */
+        void queue_object(Client &client, object_id_t object) noexcept;
+
+        /**
+         * Process a reassembled message from client
+         */
+        void process_message(Client &client, const Reassembler::Message &message) noexcept;
+
+        /**
+         * Register server metrics with the engine
+         */
+        void register_metrics() noexcept;
+
         /**
          * Resolve handshake challenge
+         * @return      Response, allocated on the engine frame arena
          */
-        std::vector<std::byte> resolve_handshake_challenge(std::byte *challenge) noexcept;
+        std::pmr::vector<std::byte> resolve_handshake_challenge(std::byte *challenge) noexcept;
+
+        /**
+         * Send a datagram through the transport, recording it if capturing
+         */
+        void transmit(const void *data, std::size_t size, const sockpp::inet_address &address) noexcept;
 
         /**
          * Refuse connection when handshake fails
          */
         void refuse_connection(sockpp::inet_address address, ConnectionRefusePacket::Reason reason) noexcept;
 
+        /**
+         * Send handshake response to client and wait for it to be acknowledged
+         */
+        void send_handshake(Client &client) noexcept;
+
+        /**
+         * Send keepalive to an idle client
+         */
+        void send_keepalive(Client &client) noexcept;
+
+        /**
+         * Restart client timeout after receiving data from it
+         */
+        void touch_client(Client &client) noexcept;
+
+        /**
+         * Remove client and cancel its timers
+         * @param client    Client to remove
+         * @param reason    Why the client is removed; recorded in the event log
+         */
+        void drop_client(Client &client, DisconnectReason reason) noexcept;
+
         /**
          * Disconnect clients
          */
@@ -101,9 +504,12 @@ namespace Blamite::Engine::Network {
         /**
          * Constructor for server client
          */
-        Client(sockpp::inet_address address, std::uint8_t *client_public_key) noexcept;
+        Client(sockpp::inet_address address, std::uint8_t *client_public_key, std::uint32_t key_seed, TimerWheel &timers, timer_tick_t fragment_timeout) noexcept;
 
     private:
+        /** Client identifier */
+        std::uint32_t m_id;
+
         /** Client address */
         sockpp::inet_address m_address;
 
@@ -127,6 +533,33 @@ namespace Blamite::Engine::Network {
 
         /** Decryption key */
         std::uint8_t m_dec_key[16];
+
+        /** Timer for dropping the client when it stops sending data */
+        TimerWheel::Handle m_timeout_timer;
+
+        /** Timer for sending keepalives when nothing else is sent */
+        TimerWheel::Handle m_keepalive_timer;
+
+        /** Timer for resending the handshake until the client answers */
+        TimerWheel::Handle m_retransmit_timer;
+
+        /** Handshake retransmissions so far */
+        std::size_t m_retransmit_count = 0;
+
+        /** Outbound scheduler */
+        OutboundScheduler m_scheduler;
+
+        /** Packet packed for this tick, kept to reuse its memory */
+        raw_packet_t m_outbound_packet;
+
+        /** Inbound message reassembler */
+        Reassembler m_reassembler;
+
+        /** Next outbound message identifier */
+        std::uint16_t m_next_message_id = 0;
+
+        /** Messages received */
+        std::size_t m_received_messages = 0;
     };
 }
 
@@ -0,0 +1,67 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BLAMITE__ENGINE__NETWORK__TRANSPORT_HPP
+#define BLAMITE__ENGINE__NETWORK__TRANSPORT_HPP
+
+#include <cstddef>
+#include <sys/types.h>
+#include <sockpp/udp_socket.h>
+
+namespace Blamite::Engine::Network {
+    /**
+     * Datagram transport the server sends and receives through.
+     * Receiving never blocks; when nothing is waiting it returns zero or less.
+     */
+    class Transport {
+    public:
+        /**
+         * Send a datagram
+         * @return      Bytes sent, or a negative value on error
+         */
+        virtual ssize_t send_to(const void *data, std::size_t size, const sockpp::inet_address &address) noexcept = 0;
+
+        /**
+         * Take the next received datagram
+         * @param buffer    Buffer to copy the datagram into; longer datagrams are truncated
+         * @param capacity  Buffer size
+         * @param sender    Sender address output
+         * @return          Datagram size, or zero or less if nothing is waiting
+         */
+        virtual ssize_t receive_from(void *buffer, std::size_t capacity, sockpp::inet_address *sender) noexcept = 0;
+
+        /**
+         * Get local address
+         */
+        virtual sockpp::inet_address address() const noexcept = 0;
+
+        virtual ~Transport() noexcept = default;
+    };
+
+    /**
+     * Transport over a non-blocking UDP socket
+     */
+    class UdpTransport : public Transport {
+    public:
+        ssize_t send_to(const void *data, std::size_t size, const sockpp::inet_address &address) noexcept override;
+        ssize_t receive_from(void *buffer, std::size_t capacity, sockpp::inet_address *sender) noexcept override;
+        sockpp::inet_address address() const noexcept override;
+
+        /**
+         * Constructor for UDP transport
+         * @param port      UDP port to bind on localhost; zero picks a free one
+         * @throws std::runtime_error if the socket cannot be created or bound
+         */
+        UdpTransport(in_port_t port);
+
+        /**
+         * Close socket
+         */
+        ~UdpTransport() noexcept;
+
+    private:
+        /** Socket inself */
+        sockpp::udp_socket m_socket;
+    };
+}
+
+#endif
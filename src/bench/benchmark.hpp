@@ -0,0 +1,56 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BLAMITE__BENCH__BENCHMARK_HPP
+#define BLAMITE__BENCH__BENCHMARK_HPP
+
+#include <chrono>
+#include <cstdio>
+
+namespace Blamite::Bench {
+    /**
+     * Measure average time of a function in microseconds
+     * @param iterations    Number of runs
+     * @param function      Function to be measured
+     */
+    template<typename T> double measure(std::size_t iterations, T &&function) noexcept {
+        using steady_clock = std::chrono::steady_clock;
+        auto start = steady_clock::now();
+        for(std::size_t i = 0; i < iterations; i++) {
+            function();
+        }
+        std::chrono::duration<double, std::micro> elapsed = steady_clock::now() - start;
+        return elapsed.count() / iterations;
+    }
+
+    /**
+     * Entity store tick against a vector of objects
+     */
+    void entities_benchmark() noexcept;
+
+    /**
+     * Interest management grid against a full relevance rebuild
+     */
+    void interest_benchmark() noexcept;
+
+    /**
+     * Entity simulation tick spread over 1 to N cores by the job system
+     */
+    void jobs_benchmark() noexcept;
+
+    /**
+     * Memory per engine and total tick throughput of many engines in one process
+     */
+    void instances_benchmark() noexcept;
+
+    /**
+     * Server datagram throughput over the in-process loopback network, clean and lossy
+     */
+    void loopback_benchmark() noexcept;
+
+    /**
+     * Console message formatting on the producer against deferred formatting
+     */
+    void logging_benchmark() noexcept;
+}
+
+#endif
@@ -0,0 +1,79 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <random>
+#include <vector>
+#include <string>
+#include <blamite/game/entities.hpp>
+#include "benchmark.hpp"
+
+namespace Blamite::Bench {
+    using namespace Blamite::Engine;
+
+    void entities_benchmark() noexcept {
+        constexpr std::size_t entities_count = 10000;
+        constexpr std::size_t ticks = 1000;
+        constexpr float delta = 1.0f / 30.0f;
+
+        std::mt19937 random(1234);
+        std::uniform_real_distribution<float> distribution(-100.0f, 100.0f);
+
+        // Typical game object with everything in one place
+        struct GameObject {
+            std::string tag_path;
+            Vector3D position;
+            Vector3D rotation;
+            Vector3D velocity;
+            Vector3D angular_velocity;
+            float health;
+            float shield;
+            std::uint32_t owner;
+            bool alive;
+            std::byte extra_state[160];
+        };
+
+        std::vector<GameObject> objects(entities_count);
+        EntityStore store;
+        store.reserve(entities_count);
+
+        std::vector<EntityStore::Handle> handles;
+        for(std::size_t i = 0; i < entities_count; i++) {
+            Vector3D position = {distribution(random), distribution(random), distribution(random)};
+            Vector3D velocity = {distribution(random), distribution(random), 0.0f};
+            objects[i].position = position;
+            objects[i].velocity = velocity;
+            objects[i].alive = true;
+            handles.push_back(store.create(position, velocity, 1.0f));
+        }
+
+        // Kill every fourth entity so both layouts have holes to deal with
+        for(std::size_t i = 0; i < entities_count; i += 4) {
+            objects[i].alive = false;
+            store.destroy(handles[i]);
+        }
+
+        double objects_time = measure(ticks, [&]() {
+            for(auto &object : objects) {
+                if(object.alive) {
+                    object.position = object.position + object.velocity * delta;
+                }
+            }
+        });
+
+        double store_time = measure(ticks, [&]() {
+            store.tick(delta);
+        });
+
+        float checksum = 0.0f;
+        store.for_each([&](auto, const Vector3D &position, auto &, float, std::uint32_t) {
+            checksum += position.x;
+        });
+        for(auto &object : objects) {
+            if(object.alive) {
+                checksum -= object.position.x;
+            }
+        }
+
+        std::printf("%zu entities (%zu alive): vector of objects %7.2f us/tick, entity store %7.2f us/tick (drift %.3f)\n", 
+            entities_count, store.size(), objects_time, store_time, checksum);
+    }
+}
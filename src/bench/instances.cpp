@@ -0,0 +1,117 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <random>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <fstream>
+#include <cstdlib>
+#ifndef _WIN32
+#include <unistd.h>
+#include <sys/wait.h>
+#endif
+#include <blamite/host.hpp>
+#include "benchmark.hpp"
+
+namespace Blamite::Bench {
+    using namespace Blamite::Engine;
+
+    namespace {
+        /**
+         * Get resident memory of the process in bytes, or 0 where it cannot be read
+         */
+        std::size_t resident_memory() noexcept {
+            std::ifstream statm("/proc/self/statm");
+            std::size_t size = 0;
+            std::size_t resident = 0;
+            if(!(statm >> size >> resident)) {
+                return 0;
+            }
+            return resident * 4096;
+        }
+
+        /**
+         * Set up an engine with a server on a free port and some moving entities
+         */
+        void init_engine(Blamite::Engine::Engine &engine, std::size_t entities_count, std::mt19937 &random) noexcept {
+            std::uniform_real_distribution<float> distribution(-100.0f, 100.0f);
+            engine.init_console(true, nullptr, false);
+            engine.init_server(0);
+            for(std::size_t i = 0; i < entities_count; i++) {
+                Vector3D position = {distribution(random), distribution(random), distribution(random)};
+                Vector3D velocity = {distribution(random), distribution(random), 0.0f};
+                engine.entities().create(position, velocity, 1.0f);
+            }
+        }
+    }
+
+    void instances_benchmark() noexcept {
+        constexpr std::size_t entities_count = 1000;
+        constexpr auto duration = std::chrono::seconds(1);
+        std::size_t threads_count = std::max(std::thread::hardware_concurrency(), 1u);
+
+        std::printf("%zu threads, %zu entities per instance\n", threads_count, entities_count);
+
+        auto run = [&](std::size_t instances, bool hosted) {
+            std::mt19937 random(1234);
+            auto before = resident_memory();
+
+            // Standalone engines each make their own datagram pool, as separate processes would
+            std::unique_ptr<EngineHost> host;
+            std::vector<std::unique_ptr<Blamite::Engine::Engine>> standalone;
+            std::vector<Blamite::Engine::Engine *> engines;
+            if(hosted) {
+                host = std::make_unique<EngineHost>(threads_count);
+            }
+            for(std::size_t i = 0; i < instances; i++) {
+                auto &engine = hosted ? host->add() : *standalone.emplace_back(std::make_unique<Blamite::Engine::Engine>());
+                init_engine(engine, entities_count, random);
+                engines.push_back(&engine);
+            }
+            auto memory = resident_memory() - before;
+
+            // Tick as fast as possible, each thread taking the engines the host would give it
+            std::atomic<std::size_t> total_ticks = 0;
+            std::vector<std::thread> threads;
+            for(std::size_t thread = 0; thread < std::min(threads_count, instances); thread++) {
+                threads.emplace_back([&, thread]() {
+                    std::size_t ticks = 0;
+                    auto end = std::chrono::steady_clock::now() + duration;
+                    while(std::chrono::steady_clock::now() < end) {
+                        for(std::size_t i = thread; i < engines.size(); i += threads_count) {
+                            engines[i]->bind();
+                            engines[i]->tick();
+                            ticks++;
+                        }
+                    }
+                    total_ticks += ticks;
+                });
+            }
+            for(auto &thread : threads) {
+                thread.join();
+            }
+
+            auto seconds = std::chrono::duration<double>(duration).count();
+            std::printf("%4zu instances, %-10s %8.1f KiB each, %10.0f ticks/s, %6.1fM entity updates/s\n", instances, hosted ? "host:" : "separate:",
+                memory / 1024.0 / instances, total_ticks / seconds, total_ticks * entities_count / seconds / 1e6);
+            std::fflush(stdout);
+        };
+
+        for(std::size_t instances : {1, 8, 32, 128}) {
+            for(bool hosted : {false, true}) {
+                #ifndef _WIN32
+                // Freed memory of a previous run would hide what a new one takes, so each runs in a fresh process
+                std::fflush(stdout);
+                auto child = fork();
+                if(child == 0) {
+                    run(instances, hosted);
+                    std::_Exit(0);
+                }
+                waitpid(child, nullptr, 0);
+                #else
+                run(instances, hosted);
+                #endif
+            }
+        }
+    }
+}
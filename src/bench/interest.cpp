@@ -0,0 +1,97 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <random>
+#include <vector>
+#include <blamite/network/interest.hpp>
+#include "benchmark.hpp"
+
+namespace Blamite::Bench {
+    using namespace Blamite::Engine;
+    using namespace Blamite::Engine::Network;
+
+    void interest_benchmark() noexcept {
+        constexpr std::size_t observers_count = 16;
+        constexpr std::size_t ticks = 300;
+        constexpr float world_size = 1024.0f;
+        constexpr float view_radius = 64.0f;
+        constexpr float speed = 0.5f;
+        constexpr std::size_t moving_ratio = 10;
+
+        for(std::size_t objects_count : {1000, 5000, 20000}) {
+            std::mt19937 random(1234);
+            std::uniform_real_distribution<float> position_distribution(0.0f, world_size);
+            std::uniform_real_distribution<float> step_distribution(-speed, speed);
+
+            std::vector<Vector3D> objects(objects_count);
+            std::vector<Vector3D> observers(observers_count);
+            for(auto &position : objects) {
+                position = {position_distribution(random), position_distribution(random), 0.0f};
+            }
+            for(auto &position : observers) {
+                position = {position_distribution(random), position_distribution(random), 0.0f};
+            }
+
+            // Only some objects move each tick; scenery, items and idle vehicles stay put
+            std::size_t moving_count = objects_count / moving_ratio;
+            std::size_t moving_offset = 0;
+            auto step = [&]() {
+                moving_offset = (moving_offset + moving_count) % objects_count;
+                for(std::size_t i = 0; i < moving_count; i++) {
+                    auto &position = objects[(moving_offset + i) % objects_count];
+                    position = position + Vector3D{step_distribution(random), step_distribution(random), 0.0f};
+                }
+                for(auto &position : observers) {
+                    position = position + Vector3D{step_distribution(random) * 4, step_distribution(random) * 4, 0.0f};
+                }
+            };
+
+            InterestManager interest(16.0f);
+            for(std::size_t i = 0; i < objects_count; i++) {
+                interest.update_object(i, objects[i]);
+            }
+            for(std::size_t i = 0; i < observers_count; i++) {
+                interest.update_observer(i, observers[i], view_radius);
+            }
+            interest.clear_changes();
+
+            // Incremental relevance; only moved objects are fed, like the server does
+            std::size_t grid_queued = 0;
+            double incremental = measure(ticks, [&]() {
+                step();
+                for(std::size_t i = 0; i < moving_count; i++) {
+                    auto object = (moving_offset + i) % objects_count;
+                    interest.update_object(object, objects[object]);
+                }
+                for(std::size_t i = 0; i < observers_count; i++) {
+                    interest.update_observer(i, observers[i], view_radius);
+                }
+                grid_queued += interest.entered().size();
+                for(auto object : interest.updated_objects()) {
+                    grid_queued += interest.watchers(object).size();
+                }
+                interest.clear_changes();
+            });
+
+            // Full rebuild checking every object against every observer
+            std::size_t rebuild_queued = 0;
+            std::vector<std::vector<std::uint32_t>> relevant_sets(observers_count);
+            double rebuild = measure(ticks, [&]() {
+                step();
+                for(std::size_t observer = 0; observer < observers_count; observer++) {
+                    auto &set = relevant_sets[observer];
+                    set.clear();
+                    for(std::size_t i = 0; i < objects_count; i++) {
+                        auto offset = objects[i] - observers[observer];
+                        if(offset.length_squared() <= view_radius * view_radius) {
+                            set.push_back(i);
+                        }
+                    }
+                    rebuild_queued += set.size();
+                }
+            });
+
+            std::printf("%6zu objects (%zu moving), %zu observers: grid %8.1f us/tick (%zu updates/tick), full rebuild %8.1f us/tick (%zu updates/tick)\n", 
+                objects_count, moving_count, observers_count, incremental, grid_queued / ticks, rebuild, rebuild_queued / ticks);
+        }
+    }
+}
@@ -0,0 +1,51 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <random>
+#include <thread>
+#include <blamite/core/job_system.hpp>
+#include <blamite/game/entities.hpp>
+#include "benchmark.hpp"
+
+namespace Blamite::Bench {
+    using namespace Blamite::Engine;
+
+    void jobs_benchmark() noexcept {
+        constexpr std::size_t entities_count = EntityStore::MAX_ENTITIES;
+        constexpr std::size_t chunk_size = 4096;
+        constexpr std::size_t ticks = 2000;
+        constexpr float delta = 1.0f / 30.0f;
+
+        std::mt19937 random(1234);
+        std::uniform_real_distribution<float> distribution(-100.0f, 100.0f);
+
+        EntityStore store;
+        store.reserve(entities_count);
+        for(std::size_t i = 0; i < entities_count; i++) {
+            Vector3D position = {distribution(random), distribution(random), distribution(random)};
+            Vector3D velocity = {distribution(random), distribution(random), 0.0f};
+            store.create(position, velocity, 1.0f);
+        }
+
+        double serial_time = measure(ticks, [&]() {
+            store.tick(delta);
+        });
+        std::printf("serial:   %8.1f us per tick\n", serial_time);
+
+        // Shaped like an engine tick: simulation chunks next to a serial task, then a task needing all of them
+        std::size_t cores = std::max(std::thread::hardware_concurrency(), 1u);
+        for(std::size_t threads = 1; threads <= cores; threads++) {
+            JobSystem jobs(threads - 1);
+            TaskGraph graph;
+            double time = measure(ticks, [&]() {
+                graph.clear();
+                auto network = graph.add([]() {});
+                auto simulation = graph.add_range(store.size(), chunk_size, [&](std::size_t begin, std::size_t end) {
+                    store.tick(delta, begin, end);
+                });
+                graph.add([]() {}, {network, simulation});
+                jobs.run(graph);
+            });
+            std::printf("%2zu cores: %8.1f us per tick (%.2fx serial)\n", threads, time, serial_time / time);
+        }
+    }
+}
@@ -0,0 +1,70 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <string>
+#include <blamite/console/log_queue.hpp>
+#include "benchmark.hpp"
+
+namespace Blamite::Bench {
+    using namespace Blamite::Engine;
+
+    void logging_benchmark() noexcept {
+        constexpr std::size_t batch = 512;
+        constexpr std::size_t rounds = 2000;
+        const std::string address = "192.168.1.20:2303";
+
+        LogQueue queue(batch);
+        char buffer[LogQueue::MAX_TEXT_LENGTH];
+        std::size_t packet_size = 0;
+
+        auto drain = [&]() {
+            const LogQueue::Record *record;
+            while((record = queue.front()) != nullptr) {
+                LogQueue::text(*record, buffer);
+                queue.pop();
+            }
+        };
+
+        // Run a batch of pushes and return nanoseconds per push; draining is timed apart
+        auto run = [&](auto &&push, double &drain_time) {
+            double push_time = 0.0;
+            drain_time = 0.0;
+            for(std::size_t i = 0; i < rounds; i++) {
+                push_time += measure(1, [&]() {
+                    for(std::size_t j = 0; j < batch; j++) {
+                        push(packet_size++);
+                    }
+                });
+                drain_time += measure(1, drain);
+            }
+            drain_time = drain_time * 1000.0 / (rounds * batch);
+            return push_time * 1000.0 / (rounds * batch);
+        };
+
+        double drain_time;
+        auto stack_time = run([&](std::size_t size) {
+            char buff[256];
+            std::snprintf(buff, sizeof(buff), "Sent %zu bytes to %s", size, address.c_str());
+            queue.push(Term::fg::gray, std::string(buff));
+        }, drain_time);
+        std::printf("stack buffer and string:  %7.1fns per message, %7.1fns to drain\n", stack_time, drain_time);
+
+        auto eager_time = run([&](std::size_t size) {
+            auto *record = queue.reserve();
+            if(record) {
+                record->color = Term::fg::gray;
+                queue.commit(record, std::snprintf(record->text, sizeof(record->text), "Sent %zu bytes to %s", size, address.c_str()));
+            }
+        }, drain_time);
+        std::printf("formatted in queue:       %7.1fns per message, %7.1fns to drain\n", eager_time, drain_time);
+
+        auto deferred_time = run([&](std::size_t size) {
+            queue.push_deferred(Term::fg::gray, "Sent %zu bytes to %s", size, address.c_str());
+        }, drain_time);
+        std::printf("deferred formatting:      %7.1fns per message, %7.1fns to drain\n", deferred_time, drain_time);
+
+        auto id_time = run([&](std::size_t size) {
+            queue.push_deferred(Term::fg::gray, "Sent %zu bytes to client %u", size, 7u);
+        }, drain_time);
+        std::printf("deferred, numbers only:   %7.1fns per message, %7.1fns to drain\n", id_time, drain_time);
+    }
+}
@@ -0,0 +1,115 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <vector>
+#include <memory>
+#include <blamite/engine.hpp>
+#include <blamite/core/version.hpp>
+#include <blamite/network/loopback.hpp>
+#include "benchmark.hpp"
+
+namespace Blamite::Bench {
+    using namespace Blamite::Engine;
+    using namespace Blamite::Engine::Network;
+
+    namespace {
+        struct Result {
+            /** Datagrams received by the server per second; lost ones and the server's own replies do not count */
+            double rate;
+
+            /** Network stats at the end */
+            LoopbackNetwork::Stats stats;
+        };
+
+        /**
+         * Connect clients to a server on a loopback network and have them flood it with keepalives
+         * @param conditions    Network conditions
+         * @param ticks         Server ticks to run
+         * @param burst         Datagrams each client sends per tick
+         */
+        Result run(const LoopbackNetwork::Conditions &conditions, std::size_t ticks, std::size_t burst) noexcept {
+            constexpr std::size_t clients_count = 16;
+            constexpr std::uint16_t server_port = 2302;
+            auto tick_duration = std::chrono::duration_cast<LoopbackNetwork::duration_t>(std::chrono::duration<double>(1.0 / DEFAULT_TICK_RATE));
+
+            // Declared first so it outlives the transports
+            LoopbackNetwork network(1234);
+            sockpp::inet_address server_address("127.0.0.1", server_port);
+
+            Blamite::Engine::Engine engine;
+            engine.init_console(true, nullptr, false);
+            engine.init_server(std::make_unique<LoopbackTransport>(network, server_address));
+            auto &server = engine.server();
+
+            std::vector<std::unique_ptr<LoopbackTransport>> clients;
+            for(std::size_t i = 0; i < clients_count; i++) {
+                clients.push_back(std::make_unique<LoopbackTransport>(network, sockpp::inet_address("127.0.1.1", 3000 + i)));
+            }
+
+            std::byte buffer[Server::MAX_DATAGRAM_SIZE];
+            std::size_t received = 0;
+            auto tick = [&]() {
+                network.advance(tick_duration);
+                server.read_data();
+                received += server.received_count();
+                server.process_received_data();
+                server.process_timers(TIMER_RATE / DEFAULT_TICK_RATE);
+                server.send_scheduled_updates();
+                engine.frame_arena().reset();
+                for(auto &client : clients) {
+                    while(client->receive_from(buffer, sizeof(buffer), nullptr) > 0);
+                }
+            };
+
+            // Handshake on a clean network; the console is never rendered, so connection messages stay quiet
+            for(auto &client : clients) {
+                ClientChallengePacket challenge = {};
+                challenge.header.type = PACKET_TYPE_HANDSHAKE_CLIENT_CHALLENGE;
+                client->send_to(&challenge, sizeof(challenge), server_address);
+
+                ClientHandshake handshake = {};
+                handshake.header.type = PACKET_TYPE_HANDSHAKE_CLIENT_RESPONSE;
+                handshake.version = CLIENT_VERSION;
+                client->send_to(&handshake, sizeof(handshake), server_address);
+            }
+            tick();
+
+            network.set_conditions(conditions);
+            received = 0;
+            double time = measure(ticks, [&]() {
+                for(auto &client : clients) {
+                    Packet keepalive = {};
+                    keepalive.header.type = PACKET_TYPE_ENCRYPTED;
+                    for(std::size_t i = 0; i < burst; i++) {
+                        client->send_to(&keepalive, sizeof(keepalive), server_address);
+                    }
+                }
+                tick();
+            });
+
+            auto stats = network.stats();
+            return {received / (time * ticks / 1000000.0), stats};
+        }
+    }
+
+    void loopback_benchmark() noexcept {
+        constexpr std::size_t ticks = 2000;
+        constexpr std::size_t burst = 64;
+
+        LoopbackNetwork::Conditions clean;
+        LoopbackNetwork::Conditions lossy;
+        lossy.loss = 0.1;
+        lossy.latency = std::chrono::milliseconds(50);
+        lossy.jitter = std::chrono::milliseconds(30);
+
+        auto print = [](const char *name, const Result &result) {
+            std::printf("%-6s %10.0f datagrams/s received by the server (sent %zu, lost %zu, delivered %zu)\n", name, result.rate, result.stats.sent, result.stats.lost, result.stats.delivered);
+        };
+        print("clean:", run(clean, ticks, burst));
+
+        auto first = run(lossy, ticks, burst);
+        auto second = run(lossy, ticks, burst);
+        print("lossy:", first);
+        bool same = first.stats.lost == second.stats.lost && first.stats.delivered == second.stats.delivered;
+        std::printf("lossy runs with the same seed %s\n", same ? "match" : "DIFFER");
+    }
+}
@@ -0,0 +1,41 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <cstring>
+#include "benchmark.hpp"
+
+using namespace Blamite::Bench;
+
+struct Benchmark {
+    const char *name;
+    void (*function)() noexcept;
+};
+
+static const Benchmark benchmarks[] = {
+    {"entities", entities_benchmark},
+    {"instances", instances_benchmark},
+    {"interest", interest_benchmark},
+    {"jobs", jobs_benchmark},
+    {"logging", logging_benchmark},
+    {"loopback", loopback_benchmark}
+};
+
+int main(int argc, const char **argv) {
+    bool found = false;
+    for(auto &benchmark : benchmarks) {
+        if(argc > 1 && std::strcmp(argv[1], benchmark.name) != 0) {
+            continue;
+        }
+        std::printf("== %s\n", benchmark.name);
+        benchmark.function();
+        found = true;
+    }
+
+    if(!found) {
+        std::printf("Unknown benchmark \"%s\". Available benchmarks:\n", argv[1]);
+        for(auto &benchmark : benchmarks) {
+            std::printf("  %s\n", benchmark.name);
+        }
+        return 1;
+    }
+    return 0;
+}
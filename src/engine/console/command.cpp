@@ -5,65 +5,90 @@
 #include <blamite/console/command.hpp>
 
 namespace Blamite::Engine {
-    std::string ConsoleCommand::name() noexcept {
+    const std::string &ConsoleCommand::name() const noexcept {
         return m_name;
     }
 
-    ConsoleCommand::Result ConsoleCommand::execute(std::string args) noexcept {
-        auto splitted_args = split_arguments(args);
+    bool ConsoleCommand::run_in_background() const noexcept {
+        return m_run_in_background;
+    }
 
-        if(splitted_args.size() < m_min_args) {
+    ConsoleCommand::Result ConsoleCommand::execute(arguments_t &args) noexcept {
+        if(args.size() < m_min_args) {
             return COMMAND_RESULT_NOT_ENOUGH_ARGUMENTS;
         }
-        if(splitted_args.size() > m_max_args) {
+        if(args.size() > m_max_args) {
             return COMMAND_RESULT_TOO_MANY_ARGUMENTS;
         }
 
-        if(!m_function(splitted_args)) {
+        if(!m_function(args)) {
             return COMMAND_RESULT_ERROR;
         }
         return COMMAND_RESULT_SUCCESS;
     }
 
-    ConsoleCommand::ConsoleCommand(std::string name, std::size_t min_args, std::size_t max_args, function_t function) noexcept {
+    ConsoleCommand::ConsoleCommand(std::string name, std::size_t min_args, std::size_t max_args, function_t function, bool run_in_background) noexcept {
         m_name = name;
         m_min_args = min_args;
         m_max_args = max_args;
         m_function = function;
+        m_run_in_background = run_in_background;
     }
 
-    std::vector<std::string> ConsoleCommand::split_arguments(std::string args) noexcept {
-        std::vector<std::string> args_slices;
-        std::string slice;
+    void ConsoleCommand::split_arguments(std::string &line, arguments_t &args) noexcept {
+        args.clear();
 
+        // Unescaped text is written back over the line, which never runs ahead of reading
+        char *data = line.data();
+        std::size_t write = 0;
+        std::size_t slice_start = 0;
+        bool in_slice = false;
         bool escaped = false;
         bool in_quotes = false;
-        for(char const &c : args) {
+
+        auto end_slice = [&]() {
+            if(in_slice) {
+                args.emplace_back(data + slice_start, write - slice_start);
+                data[write++] = '\0';
+                in_slice = false;
+            }
+        };
+
+        for(std::size_t read = 0; read < line.size(); read++) {
+            char c = data[read];
             if(escaped) {
-                slice.push_back(c);
                 escaped = false;
             }
-            else {
-                if(c == '\\') {
-                    escaped = true;
-                }
-                else if(c == '"') {
-                    in_quotes = !in_quotes;
-                }
-                else if(!in_quotes && c == ' ') {
-                    if(!slice.empty()) {
-                        args_slices.push_back(slice);
-                    }
-                }
-                else {
-                    slice.push_back(c);
+            else if(c == '\\') {
+                escaped = true;
+                continue;
+            }
+            else if(c == '"') {
+                in_quotes = !in_quotes;
+
+                // Quotes may hold an empty argument
+                if(!in_slice) {
+                    in_slice = true;
+                    slice_start = write;
                 }
+                continue;
             }
-        }
-        if(!slice.empty()) {
-            args_slices.push_back(slice);
+            else if(!in_quotes && c == ' ') {
+                end_slice();
+                continue;
+            }
+
+            if(!in_slice) {
+                in_slice = true;
+                slice_start = write;
+            }
+            data[write++] = c;
         }
 
-        return args_slices;
+        // Last argument may end right at the line terminator
+        if(in_slice) {
+            args.emplace_back(data + slice_start, write - slice_start);
+            data[write] = '\0';
+        }
     }
 }
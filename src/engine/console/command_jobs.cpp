@@ -0,0 +1,157 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <algorithm>
+#include <blamite/console/command_jobs.hpp>
+
+namespace Blamite::Engine {
+    namespace {
+        /** Cancel flag of the job running on this thread */
+        thread_local const std::atomic<bool> *current_cancel_flag = nullptr;
+    }
+
+    CommandJobs::job_id_t CommandJobs::submit(ConsoleCommand &command, std::string_view line, std::shared_ptr<CommandOutput> output) noexcept {
+        auto job = std::make_shared<Job>();
+        job->command = &command;
+        job->output = std::move(output);
+        job->line.assign(line);
+        job->split_line.assign(line);
+        job->queued = std::chrono::steady_clock::now();
+
+        // Drop command name, which is the first argument
+        ConsoleCommand::split_arguments(job->split_line, job->arguments);
+        if(!job->arguments.empty()) {
+            job->arguments.erase(job->arguments.begin());
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        job->id = m_next_id++;
+        m_jobs.push_back(job);
+        m_queue.push_back(job);
+
+        if(m_workers.empty()) {
+            for(std::size_t i = 0; i < m_workers_count; i++) {
+                m_workers.emplace_back(&CommandJobs::work, this);
+            }
+        }
+        m_condition.notify_one();
+        return job->id;
+    }
+
+    bool CommandJobs::cancel(job_id_t id) noexcept {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = std::find_if(m_jobs.begin(), m_jobs.end(), [id](auto &job) {
+            return job->id == id;
+        });
+        if(it == m_jobs.end()) {
+            return false;
+        }
+
+        auto job = *it;
+        job->cancelled = true;
+        if(!job->running) {
+            m_queue.erase(std::find(m_queue.begin(), m_queue.end(), job));
+            forget(*job);
+            if(job->output) {
+                job->output->write("Cancelled.");
+                job->output->finish();
+            }
+        }
+        return true;
+    }
+
+    std::vector<CommandJobs::JobInfo> CommandJobs::list() const noexcept {
+        auto now = std::chrono::steady_clock::now();
+        std::vector<JobInfo> jobs;
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for(auto &job : m_jobs) {
+            jobs.push_back({job->id, job->command->name(), job->line, job->running, job->cancelled, now - job->queued});
+        }
+        return jobs;
+    }
+
+    void CommandJobs::set_thread_init(thread_init_t thread_init) noexcept {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_thread_init = std::move(thread_init);
+    }
+
+    bool CommandJobs::cancelled() noexcept {
+        return current_cancel_flag && current_cancel_flag->load(std::memory_order_relaxed);
+    }
+
+    CommandJobs::CommandJobs(std::size_t workers, finish_t finish) noexcept {
+        m_workers_count = std::max<std::size_t>(workers, 1);
+        m_finish = std::move(finish);
+    }
+
+    CommandJobs::~CommandJobs() noexcept {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+            m_queue.clear();
+            for(auto &job : m_jobs) {
+                job->cancelled = true;
+                if(job->output && !job->running) {
+                    job->output->finish();
+                }
+            }
+        }
+        m_condition.notify_all();
+
+        for(auto &worker : m_workers) {
+            worker.join();
+        }
+    }
+
+    void CommandJobs::work() noexcept {
+        thread_init_t thread_init;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            thread_init = m_thread_init;
+        }
+        if(thread_init) {
+            thread_init();
+        }
+
+        while(true) {
+            std::shared_ptr<Job> job;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_condition.wait(lock, [this]() {
+                    return m_stopping || !m_queue.empty();
+                });
+                if(m_stopping) {
+                    return;
+                }
+                job = m_queue.front();
+                m_queue.pop_front();
+                job->running = true;
+            }
+
+            current_cancel_flag = &job->cancelled;
+            CommandOutput::set_current(job->output.get());
+            auto result = job->command->execute(job->arguments);
+            if(m_finish) {
+                m_finish(*job->command, result, job->cancelled);
+            }
+            CommandOutput::set_current(nullptr);
+            current_cancel_flag = nullptr;
+
+            if(job->output) {
+                job->output->finish();
+            }
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            forget(*job);
+        }
+    }
+
+    void CommandJobs::forget(const Job &job) noexcept {
+        auto it = std::find_if(m_jobs.begin(), m_jobs.end(), [&job](auto &entry) {
+            return entry.get() == &job;
+        });
+        if(it != m_jobs.end()) {
+            m_jobs.erase(it);
+        }
+    }
+}
@@ -0,0 +1,36 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <blamite/console/command_output.hpp>
+
+namespace Blamite::Engine {
+    namespace {
+        /** Output of the command running on this thread */
+        thread_local CommandOutput *current_output = nullptr;
+    }
+
+    void CommandOutput::write(std::string_view line) noexcept {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_text.append(line);
+        m_text.push_back('\n');
+    }
+
+    void CommandOutput::finish() noexcept {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_finished = true;
+    }
+
+    bool CommandOutput::take(std::string &text) noexcept {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        text.append(m_text);
+        m_text.clear();
+        return m_finished;
+    }
+
+    CommandOutput *CommandOutput::current() noexcept {
+        return current_output;
+    }
+
+    void CommandOutput::set_current(CommandOutput *output) noexcept {
+        current_output = output;
+    }
+}
@@ -0,0 +1,102 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <algorithm>
+#include <blamite/console/command_registry.hpp>
+
+namespace Blamite::Engine {
+    bool CommandRegistry::add(std::unique_ptr<ConsoleCommand> command) noexcept {
+        std::string_view name = command->name();
+        if(name.empty() || m_commands.find(name) != m_commands.end()) {
+            return false;
+        }
+
+        std::size_t node = 0;
+        for(char c : name) {
+            auto &children = m_nodes[node].children;
+            auto it = std::lower_bound(children.begin(), children.end(), c, [](auto &child, char c) {
+                return child.first < c;
+            });
+            if(it != children.end() && it->first == c) {
+                node = it->second;
+            }
+            else {
+                std::uint32_t child = m_nodes.size();
+                children.insert(it, {c, child});
+                m_nodes.emplace_back();
+                node = child;
+            }
+        }
+        m_nodes[node].command = command.get();
+
+        m_commands.emplace(name, std::move(command));
+        return true;
+    }
+
+    ConsoleCommand *CommandRegistry::find(std::string_view name) const noexcept {
+        auto it = m_commands.find(name);
+        return it != m_commands.end() ? it->second.get() : nullptr;
+    }
+
+    void CommandRegistry::complete(std::string_view prefix, std::vector<std::string_view> &names, std::size_t limit) const noexcept {
+        names.clear();
+        auto node = find_node(prefix);
+        if(node != SIZE_MAX) {
+            collect(node, names, limit);
+        }
+    }
+
+    std::string_view CommandRegistry::common_prefix(std::string_view prefix) const noexcept {
+        auto node = find_node(prefix);
+        if(node == SIZE_MAX) {
+            return {};
+        }
+
+        // Follow the only branch until names split or one ends
+        std::size_t length = prefix.size();
+        while(!m_nodes[node].command && m_nodes[node].children.size() == 1) {
+            node = m_nodes[node].children.front().second;
+            length++;
+        }
+
+        // Any name under the node spells the prefix; every leaf ends a name
+        while(!m_nodes[node].command) {
+            node = m_nodes[node].children.front().second;
+        }
+        return std::string_view(m_nodes[node].command->name()).substr(0, length);
+    }
+
+    std::size_t CommandRegistry::size() const noexcept {
+        return m_commands.size();
+    }
+
+    CommandRegistry::CommandRegistry() noexcept {
+        m_nodes.emplace_back();
+    }
+
+    std::size_t CommandRegistry::find_node(std::string_view prefix) const noexcept {
+        std::size_t node = 0;
+        for(char c : prefix) {
+            auto &children = m_nodes[node].children;
+            auto it = std::lower_bound(children.begin(), children.end(), c, [](auto &child, char c) {
+                return child.first < c;
+            });
+            if(it == children.end() || it->first != c) {
+                return SIZE_MAX;
+            }
+            node = it->second;
+        }
+        return node;
+    }
+
+    void CommandRegistry::collect(std::size_t node, std::vector<std::string_view> &names, std::size_t limit) const noexcept {
+        if(names.size() >= limit) {
+            return;
+        }
+        if(m_nodes[node].command) {
+            names.emplace_back(m_nodes[node].command->name());
+        }
+        for(auto &child : m_nodes[node].children) {
+            collect(child.second, names, limit);
+        }
+    }
+}
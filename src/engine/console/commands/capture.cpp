@@ -0,0 +1,80 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <charconv>
+#include <stdexcept>
+#include <blamite/engine.hpp>
+#include <blamite/console/command.hpp>
+
+namespace Blamite::Engine {
+    bool capture_command(ConsoleCommand::arguments_t &args) noexcept {
+        auto &engine = Engine::get();
+        auto &console = engine.console();
+        auto &server = engine.server();
+
+        auto action = args.empty() ? std::string_view() : args[0];
+        if(action == "start") {
+            std::size_t slots = 4096;
+            if(args.size() > 1) {
+                auto [end, error] = std::from_chars(args[1].data(), args[1].data() + args[1].size(), slots);
+                if(error != std::errc() || end != args[1].data() + args[1].size() || slots == 0) {
+                    console.printf(Console::Color::gray, "Invalid slot count \"%s\".", args[1].data());
+                    return false;
+                }
+                if(slots > Network::PacketCapture::MAX_SLOTS) {
+                    console.printf(Console::Color::gray, "At most %zu slots can be captured.", Network::PacketCapture::MAX_SLOTS);
+                    return false;
+                }
+            }
+            try {
+                server.start_capture(slots);
+            }
+            catch(std::runtime_error &error) {
+                console.print(Console::Color::red, error.what());
+                return false;
+            }
+            console.printf("Capturing the last %zu datagrams.", slots);
+            return true;
+        }
+
+        if(action == "stop") {
+            server.stop_capture();
+            console.print("Capture stopped.");
+            return true;
+        }
+
+        if(action == "dump") {
+            if(args.size() < 2) {
+                console.print(Console::Color::gray, "Usage: capture dump <file> [decrypt]");
+                return false;
+            }
+            if(!server.capture()) {
+                console.print(Console::Color::gray, "Not capturing; use \"capture start\" first.");
+                return false;
+            }
+
+            bool decrypt = args.size() > 2 && args[2] == "decrypt";
+            Network::Server::CaptureDump dump;
+            if(!server.dump_capture(std::string(args[1]), decrypt, dump)) {
+                console.printf(Console::Color::red, "Failed to write capture to %s.", args[1].data());
+                return false;
+            }
+            console.printf("Wrote %zu datagrams to %s (%zu decrypted).", dump.datagrams, args[1].data(), dump.decrypted);
+            return true;
+        }
+
+        if(!action.empty()) {
+            console.print(Console::Color::gray, "Usage: capture [start [slots] | stop | dump <file> [decrypt]]");
+            return false;
+        }
+
+        auto *capture = server.capture();
+        if(!capture) {
+            console.print("Capture is off.");
+        }
+        else {
+            auto stats = capture->stats();
+            console.printf("Capturing: %zu datagrams recorded, last %zu kept.", stats.recorded, stats.slots);
+        }
+        return true;
+    }
+}
@@ -0,0 +1,80 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <string>
+#include <charconv>
+#include <blamite/engine.hpp>
+#include <blamite/console/command.hpp>
+
+namespace Blamite::Engine {
+    namespace {
+        /**
+         * Parse a whole argument as an unsigned number
+         */
+        bool parse_size(std::string_view text, std::size_t &value) noexcept {
+            auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+            return error == std::errc() && end == text.data() + text.size();
+        }
+    }
+
+    bool clients_command(ConsoleCommand::arguments_t &) noexcept {
+        auto &engine = Engine::get();
+        auto &console = engine.console();
+        auto clients = engine.server().clients_info();
+
+        if(clients.empty()) {
+            console.print("No clients connected.");
+            return true;
+        }
+
+        for(auto &client : clients) {
+            auto &stats = client.stats;
+            console.printf("#%u %s: %zu/%zu bytes last tick (%.0f%% of budget, %zu B/s), %zu updates sent, %zu deferred, %zu dropped as too large, %zu bytes total", 
+                client.id, client.address.c_str(), stats.sent, stats.budget, stats.utilisation() * 100.0f, client.bandwidth, 
+                stats.sent_updates, stats.deferred_updates, stats.dropped_updates, stats.total_sent);
+            console.printf("  %zu relevant objects, %zu messages received, %zu fragments pending, %zu incomplete messages dropped", 
+                client.relevant_objects, client.received_messages, client.held_fragments, client.dropped_messages);
+        }
+
+        return true;
+    }
+
+    bool client_bandwidth_command(ConsoleCommand::arguments_t &args) noexcept {
+        auto &engine = Engine::get();
+        auto &console = engine.console();
+        auto &server = engine.server();
+
+        if(!args.empty()) {
+            std::size_t value;
+            if(!parse_size(args[0], value)) {
+                console.printf(Console::Color::gray, "Invalid bandwidth \"%s\".", args[0].data());
+                return false;
+            }
+            server.set_client_bandwidth(value);
+        }
+
+        console.printf("Client bandwidth: %zu bytes per second", server.client_bandwidth());
+        return true;
+    }
+
+    bool path_mtu_command(ConsoleCommand::arguments_t &args) noexcept {
+        auto &engine = Engine::get();
+        auto &console = engine.console();
+        auto &server = engine.server();
+
+        if(!args.empty()) {
+            std::size_t value;
+            if(!parse_size(args[0], value)) {
+                console.printf(Console::Color::gray, "Invalid MTU \"%s\".", args[0].data());
+                return false;
+            }
+            if(value < Network::Server::MIN_PATH_MTU || value > Network::Server::MAX_DATAGRAM_SIZE) {
+                console.printf(Console::Color::gray, "The path MTU must be between %zu and %zu bytes.", Network::Server::MIN_PATH_MTU, Network::Server::MAX_DATAGRAM_SIZE);
+                return false;
+            }
+            server.set_path_mtu(value);
+        }
+
+        console.printf("Path MTU: %zu bytes", server.path_mtu());
+        return true;
+    }
+}
@@ -0,0 +1,65 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <cmath>
+#include <thread>
+#include <charconv>
+#include <blamite/engine.hpp>
+#include <blamite/console/command.hpp>
+
+namespace Blamite::Engine {
+    bool jobs_command(ConsoleCommand::arguments_t &) noexcept {
+        auto &console = Engine::get().console();
+        auto jobs = console.jobs().list();
+
+        if(jobs.empty()) {
+            console.print("No background jobs.");
+            return true;
+        }
+
+        for(auto &job : jobs) {
+            auto state = job.cancelled ? "cancelling" : job.running ? "running" : "queued";
+            auto seconds = std::chrono::duration<float>(job.age).count();
+            console.printf("%u  %-10s  %6.1fs  %s", job.id, state, seconds, job.line.c_str());
+        }
+        return true;
+    }
+
+    bool cancel_command(ConsoleCommand::arguments_t &args) noexcept {
+        auto &console = Engine::get().console();
+
+        CommandJobs::job_id_t id;
+        auto [end, error] = std::from_chars(args[0].data(), args[0].data() + args[0].size(), id);
+        if(error != std::errc() || end != args[0].data() + args[0].size() || !console.jobs().cancel(id)) {
+            console.printf(Console::Color::gray, "No job \"%s\".", args[0].data());
+            return false;
+        }
+        return true;
+    }
+
+    bool wait_command(ConsoleCommand::arguments_t &args) noexcept {
+        auto &console = Engine::get().console();
+
+        // Longer waits are better off as a cancel
+        constexpr float max_seconds = 3600.0f;
+
+        float seconds;
+        auto [end_of_number, error] = std::from_chars(args[0].data(), args[0].data() + args[0].size(), seconds);
+        if(error != std::errc() || end_of_number != args[0].data() + args[0].size() || !std::isfinite(seconds) || seconds < 0.0f || seconds > max_seconds) {
+            console.printf(Console::Color::gray, "Invalid time \"%s\"; it must be between 0 and %.0f seconds.", args[0].data(), max_seconds);
+            return false;
+        }
+
+        // Sleep in slices so the job can be cancelled
+        using steady_clock = std::chrono::steady_clock;
+        auto end = steady_clock::now() + std::chrono::duration_cast<steady_clock::duration>(std::chrono::duration<float>(seconds));
+        while(steady_clock::now() < end) {
+            if(CommandJobs::cancelled()) {
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+
+        console.printf("Waited %.2f seconds.", seconds);
+        return true;
+    }
+}
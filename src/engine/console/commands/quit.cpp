@@ -4,8 +4,8 @@
 #include <blamite/console/command.hpp>
 
 namespace Blamite::Engine {
-    bool quit_command(std::vector<std::string> &) noexcept {
-        Engine::m_main_loop_stop_flag = true;
+    bool quit_command(ConsoleCommand::arguments_t &) noexcept {
+        Engine::get().stop();
         return true;
     }
 }
@@ -1,16 +1,73 @@
 // SPDX-License-Identifier: GPL-3.0-only
 
+#include <charconv>
 #include <blamite/engine.hpp>
 #include <blamite/console/command.hpp>
 
 namespace Blamite::Engine {
-    bool ticks_command(std::vector<std::string> &) noexcept {
+    bool ticks_command(ConsoleCommand::arguments_t &) noexcept {
         auto &engine = Engine::get();
         auto &console = engine.console();
 
-        console.printf("Ticks count: %d", engine.tick_count());
+        console.printf("Ticks count: %zu", engine.tick_count());
+        console.printf("Tick rate: %u per second (set %u, idle %u)", engine.active_tick_rate(), engine.tick_rate(), engine.idle_tick_rate());
         console.printf("Ticks timestamp: %.2fms", engine.tick_timestamp());
 
+        auto arena_stats = engine.frame_arena().stats();
+        console.printf("Heap allocations last tick: %zu", engine.tick_allocations());
+        console.printf("Frame arena last tick: %zu bytes (peak %zu of %zu, overflowed %zu times)", arena_stats.last, arena_stats.peak, arena_stats.capacity, arena_stats.overflows);
+
+        auto &console_stats = console.stats();
+        auto to_ms = [](auto duration) {
+            return std::chrono::duration<float, std::milli>(duration).count();
+        };
+        console.printf("Console time last tick: %.3fms", to_ms(console_stats.last_tick_time));
+        console.printf("Console renders: %zu (last %.3fms), idle ticks: %zu", console_stats.renders, to_ms(console_stats.last_render_time), console_stats.idle_ticks);
+        console.printf("Console messages dropped: %zu", console_stats.dropped_messages);
+
+        return true;
+    }
+
+    bool tick_rate_command(ConsoleCommand::arguments_t &args) noexcept {
+        auto &engine = Engine::get();
+        auto &console = engine.console();
+
+        auto parse_rate = [&console](std::string_view arg, unsigned int minimum, unsigned int &rate) {
+            auto [end, error] = std::from_chars(arg.data(), arg.data() + arg.size(), rate);
+            if(error != std::errc() || end != arg.data() + arg.size() || rate < minimum || rate > TIMER_RATE) {
+                console.printf(Console::Color::gray, "Invalid tick rate \"%s\"; it goes from %u to %u.", arg.data(), minimum, TIMER_RATE);
+                return false;
+            }
+            return true;
+        };
+
+        unsigned int rate;
+        if(args.size() == 2) {
+            if(args[0] != "idle") {
+                console.print(Console::Color::gray, "Usage: tick_rate [<rate> | idle <rate | off>]");
+                return false;
+            }
+            if(args[1] == "off") {
+                rate = 0;
+            }
+            else if(!parse_rate(args[1], 1, rate)) {
+                return false;
+            }
+            engine.set_idle_tick_rate(rate);
+        }
+        else if(args.size() == 1) {
+            if(!parse_rate(args[0], 1, rate)) {
+                return false;
+            }
+            engine.set_tick_rate(rate);
+        }
+
+        if(engine.idle_tick_rate() != 0) {
+            console.printf("Tick rate: %u per second, %u when idle; running at %u.", engine.tick_rate(), engine.idle_tick_rate(), engine.active_tick_rate());
+        }
+        else {
+            console.printf("Tick rate: %u per second.", engine.tick_rate());
+        }
         return true;
     }
 }
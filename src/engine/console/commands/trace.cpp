@@ -0,0 +1,59 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <cmath>
+#include <charconv>
+#include <blamite/engine.hpp>
+#include <blamite/core/trace.hpp>
+#include <blamite/console/command.hpp>
+
+namespace Blamite::Engine {
+    bool trace_command(ConsoleCommand::arguments_t &args) noexcept {
+        auto &console = Engine::get().console();
+        auto &tracer = Tracer::get();
+
+        auto action = args.empty() ? std::string_view() : args[0];
+        if(action == "start") {
+            tracer.set_enabled(true);
+            console.printf("Tracing; each thread keeps its last %zu events.", Tracer::RING_SIZE);
+            return true;
+        }
+
+        if(action == "stop") {
+            tracer.set_enabled(false);
+            console.print("Tracing stopped.");
+            return true;
+        }
+
+        if(action == "dump") {
+            if(args.size() < 2) {
+                console.print(Console::Color::gray, "Usage: trace dump <file> [seconds]");
+                return false;
+            }
+
+            float seconds = 5.0f;
+            if(args.size() > 2) {
+                auto [end, error] = std::from_chars(args[2].data(), args[2].data() + args[2].size(), seconds);
+                if(error != std::errc() || end != args[2].data() + args[2].size() || !std::isfinite(seconds) || seconds <= 0.0f) {
+                    console.printf(Console::Color::gray, "Invalid time \"%s\".", args[2].data());
+                    return false;
+                }
+            }
+
+            Tracer::DumpStats stats;
+            if(!tracer.write_chrome_trace(std::string(args[1]), seconds, stats)) {
+                console.printf(Console::Color::red, "Failed to write trace to %s.", args[1].data());
+                return false;
+            }
+            console.printf("Wrote %zu events from %zu threads over the last %.1f seconds to %s.", stats.events, stats.threads, seconds, args[1].data());
+            return true;
+        }
+
+        if(!action.empty()) {
+            console.print(Console::Color::gray, "Usage: trace [start | stop | dump <file> [seconds]]");
+            return false;
+        }
+
+        console.print(tracer.enabled() ? "Tracing is on." : "Tracing is off.");
+        return true;
+    }
+}
@@ -3,11 +3,30 @@
 #include <iostream>
 #include <vector>
 #include <functional>
+#include <csignal>
+#include <cstdio>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 #include <cpp-terminal/input.hpp>
+#include <blamite/core/trace.hpp>
 #include <blamite/console/console.hpp>
 
 namespace Blamite::Engine {
-    void Console::init() noexcept {
+    namespace {
+        /** Set by SIGWINCH handler */
+        volatile std::sig_atomic_t terminal_resized = 0;
+    }
+
+    void Console::init(bool headless, const char *command_fifo, bool read_stdin) noexcept {
+        m_headless = headless;
+        if(headless) {
+            open_command_input(command_fifo, read_stdin);
+            register_commands();
+            return;
+        }
+
         const auto [rows, cols] = get_size();
         m_terminal = std::make_unique<Term::Terminal>(true, true, true);
         m_screen = std::make_unique<Term::Window>(cols, rows);
@@ -15,56 +34,288 @@ namespace Blamite::Engine {
 
         m_input_cursor_pos = 1;
         m_history_pos = 0;
+        m_dirty = DIRTY_INPUT | DIRTY_OUTPUT | DIRTY_SIZE;
+
+        #ifdef SIGWINCH
+        std::signal(SIGWINCH, [](int) {
+            terminal_resized = 1;
+        });
+        #endif
 
         register_commands();
     }
 
-    void Console::read_input() noexcept {
-        try {
-            int key;
-            if((key = Term::read_key0()) != 0) {
-                auto result = process_input(key);
-                
-                // Re-render prompt after process input
-                render_screen();
+    bool Console::headless() const noexcept {
+        return m_headless;
+    }
 
-                if(result.has_value()) {
-                    auto command = result.value();
-                    if(command == "clear") {
-                        this->clear();
-                    }
-                    else {
-                        execute_command(command);
+    void Console::set_line_prefix(std::string prefix) noexcept {
+        m_line_prefix = std::move(prefix);
+    }
+
+    void Console::read_input() noexcept {
+        TRACE_SCOPE("console input");
+        auto start = std::chrono::steady_clock::now();
+        if(m_headless) {
+            read_command_input();
+        }
+        else {
+            try {
+                int key;
+                while((key = Term::read_key0()) != 0) {
+                    auto result = process_input(key);
+                    m_dirty |= DIRTY_INPUT;
+
+                    if(result.has_value()) {
+                        auto command = result.value();
+                        if(command == "clear") {
+                            this->clear();
+                        }
+                        else {
+                            execute_command(command);
+                        }
                     }
                 }
             }
-            else {
-                render_screen();
+            // Written through the console, since writing to the terminal directly would throw off the diff renderer
+            catch (const std::runtime_error& re) {
+                printf(Color::red, "Runtime error: %s", re.what());
+            }
+            catch (...) {
+                print(Color::red, "Unknown error.");
             }
         }
-        catch (const std::runtime_error& re) {
-            std::cerr << "Runtime error: " << re.what() << std::endl;
+
+        // Run commands sent from other threads
+        {
+            std::lock_guard<std::mutex> lock(m_queued_commands_mutex);
+            m_running_commands.swap(m_queued_commands);
         }
-        catch (...) {
-            std::cerr << "Unknown error." << std::endl;
+        for(auto &command : m_running_commands) {
+            execute_command(command.line, std::move(command.output));
         }
+        m_running_commands.clear();
+
+        m_input_time = std::chrono::steady_clock::now() - start;
     }
 
-    void Console::print(Color color, std::string out) noexcept {
-        if(m_screen_buffer.size() == c_max_screen_buffer_size) {
-            m_screen_buffer.pop_front();
+    void Console::render() noexcept {
+        TRACE_SCOPE("console render");
+        auto start = std::chrono::steady_clock::now();
+        drain_log_queue();
+
+        // Plain lines, written at once
+        if(m_headless) {
+            if(m_output_buffer.empty()) {
+                m_stats.idle_ticks++;
+                m_stats.last_tick_time = m_input_time + (std::chrono::steady_clock::now() - start);
+                return;
+            }
+            std::fwrite(m_output_buffer.data(), 1, m_output_buffer.size(), stdout);
+            std::fflush(stdout);
+            m_output_buffer.clear();
+
+            auto render_time = std::chrono::steady_clock::now() - start;
+            m_stats.renders++;
+            m_stats.last_render_time = render_time;
+            m_stats.last_tick_time = m_input_time + render_time;
+            return;
+        }
+
+        #ifdef SIGWINCH
+        if(terminal_resized) {
+            terminal_resized = 0;
+            m_dirty |= DIRTY_SIZE;
+        }
+        #else
+        // No resize signal here, so poll terminal size
+        const auto [rows, cols] = get_size();
+        if(m_screen->get_w() != cols || m_screen->get_h() != rows) {
+            m_dirty |= DIRTY_SIZE;
+        }
+        #endif
+
+        if(m_dirty == 0) {
+            m_stats.idle_ticks++;
+            m_stats.last_tick_time = m_input_time + (std::chrono::steady_clock::now() - start);
+            return;
         }
-        m_screen_buffer.push_back({out, color});
+
         render_screen();
+        m_dirty = 0;
+
+        auto render_time = std::chrono::steady_clock::now() - start;
+        m_stats.renders++;
+        m_stats.last_render_time = render_time;
+        m_stats.last_tick_time = m_input_time + render_time;
     }
 
-    void Console::print(std::string out) noexcept {
+    const Console::Stats &Console::stats() const noexcept {
+        return m_stats;
+    }
+
+    void Console::print(Color color, std::string_view out) noexcept {
+        if(auto *output = CommandOutput::current()) {
+            output->write(out);
+            return;
+        }
+        m_log_queue.push(color, out);
+    }
+
+    void Console::print(std::string_view out) noexcept {
         print(Color::white, out);
     }
 
+    void Console::printf(Color color, const char *format, ...) noexcept {
+        std::va_list args;
+        va_start(args, format);
+        vprintf(color, format, args);
+        va_end(args);
+    }
+
+    void Console::printf(const char *format, ...) noexcept {
+        std::va_list args;
+        va_start(args, format);
+        vprintf(Color::white, format, args);
+        va_end(args);
+    }
+
+    void Console::vprintf(Color color, const char *format, std::va_list args) noexcept {
+        if(auto *output = CommandOutput::current()) {
+            char buffer[LogQueue::MAX_TEXT_LENGTH];
+            auto length = std::vsnprintf(buffer, sizeof(buffer), format, args);
+            output->write(std::string_view(buffer, std::clamp<int>(length, 0, sizeof(buffer) - 1)));
+            return;
+        }
+
+        auto *record = m_log_queue.reserve();
+        if(!record) {
+            return;
+        }
+        record->color = color;
+        auto length = static_cast<std::size_t>(std::max(std::vsnprintf(record->text, LogQueue::MAX_TEXT_LENGTH, format, args), 0));
+
+        // The terminator takes the last byte, so text filling the record was cut too
+        m_log_queue.commit(record, length < LogQueue::MAX_TEXT_LENGTH ? length : LogQueue::MAX_TEXT_LENGTH + 1);
+    }
+
+    CommandJobs &Console::jobs() noexcept {
+        return m_jobs;
+    }
+
     void Console::clear() noexcept {
-        m_screen_buffer.clear();
-        render_screen();
+        if(m_headless) {
+            return;
+        }
+
+        // Messages queued before clearing go away too
+        drain_log_queue();
+        m_scrollback.clear();
+        m_scroll_offset = 0;
+        m_dirty |= DIRTY_OUTPUT;
+    }
+
+    Console::Color Console::level_color(LogLevel level) noexcept {
+        switch(level) {
+            case LOG_LEVEL_TRACE:
+            case LOG_LEVEL_DEBUG:
+                return Color::gray;
+            case LOG_LEVEL_WARNING:
+                return Color::yellow;
+            case LOG_LEVEL_ERROR:
+                return Color::red;
+            default:
+                return Color::white;
+        }
+    }
+
+    void Console::drain_log_queue() noexcept {
+        auto push_line = [this](std::string_view text, Color color) {
+            if(m_headless) {
+                m_output_buffer.append(m_line_prefix);
+                m_output_buffer.append(text);
+                m_output_buffer.push_back('\n');
+                return;
+            }
+
+            auto rows = m_scrollback.push(text, color);
+
+            // Keep view still while scrolled up
+            if(m_scroll_offset > 0) {
+                m_scroll_offset += rows;
+            }
+            m_dirty |= DIRTY_OUTPUT;
+        };
+
+        const LogQueue::Record *record;
+        char buffer[LogQueue::MAX_TEXT_LENGTH];
+        while((record = m_log_queue.front()) != nullptr) {
+            push_line(LogQueue::text(*record, buffer), record->color);
+            m_log_queue.pop();
+        }
+
+        // Report overload once per tick instead of once per lost message
+        auto dropped = m_log_queue.take_dropped();
+        if(dropped > 0) {
+            m_stats.dropped_messages += dropped;
+            push_line(std::to_string(dropped) + " console messages dropped.", Color::gray);
+        }
+    }
+
+    void Console::open_command_input(const char *command_fifo, bool read_stdin) noexcept {
+        #ifndef _WIN32
+        if(command_fifo) {
+            // Opened for writing too, so the pipe does not hit end of file whenever a writer goes away
+            m_command_fd = open(command_fifo, O_RDWR | O_NONBLOCK);
+            if(m_command_fd < 0) {
+                printf(Color::yellow, "Cannot open command FIFO %s.", command_fifo);
+            }
+            return;
+        }
+
+        // Without a FIFO, commands can be piped to stdin; a terminal or /dev/null gives nothing useful
+        if(read_stdin && !isatty(STDIN_FILENO)) {
+            m_command_fd = STDIN_FILENO;
+            fcntl(m_command_fd, F_SETFL, fcntl(m_command_fd, F_GETFL) | O_NONBLOCK);
+        }
+        #endif
+    }
+
+    void Console::read_command_input() noexcept {
+        #ifndef _WIN32
+        if(m_command_fd < 0) {
+            return;
+        }
+
+        char buffer[1024];
+        while(true) {
+            auto size = ::read(m_command_fd, buffer, sizeof(buffer));
+            if(size == 0) {
+                // Input is over; only stdin gets here
+                m_command_fd = -1;
+                break;
+            }
+            if(size < 0) {
+                break;
+            }
+            m_command_input.append(buffer, size);
+        }
+
+        std::size_t start = 0;
+        std::size_t end;
+        while((end = m_command_input.find('\n', start)) != std::string::npos) {
+            std::string_view line(m_command_input.data() + start, end - start);
+            if(!line.empty() && line.back() == '\r') {
+                line.remove_suffix(1);
+            }
+            if(!line.empty()) {
+                print(Color::gray, std::string("> ").append(line));
+                execute_command(line);
+            }
+            start = end + 1;
+        }
+        m_command_input.erase(0, start);
+        #endif
     }
 
     std::vector<std::string> Console::split_line(std::string str, std::size_t slice_size, bool spacing) noexcept {
@@ -87,6 +338,12 @@ namespace Blamite::Engine {
         return std::move(slices);
     }
 
+    std::size_t Console::scroll_page() const noexcept {
+        // Keep one row of context between pages
+        auto rows = m_screen->get_h();
+        return rows > 3 ? rows - 3 : 1;
+    }
+
     std::pair<int, int> Console::get_size() const noexcept {
         int rows, cols;
         Term::get_term_size(rows, cols);
@@ -167,9 +424,26 @@ namespace Blamite::Engine {
                     break;
                 }
 
+                case Key::TAB: {
+                    complete_command();
+                    break;
+                }
+
+                case Key::PAGE_UP: {
+                    m_scroll_offset += scroll_page();
+                    break;
+                }
+
+                case Key::PAGE_DOWN: {
+                    auto page = scroll_page();
+                    m_scroll_offset = m_scroll_offset > page ? m_scroll_offset - page : 0;
+                    break;
+                }
+
                 case Key::ENTER: {
                     if(!m_input_buffer.empty()) {
                         result = m_input_buffer;
+                        m_scroll_offset = 0;
 
                         // Erase current history entry if is
                         if(m_history_pos != m_commands_history_buffer.size() - 1) {
@@ -203,8 +477,8 @@ namespace Blamite::Engine {
     void Console::render_screen() noexcept {
         const auto [rows, cols] = get_size();
 
-        // Resize buffer if terminal width has changed
-        if(m_screen->get_w() != cols) {
+        // Resize buffer if terminal size has changed
+        if(m_screen->get_w() != cols || m_screen->get_h() != rows) {
             m_screen = std::make_unique<Term::Window>(cols, rows);
         }
 
@@ -240,31 +514,42 @@ namespace Blamite::Engine {
             m_screen->fill_style(prompt.length() + 1, current_row, cols, current_row, Style::reset);
         }
 
-        std::vector<ScreenBufferLine> screen_buffer_lines;
-        std::size_t screen_buffer_max_rows = rows - screen_input_lines.size();
-        for(std::size_t i = 0; i < m_screen_buffer.size() && i < screen_buffer_max_rows; i++) {
-            auto line = m_screen_buffer.rbegin() + i;
-            auto splitted_line = split_line(line->text, cols, true);
-            
-            auto line_it = splitted_line.rbegin();
-            while(line_it != splitted_line.rend()) {
-                screen_buffer_lines.insert(screen_buffer_lines.begin(), {*line_it, line->color});
-                line_it++;
+        // Show the rest of the matching command name after the input
+        auto suggestion = input_suggestion();
+        if(!suggestion.empty() && screen_input_lines.size() == 1) {
+            auto column = c_prompt.length() + m_input_buffer.length() + 1;
+            suggestion = suggestion.substr(0, cols - column + 1);
+            if(!suggestion.empty()) {
+                m_screen->print_str(column, rows, std::string(suggestion));
+                m_screen->fill_fg(column, rows, column + suggestion.length() - 1, rows, Color::gray);
             }
         }
 
-        auto screen_buffer_lines_bottom = screen_buffer_lines.rbegin();
-        for(std::size_t i = 0; i < screen_buffer_max_rows; i++) {
-            int current_row = screen_buffer_max_rows - i;
-            
-            if(screen_buffer_lines_bottom != screen_buffer_lines.rend() && screen_buffer_lines_bottom + i < screen_buffer_lines.rend()) {
-                auto line = screen_buffer_lines_bottom + i;
-                m_screen->print_str(1, current_row, line->text + std::string(cols - line->text.length(), ' '));
-                m_screen->fill_fg(1, current_row, line->text.length(), current_row, line->color);
-            }
-            else {
-                m_screen->print_str(1, current_row, std::string(cols, ' '));
+        // Output rows, bottom up from the scroll position
+        std::size_t output_rows = rows - screen_input_lines.size();
+        m_scrollback.set_width(cols);
+        auto total_rows = m_scrollback.total_rows();
+        auto max_scroll = total_rows > output_rows ? total_rows - output_rows : 0;
+        m_scroll_offset = std::min(m_scroll_offset, max_scroll);
+        auto bottom_row = total_rows - m_scroll_offset;
+
+        std::string row_text;
+        for(std::size_t i = 0; i < output_rows; i++) {
+            int current_row = output_rows - i;
+
+            row_text.clear();
+            if(i < bottom_row) {
+                auto row = m_scrollback.row(bottom_row - 1 - i);
+                if(row.continuation) {
+                    row_text.append(Scrollback::CONTINUATION_INDENT, ' '); // Insert spacing before secondary lines
+                }
+                row_text.append(row.text);
+                if(!row_text.empty()) {
+                    m_screen->fill_fg(1, current_row, row_text.length(), current_row, row.color);
+                }
             }
+            row_text.append(cols - row_text.length(), ' ');
+            m_screen->print_str(1, current_row, row_text);
         }
 
         m_screen->set_cursor_pos(c_prompt.length() + screen_cursor_col, rows - screen_input_lines.size() + screen_cursor_row + 1);
@@ -273,50 +558,133 @@ namespace Blamite::Engine {
         std::cout << m_screen->render(1, 1, m_term_attached) << std::flush;
     }
 
-    void Console::execute_command(std::string command) noexcept {
-        std::string name = command.substr(0, command.find(' '));
-        std::string args;
-        if(command.length() > name.length()) {
-             args = command.substr(name.size() + 1);
+    void Console::execute_command(std::string_view line, std::shared_ptr<CommandOutput> output) noexcept {
+        // Buffers keep their storage between commands, so dispatching does not allocate
+        m_command_line.assign(line);
+        ConsoleCommand::split_arguments(m_command_line, m_command_arguments);
+
+        // Prints from here on go to the requester's output, if any
+        CommandOutput::set_current(output.get());
+        bool handed_off = false;
+
+        auto *command = m_command_arguments.empty() ? nullptr : m_commands.find(m_command_arguments.front());
+        if(m_command_arguments.empty()) {
+            // Nothing to run
         }
-        
-        auto it = m_commands.begin();
-        while(it != m_commands.end()) {
-            auto &command = *it;
-            if(command->name() == name) {
-                using Result = ConsoleCommand::Result;
-                switch(command->execute(args)) {
-                    case Result::COMMAND_RESULT_NOT_ENOUGH_ARGUMENTS:
-                        printf(Color::gray, "Not enough arguments in \"%s\" command.", name.c_str());
-                        break;
-
-                    case Result::COMMAND_RESULT_TOO_MANY_ARGUMENTS: 
-                        printf(Color::gray, "Too many arguments in \"%s\" command.", name.c_str());
-                        break;
-
-                    default:
-                        break;
-                }
+        else if(!command) {
+            printf(Color::gray, "Requested command \"%s\" cannot be executed now.", m_command_arguments.front().data());
+        }
+        else if(command->run_in_background()) {
+            // Slow commands go to workers, which finish the output
+            auto id = m_jobs.submit(*command, line, output);
+            printf(Color::gray, "Command \"%s\" running in background as job %u.", command->name().c_str(), id);
+            handed_off = true;
+        }
+        else {
+            m_command_arguments.erase(m_command_arguments.begin());
+            report_result(*command, command->execute(m_command_arguments));
+        }
+
+        CommandOutput::set_current(nullptr);
+        if(output && !handed_off) {
+            output->finish();
+        }
+    }
+
+    void Console::execute(std::string_view line, std::shared_ptr<CommandOutput> output) noexcept {
+        std::lock_guard<std::mutex> lock(m_queued_commands_mutex);
+        m_queued_commands.push_back({std::string(line), std::move(output)});
+    }
+
+    void Console::report_result(const ConsoleCommand &command, ConsoleCommand::Result result) noexcept {
+        using Result = ConsoleCommand::Result;
+        switch(result) {
+            case Result::COMMAND_RESULT_NOT_ENOUGH_ARGUMENTS:
+                printf(Color::gray, "Not enough arguments in \"%s\" command.", command.name().c_str());
+                break;
+
+            case Result::COMMAND_RESULT_TOO_MANY_ARGUMENTS: 
+                printf(Color::gray, "Too many arguments in \"%s\" command.", command.name().c_str());
+                break;
+
+            default:
                 break;
+        }
+    }
+
+    void Console::complete_command() noexcept {
+        // Only command names are completed
+        if(m_input_buffer.find(' ') != std::string::npos) {
+            return;
+        }
+
+        auto prefix = m_commands.common_prefix(m_input_buffer);
+        if(prefix.empty()) {
+            return;
+        }
+
+        if(prefix.size() > m_input_buffer.size()) {
+            m_input_buffer.assign(prefix);
+        }
+        else {
+            // Nothing to add; list candidates like a shell would
+            std::vector<std::string_view> names;
+            m_commands.complete(prefix, names, c_max_completions + 1);
+            if(names.size() > 1) {
+                std::string list;
+                for(std::size_t i = 0; i < names.size() && i < c_max_completions; i++) {
+                    list.append(names[i]).append("  ");
+                }
+                if(names.size() > c_max_completions) {
+                    list.append("...");
+                }
+                print(Color::gray, list);
             }
-            it++;
         }
 
-        if(it == m_commands.end()) {
-            printf(Color::gray, "Requested command \"%s\" cannot be executed now.", name.c_str());
+        // A complete name gets its separator
+        if(m_commands.find(m_input_buffer)) {
+            m_input_buffer.push_back(' ');
+        }
+        m_input_cursor_pos = m_input_buffer.length() + 1;
+    }
+
+    std::string_view Console::input_suggestion() const noexcept {
+        if(m_input_buffer.empty() || m_input_buffer.find(' ') != std::string::npos || m_input_cursor_pos != m_input_buffer.length() + 1) {
+            return {};
+        }
+
+        // Suggest what the first match would add
+        std::vector<std::string_view> &names = m_suggestions;
+        m_commands.complete(m_input_buffer, names, 1);
+        if(names.empty()) {
+            return {};
         }
+        return names.front().substr(m_input_buffer.size());
     }
 
     void Console::register_commands() noexcept {
         #define EXTERN_FN(command_name) ({ \
-            extern bool command_name(std::vector<std::string> &) noexcept; \
+            extern bool command_name(ConsoleCommand::arguments_t &) noexcept; \
             command_name; \
         })
 
         #define REGISTER_COMMAND(name, min_args, max_args, function) \
-            this->m_commands.emplace_back(std::make_unique<ConsoleCommand>(name, min_args, max_args, EXTERN_FN(function)))
+            this->m_commands.add(std::make_unique<ConsoleCommand>(name, min_args, max_args, EXTERN_FN(function)))
+
+        #define REGISTER_BACKGROUND_COMMAND(name, min_args, max_args, function) \
+            this->m_commands.add(std::make_unique<ConsoleCommand>(name, min_args, max_args, EXTERN_FN(function), true))
 
         REGISTER_COMMAND("quit", 0, 0, quit_command);
         REGISTER_COMMAND("ticks", 0, 0, ticks_command);
+        REGISTER_COMMAND("tick_rate", 0, 2, tick_rate_command);
+        REGISTER_COMMAND("clients", 0, 0, clients_command);
+        REGISTER_COMMAND("client_bandwidth", 0, 1, client_bandwidth_command);
+        REGISTER_COMMAND("path_mtu", 0, 1, path_mtu_command);
+        REGISTER_COMMAND("capture", 0, 3, capture_command);
+        REGISTER_COMMAND("trace", 0, 3, trace_command);
+        REGISTER_COMMAND("jobs", 0, 0, jobs_command);
+        REGISTER_COMMAND("cancel", 1, 1, cancel_command);
+        REGISTER_BACKGROUND_COMMAND("wait", 1, 1, wait_command);
     }
 }
@@ -0,0 +1,101 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <cstring>
+#include <algorithm>
+#include <blamite/console/log_queue.hpp>
+
+namespace Blamite::Engine {
+    LogQueue::Record *LogQueue::reserve() noexcept {
+        auto position = m_enqueue_position.load(std::memory_order_relaxed);
+        while(true) {
+            auto &cell = m_cells[position & m_mask];
+            auto sequence = cell.sequence.load(std::memory_order_acquire);
+            auto difference = static_cast<std::ptrdiff_t>(sequence - position);
+
+            // Cell is free on this lap; try to claim it
+            if(difference == 0) {
+                if(m_enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    return &cell.record;
+                }
+            }
+            // Consumer has not released this cell yet, so the queue is full
+            else if(difference < 0) {
+                m_dropped.fetch_add(1, std::memory_order_relaxed);
+                return nullptr;
+            }
+            // Another producer claimed it first
+            else {
+                position = m_enqueue_position.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    void LogQueue::commit(Record *record, std::size_t length) noexcept {
+        if(length > MAX_TEXT_LENGTH) {
+            std::memcpy(record->text + MAX_TEXT_LENGTH - 3, "...", 3);
+            length = MAX_TEXT_LENGTH;
+        }
+        record->formatter = nullptr;
+        record->length = length;
+        publish(record);
+    }
+
+    void LogQueue::publish(Record *record) noexcept {
+        auto *cell = reinterpret_cast<Cell *>(record);
+        cell->sequence.store(cell->sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    bool LogQueue::push(Term::fg color, std::string_view text) noexcept {
+        auto *record = reserve();
+        if(!record) {
+            return false;
+        }
+        record->color = color;
+        std::memcpy(record->text, text.data(), std::min(text.size(), sizeof(record->text)));
+        commit(record, text.size());
+        return true;
+    }
+
+    std::string_view LogQueue::text(const Record &record, char *buffer) noexcept {
+        if(!record.formatter) {
+            return std::string_view(record.text, record.length);
+        }
+
+        auto length = record.formatter(record.text, buffer, MAX_TEXT_LENGTH);
+        if(length >= MAX_TEXT_LENGTH) {
+            std::memcpy(buffer + MAX_TEXT_LENGTH - 4, "...", 3);
+            length = MAX_TEXT_LENGTH - 1;
+        }
+        return std::string_view(buffer, length);
+    }
+
+    const LogQueue::Record *LogQueue::front() noexcept {
+        auto &cell = m_cells[m_dequeue_position & m_mask];
+        if(cell.sequence.load(std::memory_order_acquire) != m_dequeue_position + 1) {
+            return nullptr;
+        }
+        return &cell.record;
+    }
+
+    void LogQueue::pop() noexcept {
+        auto &cell = m_cells[m_dequeue_position & m_mask];
+        cell.sequence.store(m_dequeue_position + m_mask + 1, std::memory_order_release);
+        m_dequeue_position++;
+    }
+
+    std::size_t LogQueue::take_dropped() noexcept {
+        return m_dropped.exchange(0, std::memory_order_relaxed);
+    }
+
+    LogQueue::LogQueue(std::size_t capacity) noexcept {
+        std::size_t size = 1;
+        while(size < capacity) {
+            size <<= 1;
+        }
+        m_cells = std::make_unique<Cell[]>(size);
+        m_mask = size - 1;
+        for(std::size_t i = 0; i < size; i++) {
+            m_cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+}
@@ -0,0 +1,106 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <algorithm>
+#include <blamite/console/scrollback.hpp>
+
+namespace Blamite::Engine {
+    std::size_t Scrollback::push(std::string_view text, Term::fg color) noexcept {
+        Line *line;
+        if(m_count < m_capacity) {
+            auto index = (m_start + m_count) % m_capacity;
+            if(index == m_lines.size()) {
+                m_lines.emplace_back();
+            }
+            line = &m_lines[index];
+            m_count++;
+        }
+        else {
+            // Overwrite oldest line, keeping its string storage
+            line = &m_lines[m_start];
+            m_start = (m_start + 1) % m_capacity;
+        }
+
+        line->text.assign(text);
+        line->color = color;
+        line->first_row = m_next_row;
+        line->rows = count_rows(text.size());
+        m_next_row += line->rows;
+        return line->rows;
+    }
+
+    void Scrollback::clear() noexcept {
+        m_start = 0;
+        m_count = 0;
+        m_next_row = 0;
+    }
+
+    void Scrollback::set_width(std::size_t width) noexcept {
+        width = std::max<std::size_t>(width, CONTINUATION_INDENT + 1);
+        if(width == m_width) {
+            return;
+        }
+
+        m_width = width;
+        m_next_row = 0;
+        for(std::size_t i = 0; i < m_count; i++) {
+            auto &entry = m_lines[(m_start + i) % m_capacity];
+            entry.first_row = m_next_row;
+            entry.rows = count_rows(entry.text.size());
+            m_next_row += entry.rows;
+        }
+    }
+
+    std::size_t Scrollback::size() const noexcept {
+        return m_count;
+    }
+
+    std::size_t Scrollback::total_rows() const noexcept {
+        return m_count > 0 ? m_next_row - line(0).first_row : 0;
+    }
+
+    Scrollback::Row Scrollback::row(std::size_t index) const noexcept {
+        if(index >= total_rows()) {
+            return {{}, Term::fg::reset, false};
+        }
+
+        // Find last line starting at or before the row
+        auto row_number = line(0).first_row + index;
+        std::size_t low = 0;
+        std::size_t high = m_count - 1;
+        while(low < high) {
+            auto middle = (low + high + 1) / 2;
+            if(line(middle).first_row <= row_number) {
+                low = middle;
+            }
+            else {
+                high = middle - 1;
+            }
+        }
+
+        auto &entry = line(low);
+        std::string_view text = entry.text;
+        auto part = row_number - entry.first_row;
+        if(part == 0) {
+            return {text.substr(0, m_width), entry.color, false};
+        }
+        auto slice_size = m_width - CONTINUATION_INDENT;
+        return {text.substr(m_width + (part - 1) * slice_size, slice_size), entry.color, true};
+    }
+
+    Scrollback::Scrollback(std::size_t capacity, std::size_t width) noexcept {
+        m_capacity = std::max<std::size_t>(capacity, 1);
+        m_width = std::max<std::size_t>(width, CONTINUATION_INDENT + 1);
+    }
+
+    const Scrollback::Line &Scrollback::line(std::size_t index) const noexcept {
+        return m_lines[(m_start + index) % m_capacity];
+    }
+
+    std::uint32_t Scrollback::count_rows(std::size_t length) const noexcept {
+        if(length <= m_width) {
+            return 1;
+        }
+        auto slice_size = m_width - CONTINUATION_INDENT;
+        return 1 + (length - m_width + slice_size - 1) / slice_size;
+    }
+}
@@ -0,0 +1,191 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <utility>
+#include <stdexcept>
+#include <blamite/core/event_log.hpp>
+
+namespace Blamite::Engine {
+    static std::uint64_t unix_time_us() noexcept {
+        auto now = std::chrono::system_clock::now().time_since_epoch();
+        return std::chrono::duration_cast<std::chrono::microseconds>(now).count();
+    }
+
+    const char *disconnect_reason_name(DisconnectReason reason) noexcept {
+        switch(reason) {
+            case DISCONNECT_REASON_CLIENT:
+                return "client";
+            case DISCONNECT_REASON_TIMEOUT:
+                return "timeout";
+            case DISCONNECT_REASON_HANDSHAKE_TIMEOUT:
+                return "handshake timeout";
+            case DISCONNECT_REASON_SHUTDOWN:
+                return "shutdown";
+            default:
+                return "unknown";
+        }
+    }
+
+    const char *event_type_name(EventType type) noexcept {
+        switch(type) {
+            case EVENT_TYPE_CONNECT:
+                return "connect";
+            case EVENT_TYPE_REFUSE:
+                return "refuse";
+            case EVENT_TYPE_DISCONNECT:
+                return "disconnect";
+            case EVENT_TYPE_TICK_STATS:
+                return "tick";
+            case EVENT_TYPE_DROPPED:
+                return "dropped";
+            default:
+                return "unknown";
+        }
+    }
+
+    void EventLog::write(EventType type, const void *payload, std::uint16_t size) noexcept {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if(m_pending.size() + sizeof(EventHeader) + size > c_max_pending_size) {
+            m_unreported_drops++;
+            m_stats.dropped_records++;
+            return;
+        }
+
+        append(m_pending, type, payload, size);
+        if(m_pending.size() >= c_flush_size) {
+            m_wake.notify_one();
+        }
+    }
+
+    EventLog::Stats EventLog::stats() noexcept {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_stats;
+    }
+
+    const std::string &EventLog::path() const noexcept {
+        return m_path;
+    }
+
+    EventLog::EventLog(std::string path, std::size_t max_file_size, std::size_t max_files) : m_path(std::move(path)) {
+        m_max_file_size = max_file_size;
+        m_max_files = std::max<std::size_t>(max_files, 1);
+
+        // Never append to a file from another run
+        auto *existing = std::fopen(m_path.c_str(), "rb");
+        if(existing) {
+            std::fclose(existing);
+            rotate();
+        }
+        else {
+            open_file();
+        }
+
+        if(!m_file) {
+            throw std::runtime_error("Failed to create event log " + m_path + ": " + std::strerror(errno));
+        }
+
+        m_pending.reserve(c_flush_size * 2);
+        m_writing.reserve(c_flush_size * 2);
+        m_writer = std::thread(&EventLog::writer_loop, this);
+    }
+
+    EventLog::~EventLog() noexcept {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_wake.notify_one();
+        m_writer.join();
+
+        if(m_file) {
+            std::fclose(m_file);
+        }
+    }
+
+    void EventLog::writer_loop() noexcept {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while(true) {
+            m_wake.wait_for(lock, c_flush_interval, [this]() {
+                return m_stop || m_pending.size() >= c_flush_size;
+            });
+
+            std::swap(m_pending, m_writing);
+            auto drops = std::exchange(m_unreported_drops, 0);
+            auto stop = m_stop;
+            lock.unlock();
+
+            if(drops > 0) {
+                DroppedEvent event = {drops};
+                append(m_writing, DroppedEvent::TYPE, &event, sizeof(event));
+            }
+            auto written = write_out();
+            auto rotated = m_file_size >= m_max_file_size && rotate();
+
+            lock.lock();
+            m_stats.written_bytes += written;
+            m_stats.rotations += rotated;
+            if(stop) {
+                return;
+            }
+        }
+    }
+
+    void EventLog::append(std::vector<std::byte> &buffer, EventType type, const void *payload, std::uint16_t size) noexcept {
+        EventHeader header;
+        header.type = type;
+        header.size = size;
+        header.time = unix_time_us();
+
+        auto offset = buffer.size();
+        buffer.resize(offset + sizeof(header) + size);
+        std::memcpy(buffer.data() + offset, &header, sizeof(header));
+        std::memcpy(buffer.data() + offset + sizeof(header), payload, size);
+    }
+
+    std::size_t EventLog::write_out() noexcept {
+        std::size_t written = 0;
+        if(m_file && !m_writing.empty()) {
+            written = std::fwrite(m_writing.data(), 1, m_writing.size(), m_file);
+            std::fflush(m_file);
+            m_file_size += written;
+        }
+        m_writing.clear();
+        return written;
+    }
+
+    bool EventLog::rotate() noexcept {
+        if(m_file) {
+            std::fclose(m_file);
+            m_file = nullptr;
+        }
+
+        // Oldest file goes away, the rest shift up by one
+        std::remove(rotated_path(m_max_files - 1).c_str());
+        for(auto index = m_max_files - 1; index > 0; index--) {
+            std::rename(rotated_path(index - 1).c_str(), rotated_path(index).c_str());
+        }
+
+        return open_file();
+    }
+
+    bool EventLog::open_file() noexcept {
+        m_file = std::fopen(m_path.c_str(), "wb");
+        if(!m_file) {
+            return false;
+        }
+
+        EventLogHeader header;
+        std::memcpy(header.magic, EventLogHeader::MAGIC, sizeof(header.magic));
+        header.version = EventLogHeader::VERSION;
+        header.start_time = unix_time_us();
+        m_file_size = std::fwrite(&header, 1, sizeof(header), m_file);
+        std::fflush(m_file);
+        return true;
+    }
+
+    std::string EventLog::rotated_path(std::size_t index) const {
+        return index == 0 ? m_path : m_path + "." + std::to_string(index);
+    }
+}
@@ -0,0 +1,280 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <string>
+#include <algorithm>
+#include <blamite/core/job_system.hpp>
+#include <blamite/core/trace.hpp>
+
+namespace Blamite::Engine {
+    namespace {
+        /** Job system the calling thread works for */
+        thread_local const JobSystem *current_system = nullptr;
+
+        /** Worker of the calling thread */
+        thread_local void *current_worker_state = nullptr;
+
+        /** Victim picking state */
+        thread_local std::uint32_t steal_seed = 0x9E3779B9;
+    }
+
+    TaskGraph::task_id_t TaskGraph::add_range(std::size_t count, std::size_t grain, const function_t &function, std::initializer_list<task_id_t> dependencies) noexcept {
+        grain = std::max<std::size_t>(grain, 1);
+        task_id_t first_chunk = m_size;
+        for(std::size_t begin = 0; begin < count; begin += grain) {
+            add_task(function, begin, std::min(begin + grain, count), dependencies);
+        }
+
+        // Empty ranges still wait for their dependencies
+        auto join = add_task(nullptr, 0, 0, count == 0 ? dependencies : std::initializer_list<task_id_t>{});
+        for(auto chunk = first_chunk; chunk < join; chunk++) {
+            add_dependency(join, chunk);
+        }
+        return join;
+    }
+
+    void TaskGraph::clear() noexcept {
+        m_size = 0;
+    }
+
+    std::size_t TaskGraph::size() const noexcept {
+        return m_size;
+    }
+
+    TaskGraph::task_id_t TaskGraph::add_task(function_t function, std::size_t begin, std::size_t end, std::initializer_list<task_id_t> dependencies) noexcept {
+        if(m_size == m_tasks.size()) {
+            m_tasks.push_back(std::make_unique<Task>());
+        }
+
+        task_id_t id = m_size++;
+        auto &task = *m_tasks[id];
+        task.function = std::move(function);
+        task.begin = begin;
+        task.end = end;
+        task.successors.clear();
+        task.dependencies = 0;
+        task.graph = this;
+
+        for(auto dependency : dependencies) {
+            add_dependency(id, dependency);
+        }
+        return id;
+    }
+
+    void TaskGraph::add_dependency(task_id_t task, task_id_t dependency) noexcept {
+        if(dependency >= task) {
+            return;
+        }
+        m_tasks[dependency]->successors.push_back(task);
+        m_tasks[task]->dependencies++;
+    }
+
+    void JobSystem::run(TaskGraph &graph) noexcept {
+        if(graph.m_size == 0) {
+            return;
+        }
+
+        graph.m_remaining.store(graph.m_size, std::memory_order_relaxed);
+        for(std::size_t i = 0; i < graph.m_size; i++) {
+            auto &task = *graph.m_tasks[i];
+            task.pending.store(task.dependencies, std::memory_order_relaxed);
+        }
+        for(std::size_t i = 0; i < graph.m_size; i++) {
+            auto *task = graph.m_tasks[i].get();
+            if(task->dependencies == 0) {
+                schedule(task);
+            }
+        }
+
+        // Help instead of blocking; the task found may belong to another graph, which is fine
+        auto *self = current_worker();
+        while(graph.m_remaining.load(std::memory_order_acquire) > 0) {
+            auto *task = find_task(self);
+            if(task) {
+                execute(task);
+            }
+            else {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    std::size_t JobSystem::workers_count() const noexcept {
+        return m_workers.size();
+    }
+
+    JobSystem::JobSystem(std::size_t workers) noexcept {
+        for(std::size_t i = 0; i < workers; i++) {
+            m_workers.push_back(std::make_unique<Worker>());
+        }
+        for(auto &worker : m_workers) {
+            worker->thread = std::thread(&JobSystem::work, this, std::ref(*worker));
+        }
+    }
+
+    JobSystem::~JobSystem() noexcept {
+        {
+            std::lock_guard<std::mutex> lock(m_sleep_mutex);
+            m_stopping = true;
+        }
+        m_wake.notify_all();
+
+        for(auto &worker : m_workers) {
+            worker->thread.join();
+        }
+    }
+
+    bool JobSystem::Deque::push(Task *task) noexcept {
+        auto bottom = m_bottom.load(std::memory_order_relaxed);
+        auto top = m_top.load(std::memory_order_acquire);
+        if(bottom - top >= c_capacity) {
+            return false;
+        }
+        m_tasks[bottom & (c_capacity - 1)].store(task, std::memory_order_relaxed);
+        m_bottom.store(bottom + 1, std::memory_order_release);
+        return true;
+    }
+
+    JobSystem::Task *JobSystem::Deque::pop() noexcept {
+        auto bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+        m_bottom.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        auto top = m_top.load(std::memory_order_relaxed);
+
+        if(top > bottom) {
+            // Empty
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        auto *task = m_tasks[bottom & (c_capacity - 1)].load(std::memory_order_relaxed);
+        if(top == bottom) {
+            // Last task; race thieves for it
+            if(!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                task = nullptr;
+            }
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+        }
+        return task;
+    }
+
+    JobSystem::Task *JobSystem::Deque::steal() noexcept {
+        auto top = m_top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        auto bottom = m_bottom.load(std::memory_order_acquire);
+        if(top >= bottom) {
+            return nullptr;
+        }
+
+        auto *task = m_tasks[top & (c_capacity - 1)].load(std::memory_order_relaxed);
+        if(!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return nullptr;
+        }
+        return task;
+    }
+
+    void JobSystem::work(Worker &self) noexcept {
+        current_system = this;
+        current_worker_state = &self;
+
+        auto index = std::find_if(m_workers.begin(), m_workers.end(), [&self](auto &worker) {
+            return worker.get() == &self;
+        }) - m_workers.begin();
+        Tracer::get().set_thread_name("worker " + std::to_string(index));
+
+        std::size_t misses = 0;
+        while(!m_stopping.load(std::memory_order_relaxed)) {
+            auto *task = find_task(&self);
+            if(task) {
+                execute(task);
+                misses = 0;
+                continue;
+            }
+
+            if(++misses < c_spin_count) {
+                std::this_thread::yield();
+                continue;
+            }
+
+            // Nothing to do for a while; sleep until something is queued
+            std::unique_lock<std::mutex> lock(m_sleep_mutex);
+            m_sleeping.fetch_add(1);
+            m_wake.wait(lock, [this]() {
+                return m_queued.load() > 0 || m_stopping.load();
+            });
+            m_sleeping.fetch_sub(1);
+            misses = 0;
+        }
+    }
+
+    void JobSystem::schedule(Task *task) noexcept {
+        // Counted before it can be taken, so the count never drops below zero
+        m_queued.fetch_add(1);
+
+        auto *self = current_worker();
+        if(!self || !self->deque.push(task)) {
+            std::lock_guard<std::mutex> lock(m_injected_mutex);
+            m_injected.push_back(task);
+        }
+
+        // Paired with the sleeping count and check in work(), so a worker going to sleep sees this task or is woken
+        if(m_sleeping.load() > 0) {
+            std::lock_guard<std::mutex> lock(m_sleep_mutex);
+            m_wake.notify_one();
+        }
+    }
+
+    JobSystem::Task *JobSystem::find_task(Worker *self) noexcept {
+        Task *task = nullptr;
+        if(self) {
+            task = self->deque.pop();
+        }
+
+        if(!task && m_queued.load(std::memory_order_relaxed) > 0) {
+            std::lock_guard<std::mutex> lock(m_injected_mutex);
+            if(!m_injected.empty()) {
+                task = m_injected.front();
+                m_injected.pop_front();
+            }
+        }
+
+        // Steal from the others, starting at a random one so thieves spread out
+        if(!task && !m_workers.empty()) {
+            steal_seed ^= steal_seed << 13;
+            steal_seed ^= steal_seed >> 17;
+            steal_seed ^= steal_seed << 5;
+            auto start = steal_seed % m_workers.size();
+            for(std::size_t i = 0; i < m_workers.size() && !task; i++) {
+                auto &victim = *m_workers[(start + i) % m_workers.size()];
+                if(&victim != self) {
+                    task = victim.deque.steal();
+                }
+            }
+        }
+
+        if(task) {
+            m_queued.fetch_sub(1, std::memory_order_relaxed);
+        }
+        return task;
+    }
+
+    void JobSystem::execute(Task *task) noexcept {
+        if(task->function) {
+            task->function(task->begin, task->end);
+        }
+
+        auto &graph = *task->graph;
+        for(auto successor : task->successors) {
+            auto *next = graph.m_tasks[successor].get();
+            if(next->pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                schedule(next);
+            }
+        }
+
+        // Last thing touching the graph, which the waiting thread may reuse as soon as this hits zero
+        graph.m_remaining.fetch_sub(1, std::memory_order_release);
+    }
+
+    JobSystem::Worker *JobSystem::current_worker() noexcept {
+        return current_system == this ? static_cast<Worker *>(current_worker_state) : nullptr;
+    }
+}
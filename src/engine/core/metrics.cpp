@@ -0,0 +1,154 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <cstdio>
+#include <algorithm>
+#include <blamite/core/metrics.hpp>
+
+namespace Blamite::Engine {
+    namespace {
+        /**
+         * Append a sample line
+         */
+        void append_sample(std::string &output, const std::string &name, const char *suffix, const std::string &labels, const char *value) noexcept {
+            output += name;
+            output += suffix;
+            if(!labels.empty()) {
+                output += '{';
+                output += labels;
+                output += '}';
+            }
+            output += ' ';
+            output += value;
+            output += '\n';
+        }
+    }
+
+    std::uint64_t Counter::value() const noexcept {
+        std::uint64_t total = 0;
+        for(auto &shard : m_shards) {
+            total += shard.value.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    void Histogram::observe(double value) noexcept {
+        std::size_t bucket = 0;
+        while(bucket < m_bounds_count && value > m_bounds[bucket]) {
+            bucket++;
+        }
+
+        auto &shard = m_shards[metric_shard()];
+        shard.counts[bucket].fetch_add(1, std::memory_order_relaxed);
+
+        // No fetch_add for doubles; the shard is rarely shared, so this hardly ever loops
+        auto sum = shard.sum.load(std::memory_order_relaxed);
+        while(!shard.sum.compare_exchange_weak(sum, sum + value, std::memory_order_relaxed)) {}
+    }
+
+    Histogram::Snapshot Histogram::snapshot() const noexcept {
+        Snapshot snapshot;
+        snapshot.bounds.assign(m_bounds.begin(), m_bounds.begin() + m_bounds_count);
+        snapshot.counts.assign(m_bounds_count + 1, 0);
+        snapshot.sum = 0.0;
+        for(auto &shard : m_shards) {
+            for(std::size_t i = 0; i <= m_bounds_count; i++) {
+                snapshot.counts[i] += shard.counts[i].load(std::memory_order_relaxed);
+            }
+            snapshot.sum += shard.sum.load(std::memory_order_relaxed);
+        }
+        return snapshot;
+    }
+
+    Histogram::Histogram(const std::vector<double> &bounds) noexcept {
+        m_bounds_count = std::min(bounds.size(), MAX_BUCKETS);
+        std::copy(bounds.begin(), bounds.begin() + m_bounds_count, m_bounds.begin());
+    }
+
+    Counter &Metrics::counter(const std::string &name, const std::string &help, const std::string &labels) noexcept {
+        Entry entry = {name, help, labels, TYPE_COUNTER};
+        entry.counter = std::make_unique<Counter>();
+        auto &reference = *entry.counter;
+        add(std::move(entry));
+        return reference;
+    }
+
+    Gauge &Metrics::gauge(const std::string &name, const std::string &help, const std::string &labels) noexcept {
+        Entry entry = {name, help, labels, TYPE_GAUGE};
+        entry.gauge = std::make_unique<Gauge>();
+        auto &reference = *entry.gauge;
+        add(std::move(entry));
+        return reference;
+    }
+
+    Histogram &Metrics::histogram(const std::string &name, const std::string &help, const std::vector<double> &bounds, const std::string &labels) noexcept {
+        Entry entry = {name, help, labels, TYPE_HISTOGRAM};
+        entry.histogram = std::make_unique<Histogram>(bounds);
+        auto &reference = *entry.histogram;
+        add(std::move(entry));
+        return reference;
+    }
+
+    std::string Metrics::render() const noexcept {
+        static constexpr const char *type_names[] = {"counter", "gauge", "histogram"};
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::string output;
+        output.reserve(m_entries.size() * 128);
+        std::vector<bool> rendered(m_entries.size(), false);
+        char value[64];
+
+        // Samples of a metric must be together, under a single HELP and TYPE
+        for(std::size_t i = 0; i < m_entries.size(); i++) {
+            if(rendered[i]) {
+                continue;
+            }
+            auto &family = m_entries[i];
+            output += "# HELP " + family.name + " " + family.help + "\n";
+            output += "# TYPE " + family.name + " " + type_names[family.type] + "\n";
+
+            for(std::size_t j = i; j < m_entries.size(); j++) {
+                auto &entry = m_entries[j];
+                if(rendered[j] || entry.name != family.name) {
+                    continue;
+                }
+                rendered[j] = true;
+
+                if(entry.type == TYPE_COUNTER) {
+                    std::snprintf(value, sizeof(value), "%llu", static_cast<unsigned long long>(entry.counter->value()));
+                    append_sample(output, entry.name, "", entry.labels, value);
+                }
+                else if(entry.type == TYPE_GAUGE) {
+                    std::snprintf(value, sizeof(value), "%lld", static_cast<long long>(entry.gauge->value()));
+                    append_sample(output, entry.name, "", entry.labels, value);
+                }
+                else {
+                    auto snapshot = entry.histogram->snapshot();
+                    auto separator = entry.labels.empty() ? "" : ",";
+                    std::uint64_t cumulative = 0;
+                    for(std::size_t bucket = 0; bucket < snapshot.counts.size(); bucket++) {
+                        cumulative += snapshot.counts[bucket];
+                        char labels[64];
+                        if(bucket < snapshot.bounds.size()) {
+                            std::snprintf(labels, sizeof(labels), "%sle=\"%g\"", separator, snapshot.bounds[bucket]);
+                        }
+                        else {
+                            std::snprintf(labels, sizeof(labels), "%sle=\"+Inf\"", separator);
+                        }
+                        std::snprintf(value, sizeof(value), "%llu", static_cast<unsigned long long>(cumulative));
+                        append_sample(output, entry.name, "_bucket", entry.labels + labels, value);
+                    }
+                    std::snprintf(value, sizeof(value), "%.9g", snapshot.sum);
+                    append_sample(output, entry.name, "_sum", entry.labels, value);
+                    std::snprintf(value, sizeof(value), "%llu", static_cast<unsigned long long>(cumulative));
+                    append_sample(output, entry.name, "_count", entry.labels, value);
+                }
+            }
+        }
+        return output;
+    }
+
+    void Metrics::add(Entry entry) noexcept {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_entries.push_back(std::move(entry));
+    }
+}
@@ -0,0 +1,148 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <algorithm>
+#include <blamite/core/timer_wheel.hpp>
+
+namespace Blamite::Engine {
+    TimerWheel::Handle TimerWheel::schedule(timer_tick_t delay, callback_t callback) noexcept {
+        std::uint32_t index;
+        if(m_free_head != c_null) {
+            index = m_free_head;
+            m_free_head = m_timers[index].next;
+        }
+        else {
+            index = m_timers.size();
+            m_timers.push_back({0, c_null, c_null, c_null, 0, nullptr});
+        }
+
+        auto &timer = m_timers[index];
+        std::uint64_t ticks = std::clamp<std::uint64_t>(delay.count(), 1, c_max_delay);
+        timer.expiry = m_tick + ticks;
+        timer.callback = std::move(callback);
+        link(index);
+        m_size++;
+
+        Handle handle;
+        handle.m_index = index;
+        handle.m_generation = timer.generation;
+        return handle;
+    }
+
+    bool TimerWheel::cancel(Handle &handle) noexcept {
+        bool was_pending = pending(handle);
+        if(was_pending) {
+            unlink(handle.m_index);
+            release(handle.m_index);
+        }
+        handle = Handle();
+        return was_pending;
+    }
+
+    bool TimerWheel::pending(const Handle &handle) const noexcept {
+        if(!handle.valid() || handle.m_index >= m_timers.size()) {
+            return false;
+        }
+        auto &timer = m_timers[handle.m_index];
+        return timer.generation == handle.m_generation && timer.slot != c_null;
+    }
+
+    void TimerWheel::advance() noexcept {
+        m_tick++;
+
+        // Find the highest level whose slot boundary was crossed
+        std::size_t cascade_levels = 0;
+        for(std::size_t level = 1; level < c_levels; level++) {
+            std::uint64_t level_mask = (std::uint64_t(1) << (c_level_bits * level)) - 1;
+            if((m_tick & level_mask) != 0) {
+                break;
+            }
+            cascade_levels = level;
+        }
+
+        // Cascade from top to bottom so timers can land on lower levels that are about to cascade too
+        for(std::size_t level = cascade_levels; level > 0; level--) {
+            cascade(level);
+        }
+
+        // Fire due timers; callbacks may schedule or cancel other timers
+        auto &head = m_slots[m_tick & (c_level_slots - 1)];
+        while(head != c_null) {
+            auto index = head;
+            unlink(index);
+            auto callback = std::move(m_timers[index].callback);
+            release(index);
+            if(callback) {
+                callback();
+            }
+        }
+    }
+
+    std::size_t TimerWheel::size() const noexcept {
+        return m_size;
+    }
+
+    std::uint64_t TimerWheel::current_tick() const noexcept {
+        return m_tick;
+    }
+
+    TimerWheel::TimerWheel() noexcept {
+        m_slots.fill(c_null);
+    }
+
+    void TimerWheel::link(std::uint32_t index) noexcept {
+        auto &timer = m_timers[index];
+        std::uint64_t delta = timer.expiry - m_tick;
+
+        std::size_t level = 0;
+        while(level < c_levels - 1 && delta >= (std::uint64_t(1) << (c_level_bits * (level + 1)))) {
+            level++;
+        }
+
+        std::size_t slot_index = (timer.expiry >> (c_level_bits * level)) & (c_level_slots - 1);
+        std::uint32_t slot = level * c_level_slots + slot_index;
+        auto &head = m_slots[slot];
+
+        timer.slot = slot;
+        timer.prev = c_null;
+        timer.next = head;
+        if(head != c_null) {
+            m_timers[head].prev = index;
+        }
+        head = index;
+    }
+
+    void TimerWheel::unlink(std::uint32_t index) noexcept {
+        auto &timer = m_timers[index];
+        if(timer.prev != c_null) {
+            m_timers[timer.prev].next = timer.next;
+        }
+        else {
+            m_slots[timer.slot] = timer.next;
+        }
+        if(timer.next != c_null) {
+            m_timers[timer.next].prev = timer.prev;
+        }
+        timer.slot = c_null;
+        timer.prev = c_null;
+        timer.next = c_null;
+    }
+
+    void TimerWheel::release(std::uint32_t index) noexcept {
+        auto &timer = m_timers[index];
+        timer.callback = nullptr;
+        timer.generation++;
+        timer.next = m_free_head;
+        m_free_head = index;
+        m_size--;
+    }
+
+    void TimerWheel::cascade(std::size_t level) noexcept {
+        std::size_t slot_index = (m_tick >> (c_level_bits * level)) & (c_level_slots - 1);
+        auto &head = m_slots[level * c_level_slots + slot_index];
+        while(head != c_null) {
+            auto index = head;
+            unlink(index);
+            link(index);
+        }
+    }
+}
@@ -0,0 +1,123 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <cstdio>
+#include <blamite/core/trace.hpp>
+
+namespace Blamite::Engine {
+    namespace {
+        /** Ring of the calling thread */
+        thread_local void *current_ring = nullptr;
+
+        /** Name of the calling thread, kept until its ring is made */
+        thread_local std::string current_thread_name;
+
+        struct TraceRecord {
+            const char *name;
+            std::uint64_t begin;
+            std::uint64_t end;
+        };
+    }
+
+    Tracer Tracer::s_tracer;
+
+    void Tracer::set_enabled(bool enabled) noexcept {
+        m_enabled.store(enabled, std::memory_order_relaxed);
+    }
+
+    void Tracer::record(const char *name, std::uint64_t begin, std::uint64_t end) noexcept {
+        auto &ring = thread_ring();
+        auto index = ring.head.load(std::memory_order_relaxed);
+        auto &event = ring.events[index % RING_SIZE];
+        event.name.store(name, std::memory_order_relaxed);
+        event.begin.store(begin, std::memory_order_relaxed);
+        event.end.store(end, std::memory_order_relaxed);
+        ring.head.store(index + 1, std::memory_order_release);
+    }
+
+    void Tracer::set_thread_name(std::string name) noexcept {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if(current_ring) {
+            static_cast<Ring *>(current_ring)->thread_name = name;
+        }
+        current_thread_name = std::move(name);
+    }
+
+    bool Tracer::write_chrome_trace(const std::string &path, double seconds, DumpStats &stats) noexcept {
+        stats = {0, 0};
+
+        auto *file = std::fopen(path.c_str(), "w");
+        if(!file) {
+            return false;
+        }
+
+        // Rings are never freed, so only the list needs the lock
+        std::vector<std::pair<Ring *, std::string>> rings;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for(auto &ring : m_rings) {
+                rings.emplace_back(ring.get(), ring->thread_name);
+            }
+        }
+
+        // Nothing is older than the tracer, so longer windows take every event the rings still hold; so does anything
+        // that is not a positive number
+        auto current = now();
+        std::uint64_t cutoff = 0;
+        if(seconds > 0.0 && seconds * 1000000000.0 < static_cast<double>(current)) {
+            cutoff = current - static_cast<std::uint64_t>(seconds * 1000000000.0);
+        }
+
+        std::fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+        const char *separator = "\n";
+        std::vector<TraceRecord> records;
+        for(auto &[ring, name] : rings) {
+            // Owners keep writing while this copies, so slots they may have overwritten meanwhile are dropped
+            auto head = ring->head.load(std::memory_order_acquire);
+            auto first = head > RING_SIZE ? head - RING_SIZE : 0;
+            records.clear();
+            for(auto i = first; i < head; i++) {
+                auto &event = ring->events[i % RING_SIZE];
+                records.push_back({event.name.load(std::memory_order_relaxed), event.begin.load(std::memory_order_relaxed), event.end.load(std::memory_order_relaxed)});
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            auto new_head = ring->head.load(std::memory_order_relaxed);
+            auto first_intact = new_head + 1 > RING_SIZE ? new_head + 1 - RING_SIZE : 0;
+
+            std::size_t written = 0;
+            for(std::size_t i = 0; i < records.size(); i++) {
+                auto &record = records[i];
+                if(first + i < first_intact || record.end < cutoff) {
+                    continue;
+                }
+                std::fprintf(file, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                    separator, record.name, ring->thread_id, record.begin / 1000.0, (record.end - record.begin) / 1000.0);
+                separator = ",\n";
+                written++;
+            }
+
+            if(written > 0) {
+                std::fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}", separator, ring->thread_id, name.c_str());
+                stats.events += written;
+                stats.threads++;
+            }
+        }
+        std::fprintf(file, "\n]}\n");
+
+        return std::fclose(file) == 0;
+    }
+
+    Tracer::Ring &Tracer::thread_ring() noexcept {
+        if(current_ring) {
+            return *static_cast<Ring *>(current_ring);
+        }
+
+        auto ring = std::make_unique<Ring>();
+        ring->events = std::make_unique<Event[]>(RING_SIZE);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ring->thread_id = static_cast<std::uint32_t>(m_rings.size());
+        ring->thread_name = current_thread_name.empty() ? "thread " + std::to_string(ring->thread_id) : current_thread_name;
+        current_ring = ring.get();
+        return *m_rings.emplace_back(std::move(ring));
+    }
+}
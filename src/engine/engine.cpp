@@ -1,48 +1,197 @@
 // SPDX-License-Identifier: GPL-3.0-only
 
 #include <thread>
+#include <algorithm>
 #include <blamite/engine.hpp>
+#include <blamite/core/trace.hpp>
+#include <blamite/memory/allocation_counter.hpp>
 
 namespace Blamite::Engine {
-    bool Engine::m_main_loop_stop_flag = false;
-    Engine *Engine::instance = nullptr;
+    namespace {
+        /** Engine bound to this thread */
+        thread_local Engine *current_engine = nullptr;
+    }
+
+    void Engine::init_console(bool headless, const char *command_fifo, bool read_stdin) noexcept {
+        if(m_console_initialized) {
+            return;
+        }
+        m_console.init(headless, command_fifo, read_stdin);
+        m_console_initialized = true;
+    }
 
     void Engine::init_server(int port) noexcept {
         if(m_initialized) {
             return;
         }
+        init_console();
 
         // Initialize server
         try {
-            m_server = std::make_unique<Network::Server>(port);
+            m_server = std::make_unique<Network::Server>(*this, port, m_datagram_pool);
         }
         catch(std::runtime_error &error) {
             m_console.print(error.what());
             m_console.print("Failed to initialize server");
+            m_console.render();
             std::terminate();
         }
 
-        m_ticks_count = tick_t(0);
+        m_server->set_tick_rate(m_active_tick_rate);
+        m_ticks_count = 0;
+        m_last_activity = std::chrono::steady_clock::now();
         m_initialized = true;
     }
 
-    void Engine::start() noexcept {
-        m_console.print(Console::Color::bright_magenta, "Blamite v0.0.1-dev");
-        m_console.print(" * Use 'quit' command to exit.");
-        m_console.print();
+    void Engine::init_server(std::unique_ptr<Network::Transport> transport) noexcept {
+        if(m_initialized) {
+            return;
+        }
+        init_console();
 
-        auto listening_address = m_server->listening_address();
-        m_console.printf("Listening at %s", listening_address.c_str());
+        m_server = std::make_unique<Network::Server>(*this, std::move(transport), m_datagram_pool);
+        m_server->set_tick_rate(m_active_tick_rate);
+        m_ticks_count = 0;
+        m_last_activity = std::chrono::steady_clock::now();
+        m_initialized = true;
+    }
+
+    void Engine::start_rcon(int port, std::string password) noexcept {
+        if(password.empty()) {
+            m_console.print(Console::Color::yellow, "RCON needs a password; not starting it.");
+            return;
+        }
+
+        try {
+            m_rcon = std::make_unique<Network::RconServer>(m_console, port, std::move(password));
+            m_console.printf("RCON listening at %s", m_rcon->listening_address().c_str());
+        }
+        catch(std::runtime_error &error) {
+            m_console.print(error.what());
+            m_console.print("Failed to start RCON");
+        }
+    }
 
+    void Engine::start_metrics(int port) noexcept {
+        try {
+            m_metrics_server = std::make_unique<Network::MetricsServer>(m_metrics, port);
+            m_console.printf("Serving metrics at http://%s/metrics", m_metrics_server->listening_address().c_str());
+        }
+        catch(std::runtime_error &error) {
+            m_console.print(error.what());
+            m_console.print("Failed to start metrics endpoint");
+        }
+    }
+
+    void Engine::start_event_log(std::string path) noexcept {
+        try {
+            m_event_log = std::make_unique<EventLog>(std::move(path));
+            m_console.printf("Recording events to %s", m_event_log->path().c_str());
+        }
+        catch(std::runtime_error &error) {
+            m_console.print(error.what());
+            m_console.print("Failed to start event log");
+        }
+    }
+
+    void Engine::start_traffic_recording(std::string path) noexcept {
+        try {
+            m_server->start_recording(std::move(path));
+            m_console.printf("Recording inbound traffic to %s", m_server->recorder()->path().c_str());
+        }
+        catch(std::runtime_error &error) {
+            m_console.print(error.what());
+            m_console.print("Failed to start traffic recording");
+        }
+    }
+
+    void Engine::set_tick_rate(std::uint16_t ticks_per_second) noexcept {
+        m_tick_rate = std::clamp<std::uint16_t>(ticks_per_second, 1, TIMER_RATE);
+        if(!m_ticking) {
+            update_tick_rate();
+        }
+    }
+
+    std::uint16_t Engine::tick_rate() const noexcept {
+        return m_tick_rate;
+    }
+
+    void Engine::set_idle_tick_rate(std::uint16_t ticks_per_second) noexcept {
+        m_idle_tick_rate = std::min(ticks_per_second, TIMER_RATE);
+        if(!m_ticking) {
+            update_tick_rate();
+        }
+    }
+
+    std::uint16_t Engine::idle_tick_rate() const noexcept {
+        return m_idle_tick_rate;
+    }
+
+    std::uint16_t Engine::active_tick_rate() const noexcept {
+        return m_active_tick_rate;
+    }
+
+    std::chrono::steady_clock::duration Engine::tick_period() const noexcept {
+        return m_tick_period;
+    }
+
+    void Engine::set_job_system(JobSystem *jobs) noexcept {
+        m_job_system = jobs;
+    }
+
+    void Engine::start() noexcept {
+        bind();
+        Tracer::get().set_thread_name("engine");
+        announce();
         main_loop();
     }
 
+    void Engine::stop() noexcept {
+        m_stop_flag.store(true, std::memory_order_relaxed);
+    }
+
+    bool Engine::stopped() const noexcept {
+        return m_stop_flag.load(std::memory_order_relaxed);
+    }
+
+    void Engine::bind() noexcept {
+        current_engine = this;
+    }
+
     Console &Engine::console() noexcept {
         return m_console;
     }
 
+    Network::Server &Engine::server() noexcept {
+        return *m_server;
+    }
+
+    EntityStore &Engine::entities() noexcept {
+        return m_entities;
+    }
+
+    EventLog *Engine::event_log() noexcept {
+        return m_event_log.get();
+    }
+
+    Metrics &Engine::metrics() noexcept {
+        return m_metrics;
+    }
+
+    FrameArena &Engine::frame_arena() noexcept {
+        return m_frame_arena;
+    }
+
+    std::size_t Engine::tick_allocations() const noexcept {
+        return m_tick_allocations;
+    }
+
     std::size_t Engine::tick_count() const noexcept {
-        return m_ticks_count.count();
+        return m_ticks_count;
+    }
+
+    std::chrono::steady_clock::time_point Engine::tick_start() const noexcept {
+        return m_tick_start;
     }
 
     float Engine::tick_timestamp() const noexcept {
@@ -50,35 +199,213 @@ namespace Blamite::Engine {
         return ns / 1000000;
     }
 
-    Engine::Engine() noexcept {
-        // Set singleton
-        instance = this;
+    Engine::Engine(BufferPool *datagram_pool) noexcept : m_datagram_pool(datagram_pool) {
+        m_ticks_metric = &m_metrics.counter("blamite_ticks_total", "Ticks run.");
+        m_tick_duration_metric = &m_metrics.histogram("blamite_tick_duration_seconds", "Time spent running a tick, excluding sleep.", 
+            {0.0005, 0.001, 0.002, 0.005, 0.01, 0.02, 0.033, 0.05, 0.1, 0.25, 1.0});
+        m_tick_allocations_metric = &m_metrics.gauge("blamite_tick_heap_allocations", "Heap allocations made by the engine thread during the last tick.");
+        m_tick_rate_metric = &m_metrics.gauge("blamite_tick_rate", "Ticks per second the engine is running at.");
+        m_clients_metric = &m_metrics.gauge("blamite_clients", "Connected clients.");
+        m_entities_metric = &m_metrics.gauge("blamite_entities", "Game entities.");
+        update_tick_rate();
 
-        // Initialize console
-        m_console.init();
+        // Background commands run on workers; they need to find this engine too
+        m_console.jobs().set_thread_init([this]() {
+            bind();
+        });
+    }
+
+    Engine::~Engine() noexcept {
+        if(current_engine == this) {
+            current_engine = nullptr;
+        }
     }
 
     Engine &Engine::get() noexcept {
-        return *instance;
+        return *current_engine;
+    }
+
+    void Engine::tick() noexcept {
+        // Commands changing the rate run inside the tick; they take effect after it, so a tick never mixes rates
+        m_ticking = true;
+        (this->*m_tick_function)();
+        m_ticking = false;
+        update_tick_rate();
+    }
+
+    template<std::uint16_t Rate> void Engine::tick_at() noexcept {
+        TRACE_SCOPE("tick");
+        using steady_clock = std::chrono::steady_clock;
+        auto tick_start_timestamp = steady_clock::now();
+        auto allocations_start = heap_allocations();
+        m_tick_start = tick_start_timestamp;
+
+        float delta;
+        std::size_t timer_steps;
+        if constexpr(Rate == 0) {
+            delta = 1.0f / m_active_tick_rate;
+            m_timer_credit += TIMER_RATE;
+            timer_steps = m_timer_credit / m_active_tick_rate;
+            m_timer_credit %= m_active_tick_rate;
+        }
+        else {
+            static_assert(TIMER_RATE % Rate == 0, "Specialized tick rates must advance timers by whole steps");
+            delta = 1.0f / Rate;
+            timer_steps = TIMER_RATE / Rate;
+        }
+
+        // Commands run here, on the engine thread, before anything else sees the tick
+        m_console.read_input();
+
+        if(m_job_system) {
+            // Network and entity simulation do not touch each other; replication needs both
+            m_tick_graph.clear();
+            auto network = m_tick_graph.add([this, timer_steps]() {
+                receive(timer_steps);
+            });
+            auto simulation = m_tick_graph.add_range(m_entities.size(), c_entity_chunk_size, [this, delta](std::size_t begin, std::size_t end) {
+                TRACE_SCOPE("simulate");
+                m_entities.tick(delta, begin, end);
+            });
+            m_tick_graph.add([this]() {
+                replicate_entities();
+                m_server->send_scheduled_updates(m_job_system);
+            }, {network, simulation});
+            m_job_system->run(m_tick_graph);
+        }
+        else {
+            receive(timer_steps);
+            {
+                TRACE_SCOPE("simulate");
+                m_entities.tick(delta);
+            }
+            replicate_entities();
+            m_server->send_scheduled_updates();
+        }
+
+        // Draw everything printed during this tick at once
+        m_console.render();
+
+        auto tick_timestamp = steady_clock::now() - tick_start_timestamp;
+        m_last_tick_timestamp = tick_timestamp;
+
+        m_ticks_metric->add();
+        m_tick_duration_metric->observe(std::chrono::duration<double>(tick_timestamp).count());
+        m_clients_metric->set(m_server->clients_count());
+        m_entities_metric->set(m_entities.size());
+
+        if(m_event_log) {
+            TickStatsEvent stats;
+            stats.tick = m_ticks_count;
+            stats.duration = std::chrono::duration_cast<std::chrono::microseconds>(tick_timestamp).count();
+            stats.clients = m_server->clients_count();
+            stats.entities = m_entities.size();
+            m_event_log->write(stats);
+        }
+
+        // Nothing allocated on the arena survives the tick
+        m_frame_arena.reset();
+        m_tick_allocations = heap_allocations() - allocations_start;
+        m_tick_allocations_metric->set(m_tick_allocations);
+
+        m_ticks_count++;
+    }
+
+    void Engine::announce() noexcept {
+        m_console.print(Console::Color::bright_magenta, "Blamite v0.0.1-dev");
+        m_console.print(" * Use 'quit' command to exit.");
+        m_console.print();
+
+        auto listening_address = m_server->listening_address();
+        m_console.printf("Listening at %s", listening_address.c_str());
     }
 
     void Engine::main_loop() noexcept {
         using steady_clock = std::chrono::steady_clock;
 
-        while(!m_main_loop_stop_flag) {
+        while(!stopped()) {
             auto tick_start_timestamp = steady_clock::now();
-
-            m_console.read_input();
-            
-            m_server->read_data();
-            m_server->process_received_data();
+            tick();
 
             // Sleep until next tick
-            auto tick_timestamp = steady_clock::now() - tick_start_timestamp;
-            std::this_thread::sleep_for(tick_t(1) - tick_timestamp);
+            std::this_thread::sleep_for(m_tick_period - (steady_clock::now() - tick_start_timestamp));
+        }
+    }
 
-            m_last_tick_timestamp = tick_timestamp;
-            m_ticks_count++;
+    void Engine::update_tick_rate() noexcept {
+        // Drop to the idle rate after a while without anyone around, and come back as soon as someone shows up
+        if(m_server && (m_server->clients_count() > 0 || m_server->received_count() > 0)) {
+            m_last_activity = m_tick_start;
         }
+        bool idle = m_idle_tick_rate != 0 && m_tick_start - m_last_activity >= c_idle_delay;
+        auto rate = idle ? m_idle_tick_rate : m_tick_rate;
+        if(rate != m_active_tick_rate) {
+            apply_tick_rate(rate);
+        }
+    }
+
+    void Engine::apply_tick_rate(std::uint16_t ticks_per_second) noexcept {
+        m_active_tick_rate = ticks_per_second;
+        m_tick_period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / ticks_per_second));
+        m_timer_credit = 0;
+        m_tick_rate_metric->set(ticks_per_second);
+        if(m_server) {
+            m_server->set_tick_rate(ticks_per_second);
+        }
+
+        // Common rates get a tick body with their math folded in
+        switch(ticks_per_second) {
+            case 2: m_tick_function = &Engine::tick_at<2>; break;
+            case 5: m_tick_function = &Engine::tick_at<5>; break;
+            case 10: m_tick_function = &Engine::tick_at<10>; break;
+            case 20: m_tick_function = &Engine::tick_at<20>; break;
+            case 30: m_tick_function = &Engine::tick_at<30>; break;
+            case 60: m_tick_function = &Engine::tick_at<60>; break;
+            case 120: m_tick_function = &Engine::tick_at<120>; break;
+            default: m_tick_function = &Engine::tick_at<0>; break;
+        }
+    }
+
+    void Engine::receive(std::size_t timer_steps) noexcept {
+        TRACE_SCOPE("receive");
+        m_server->read_data();
+        m_server->process_received_data();
+        m_server->process_timers(timer_steps);
+    }
+
+    void Engine::replicate_entities() noexcept {
+        TRACE_SCOPE("replicate entities");
+        // Plain floats, so there is no padding to pack
+        struct EntityState {
+            Vector3D position;
+            Vector3D velocity;
+            float health;
+        };
+
+        for(auto &handle : m_entities.destroyed()) {
+            m_server->remove_object(handle.value());
+        }
+
+        auto replicate = [this](EntityStore::Handle handle, const Vector3D &position, const Vector3D &velocity, float health) {
+            EntityState state = {position, velocity, health};
+            m_server->update_object(handle.value(), position, 1.0f, reinterpret_cast<std::byte *>(&state), sizeof(state));
+        };
+
+        for(auto &handle : m_entities.created()) {
+            if(m_entities.alive(handle)) {
+                replicate(handle, *m_entities.position(handle), *m_entities.velocity(handle), *m_entities.health(handle));
+            }
+        }
+        m_entities.clear_changes();
+
+        // Resting entities have nothing new to send
+        m_entities.for_each([&](EntityStore::Handle handle, const Vector3D &position, const Vector3D &velocity, float health, std::uint32_t owner) {
+            if(owner != EntityStore::NO_OWNER) {
+                m_server->set_client_view(owner, position, c_client_view_radius);
+            }
+            if(velocity.length_squared() > 0.0f) {
+                replicate(handle, position, velocity, health);
+            }
+        });
     }
 }
@@ -0,0 +1,144 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <blamite/game/entities.hpp>
+
+namespace Blamite::Engine {
+    EntityStore::Handle EntityStore::create(const Vector3D &position, const Vector3D &velocity, float health, std::uint32_t owner) noexcept {
+        std::uint16_t slot;
+        if(!m_free_slots.empty()) {
+            slot = m_free_slots.back();
+            m_free_slots.pop_back();
+        }
+        else if(m_slot_indices.size() < MAX_ENTITIES) {
+            slot = m_slot_indices.size();
+            m_slot_indices.push_back(c_no_index);
+            m_slot_generations.push_back(0);
+        }
+        else {
+            return Handle();
+        }
+
+        m_slot_indices[slot] = m_dense_slots.size();
+        m_dense_slots.push_back(slot);
+        m_positions.push_back(position);
+        m_velocities.push_back(velocity);
+        m_health.push_back(health);
+        m_owners.push_back(owner);
+
+        auto handle = make_handle(slot);
+        m_created.push_back(handle);
+        return handle;
+    }
+
+    bool EntityStore::destroy(Handle handle) noexcept {
+        auto index = index_of(handle);
+        if(index == c_no_index) {
+            return false;
+        }
+
+        // Move last entity into the hole to keep arrays packed
+        auto last = m_dense_slots.size() - 1;
+        auto last_slot = m_dense_slots[last];
+        m_dense_slots[index] = last_slot;
+        m_positions[index] = m_positions[last];
+        m_velocities[index] = m_velocities[last];
+        m_health[index] = m_health[last];
+        m_owners[index] = m_owners[last];
+        m_slot_indices[last_slot] = index;
+
+        m_dense_slots.pop_back();
+        m_positions.pop_back();
+        m_velocities.pop_back();
+        m_health.pop_back();
+        m_owners.pop_back();
+
+        auto slot = handle.slot();
+        m_slot_indices[slot] = c_no_index;
+        m_slot_generations[slot]++;
+        m_free_slots.push_back(slot);
+        m_destroyed.push_back(handle);
+        return true;
+    }
+
+    bool EntityStore::alive(Handle handle) const noexcept {
+        return index_of(handle) != c_no_index;
+    }
+
+    Vector3D *EntityStore::position(Handle handle) noexcept {
+        auto index = index_of(handle);
+        return index != c_no_index ? &m_positions[index] : nullptr;
+    }
+
+    Vector3D *EntityStore::velocity(Handle handle) noexcept {
+        auto index = index_of(handle);
+        return index != c_no_index ? &m_velocities[index] : nullptr;
+    }
+
+    float *EntityStore::health(Handle handle) noexcept {
+        auto index = index_of(handle);
+        return index != c_no_index ? &m_health[index] : nullptr;
+    }
+
+    std::uint32_t EntityStore::owner(Handle handle) const noexcept {
+        auto index = index_of(handle);
+        return index != c_no_index ? m_owners[index] : NO_OWNER;
+    }
+
+    void EntityStore::tick(float delta) noexcept {
+        tick(delta, 0, m_positions.size());
+    }
+
+    void EntityStore::tick(float delta, std::size_t begin, std::size_t end) noexcept {
+        auto *positions = m_positions.data();
+        auto *velocities = m_velocities.data();
+        for(std::size_t i = begin; i < end; i++) {
+            positions[i].x += velocities[i].x * delta;
+            positions[i].y += velocities[i].y * delta;
+            positions[i].z += velocities[i].z * delta;
+        }
+    }
+
+    std::size_t EntityStore::size() const noexcept {
+        return m_dense_slots.size();
+    }
+
+    const std::vector<EntityStore::Handle> &EntityStore::created() const noexcept {
+        return m_created;
+    }
+
+    const std::vector<EntityStore::Handle> &EntityStore::destroyed() const noexcept {
+        return m_destroyed;
+    }
+
+    void EntityStore::clear_changes() noexcept {
+        m_created.clear();
+        m_destroyed.clear();
+    }
+
+    void EntityStore::reserve(std::size_t count) noexcept {
+        m_slot_indices.reserve(count);
+        m_slot_generations.reserve(count);
+        m_dense_slots.reserve(count);
+        m_positions.reserve(count);
+        m_velocities.reserve(count);
+        m_health.reserve(count);
+        m_owners.reserve(count);
+    }
+
+    EntityStore::Handle EntityStore::make_handle(std::uint16_t slot) const noexcept {
+        Handle handle;
+        handle.m_value = (static_cast<std::uint32_t>(m_slot_generations[slot]) << 16) | slot;
+        return handle;
+    }
+
+    std::uint32_t EntityStore::index_of(Handle handle) const noexcept {
+        if(!handle.valid()) {
+            return c_no_index;
+        }
+        auto slot = handle.slot();
+        if(slot >= m_slot_indices.size() || m_slot_generations[slot] != handle.generation()) {
+            return c_no_index;
+        }
+        return m_slot_indices[slot];
+    }
+}
@@ -0,0 +1,98 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <thread>
+#include <algorithm>
+#include <functional>
+#include <blamite/host.hpp>
+#include <blamite/core/trace.hpp>
+
+namespace Blamite::Engine {
+    Engine &EngineHost::add() noexcept {
+        auto &group = *m_groups[m_engines.size() % m_groups.size()];
+        auto &engine = *m_engines.emplace_back(std::make_unique<Engine>(&group.datagram_pool));
+        group.engines.push_back(&engine);
+        engine.set_job_system(m_job_system.get());
+        return engine;
+    }
+
+    const std::vector<std::unique_ptr<Engine>> &EngineHost::engines() const noexcept {
+        return m_engines;
+    }
+
+    void EngineHost::run() noexcept {
+        std::vector<std::thread> threads;
+        for(auto &group : m_groups) {
+            if(!group->engines.empty()) {
+                threads.emplace_back(&EngineHost::run_group, this, std::ref(*group));
+            }
+        }
+
+        for(auto &thread : threads) {
+            thread.join();
+        }
+    }
+
+    void EngineHost::stop() noexcept {
+        for(auto &engine : m_engines) {
+            engine->stop();
+        }
+    }
+
+    EngineHost::EngineHost(std::size_t threads, std::size_t workers) noexcept {
+        for(std::size_t i = 0; i < std::max<std::size_t>(threads, 1); i++) {
+            m_groups.push_back(std::make_unique<Group>());
+        }
+        if(workers > 0) {
+            m_job_system = std::make_unique<JobSystem>(workers);
+        }
+    }
+
+    void EngineHost::run_group(Group &group) noexcept {
+        using steady_clock = std::chrono::steady_clock;
+        auto index = std::find_if(m_groups.begin(), m_groups.end(), [&group](auto &entry) {
+            return entry.get() == &group;
+        }) - m_groups.begin();
+        Tracer::get().set_thread_name("engines " + std::to_string(index));
+
+        for(auto *engine : group.engines) {
+            engine->announce();
+        }
+
+        // Engines may tick at different rates, so each one keeps its own schedule
+        std::vector<steady_clock::time_point> next_ticks(group.engines.size(), steady_clock::now());
+        while(true) {
+            if(m_engines.front()->stopped()) {
+                stop();
+            }
+
+            bool running = false;
+            auto wake_up = steady_clock::time_point::max();
+            for(std::size_t i = 0; i < group.engines.size(); i++) {
+                auto *engine = group.engines[i];
+                if(engine->stopped()) {
+                    continue;
+                }
+                running = true;
+
+                auto &next_tick = next_ticks[i];
+                if(next_tick <= steady_clock::now()) {
+                    engine->bind();
+                    engine->tick();
+
+                    // Keep a steady rate, but do not rush to catch up after a slow tick
+                    next_tick += engine->tick_period();
+                    auto now = steady_clock::now();
+                    if(next_tick < now) {
+                        next_tick = now;
+                    }
+                }
+                wake_up = std::min(wake_up, next_tick);
+            }
+            if(!running) {
+                return;
+            }
+
+            std::this_thread::sleep_until(wake_up);
+        }
+    }
+}
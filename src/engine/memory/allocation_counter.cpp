@@ -0,0 +1,62 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <new>
+#include <cstdlib>
+#include <algorithm>
+#include <blamite/memory/allocation_counter.hpp>
+
+namespace Blamite::Engine {
+    namespace {
+        /** Allocations made by this thread; constant initialized, so counting never allocates */
+        thread_local std::size_t allocations = 0;
+    }
+
+    std::size_t heap_allocations() noexcept {
+        return allocations;
+    }
+}
+
+// Every other form of operator new ends up in one of these two
+
+void *operator new(std::size_t size) {
+    Blamite::Engine::allocations++;
+    if(void *pointer = std::malloc(size ? size : 1)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment) {
+    Blamite::Engine::allocations++;
+    auto align = static_cast<std::size_t>(alignment);
+    size = (std::max<std::size_t>(size, 1) + align - 1) & ~(align - 1);
+    #ifdef _WIN32
+    void *pointer = _aligned_malloc(size, align);
+    #else
+    void *pointer = std::aligned_alloc(align, size);
+    #endif
+    if(pointer) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void *pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void *pointer, std::align_val_t) noexcept {
+    #ifdef _WIN32
+    _aligned_free(pointer);
+    #else
+    std::free(pointer);
+    #endif
+}
+
+void operator delete(void *pointer, std::size_t, std::align_val_t alignment) noexcept {
+    operator delete(pointer, alignment);
+}
@@ -0,0 +1,69 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <utility>
+#include <blamite/memory/buffer_pool.hpp>
+
+namespace Blamite::Engine {
+    std::size_t BufferPool::Buffer::capacity() const noexcept {
+        return m_pool ? m_pool->m_buffer_size : 0;
+    }
+
+    void BufferPool::Buffer::release() noexcept {
+        if(m_data) {
+            m_pool->m_free.push_back(m_data);
+            m_data = nullptr;
+            m_pool = nullptr;
+        }
+    }
+
+    BufferPool::Buffer::Buffer(Buffer &&other) noexcept {
+        m_pool = std::exchange(other.m_pool, nullptr);
+        m_data = std::exchange(other.m_data, nullptr);
+    }
+
+    BufferPool::Buffer &BufferPool::Buffer::operator=(Buffer &&other) noexcept {
+        if(this != &other) {
+            release();
+            m_pool = std::exchange(other.m_pool, nullptr);
+            m_data = std::exchange(other.m_data, nullptr);
+        }
+        return *this;
+    }
+
+    BufferPool::Buffer::~Buffer() noexcept {
+        release();
+    }
+
+    BufferPool::Buffer BufferPool::acquire() noexcept {
+        Buffer buffer;
+        buffer.m_pool = this;
+        if(!m_free.empty()) {
+            buffer.m_data = m_free.back();
+            m_free.pop_back();
+        }
+        else {
+            buffer.m_data = m_storage.emplace_back(std::make_unique<std::byte[]>(m_buffer_size)).get();
+            m_free.reserve(m_storage.size());
+        }
+        return buffer;
+    }
+
+    std::size_t BufferPool::buffer_size() const noexcept {
+        return m_buffer_size;
+    }
+
+    std::size_t BufferPool::allocated() const noexcept {
+        return m_storage.size();
+    }
+
+    std::size_t BufferPool::available() const noexcept {
+        return m_free.size();
+    }
+
+    BufferPool::BufferPool(std::size_t buffer_size, std::size_t reserve) noexcept {
+        m_buffer_size = buffer_size;
+        for(std::size_t i = 0; i < reserve; i++) {
+            m_free.push_back(m_storage.emplace_back(std::make_unique<std::byte[]>(buffer_size)).get());
+        }
+    }
+}
@@ -0,0 +1,65 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <new>
+#include <cstdint>
+#include <algorithm>
+#include <blamite/memory/frame_arena.hpp>
+
+namespace Blamite::Engine {
+    void FrameArena::reset() noexcept {
+        m_peak = std::max(m_peak, m_used);
+        m_last = m_used;
+
+        if(!m_overflow.empty()) {
+            for(auto &[pointer, alignment] : m_overflow) {
+                ::operator delete(pointer, std::align_val_t(alignment));
+            }
+            m_overflow.clear();
+            m_overflows++;
+
+            // Grow so a tick like this one fits next time
+            while(m_capacity < m_peak) {
+                m_capacity *= 2;
+            }
+            m_block = std::make_unique<std::byte[]>(m_capacity);
+        }
+
+        m_offset = 0;
+        m_used = 0;
+    }
+
+    FrameArena::Stats FrameArena::stats() const noexcept {
+        return {m_used, m_last, std::max(m_peak, m_used), m_capacity, m_overflows};
+    }
+
+    FrameArena::FrameArena(std::size_t capacity) noexcept {
+        m_capacity = std::max<std::size_t>(capacity, 64);
+        m_block = std::make_unique<std::byte[]>(m_capacity);
+        m_overflow.reserve(16);
+    }
+
+    void *FrameArena::do_allocate(std::size_t bytes, std::size_t alignment) {
+        auto base = reinterpret_cast<std::uintptr_t>(m_block.get());
+        auto start = (base + m_offset + alignment - 1) & ~(alignment - 1);
+        auto end = start - base + bytes;
+        m_used += bytes;
+
+        if(end <= m_capacity) {
+            m_offset = end;
+            return reinterpret_cast<void *>(start);
+        }
+
+        // Block is full; keep going on the heap until the next reset
+        auto *pointer = ::operator new(bytes, std::align_val_t(alignment));
+        m_overflow.emplace_back(pointer, alignment);
+        return pointer;
+    }
+
+    void FrameArena::do_deallocate(void *, std::size_t, std::size_t) {
+        // Everything goes away on reset
+    }
+
+    bool FrameArena::do_is_equal(const std::pmr::memory_resource &other) const noexcept {
+        return this == &other;
+    }
+}
@@ -0,0 +1,168 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <new>
+#include <string>
+#include <algorithm>
+#include <stdexcept>
+#include <blamite/memory/struct.hpp>
+#include <blamite/network/capture.hpp>
+
+namespace Blamite::Engine::Network {
+    namespace {
+        struct PcapHeader {
+            std::uint32_t magic = 0xA1B2C3D4;
+            std::uint16_t version_major = 2;
+            std::uint16_t version_minor = 4;
+            std::int32_t timezone = 0;
+            std::uint32_t accuracy = 0;
+            std::uint32_t snapshot_length;
+            std::uint32_t link_type = 228; // LINKTYPE_IPV4
+        };
+
+        struct PcapRecordHeader {
+            std::uint32_t seconds;
+            std::uint32_t microseconds;
+            std::uint32_t captured_size;
+            std::uint32_t size;
+        };
+
+        struct PACKED Ipv4Header {
+            std::uint8_t version_length = 0x45;
+            std::uint8_t type_of_service = 0;
+            std::uint16_t total_length;
+            std::uint16_t identification = 0;
+            std::uint16_t fragment_offset = 0;
+            std::uint8_t time_to_live = 64;
+            std::uint8_t protocol = 17; // UDP
+            std::uint16_t checksum = 0;
+            std::uint32_t source;
+            std::uint32_t destination;
+        };
+
+        struct PACKED UdpHeader {
+            std::uint16_t source_port;
+            std::uint16_t destination_port;
+            std::uint16_t length;
+            std::uint16_t checksum = 0; // Optional over IPv4
+        };
+
+        std::uint16_t ipv4_checksum(const Ipv4Header &header) noexcept {
+            std::uint16_t words[sizeof(header) / 2];
+            std::memcpy(words, &header, sizeof(header));
+            std::uint32_t sum = 0;
+            for(auto word : words) {
+                sum += word;
+            }
+            while(sum >> 16) {
+                sum = (sum & 0xFFFF) + (sum >> 16);
+            }
+            return static_cast<std::uint16_t>(~sum);
+        }
+    }
+
+    void PacketCapture::record(Direction direction, const sockpp::inet_address &peer, const void *data, std::size_t size) noexcept {
+        auto index = m_next.fetch_add(1, std::memory_order_relaxed);
+        auto &slot = m_slots[index % m_slots_count];
+
+        slot.sequence.store(index * 2 + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        slot.time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        slot.direction = direction;
+        slot.address = peer.address();
+        slot.port = peer.port();
+        slot.size = static_cast<std::uint32_t>(size);
+        std::memcpy(slot.data, data, std::min(size, SNAPSHOT_LENGTH));
+
+        slot.sequence.store(index * 2 + 2, std::memory_order_release);
+    }
+
+    std::vector<PacketCapture::Record> PacketCapture::snapshot() const noexcept {
+        std::vector<Record> records;
+        auto next = m_next.load(std::memory_order_acquire);
+        auto first = next > m_slots_count ? next - m_slots_count : 0;
+        records.reserve(next - first);
+
+        for(auto index = first; index < next; index++) {
+            auto &slot = m_slots[index % m_slots_count];
+            auto sequence = slot.sequence.load(std::memory_order_acquire);
+            if(sequence != index * 2 + 2) {
+                // Being written, or already overwritten by a newer datagram
+                continue;
+            }
+
+            Record record;
+            record.time = slot.time;
+            record.direction = slot.direction;
+            record.peer = sockpp::inet_address(slot.address, slot.port);
+            record.size = slot.size;
+            record.data.assign(slot.data, slot.data + std::min<std::size_t>(slot.size, SNAPSHOT_LENGTH));
+
+            // Drop it if a writer got to the slot while copying
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if(slot.sequence.load(std::memory_order_relaxed) == sequence) {
+                records.push_back(std::move(record));
+            }
+        }
+        return records;
+    }
+
+    PacketCapture::Stats PacketCapture::stats() const noexcept {
+        return {m_next.load(std::memory_order_relaxed), m_slots_count};
+    }
+
+    bool PacketCapture::write_pcap(const std::string &path, const sockpp::inet_address &local, const std::vector<Record> &records) noexcept {
+        auto *file = std::fopen(path.c_str(), "wb");
+        if(!file) {
+            return false;
+        }
+
+        PcapHeader file_header;
+        file_header.snapshot_length = sizeof(Ipv4Header) + sizeof(UdpHeader) + SNAPSHOT_LENGTH;
+        bool ok = std::fwrite(&file_header, sizeof(file_header), 1, file) == 1;
+
+        for(auto &record : records) {
+            bool inbound = record.direction == DIRECTION_IN;
+            auto &source = inbound ? record.peer : local;
+            auto &destination = inbound ? local : record.peer;
+
+            UdpHeader udp;
+            udp.source_port = htons(source.port());
+            udp.destination_port = htons(destination.port());
+            udp.length = htons(static_cast<std::uint16_t>(sizeof(UdpHeader) + record.size));
+
+            Ipv4Header ip;
+            ip.total_length = htons(static_cast<std::uint16_t>(sizeof(Ipv4Header) + sizeof(UdpHeader) + record.size));
+            ip.source = htonl(source.address());
+            ip.destination = htonl(destination.address());
+            ip.checksum = ipv4_checksum(ip);
+
+            PcapRecordHeader header;
+            header.seconds = static_cast<std::uint32_t>(record.time / 1000000);
+            header.microseconds = static_cast<std::uint32_t>(record.time % 1000000);
+            header.captured_size = static_cast<std::uint32_t>(sizeof(ip) + sizeof(udp) + record.data.size());
+            header.size = static_cast<std::uint32_t>(sizeof(ip) + sizeof(udp) + record.size);
+
+            ok = ok && std::fwrite(&header, sizeof(header), 1, file) == 1;
+            ok = ok && std::fwrite(&ip, sizeof(ip), 1, file) == 1;
+            ok = ok && std::fwrite(&udp, sizeof(udp), 1, file) == 1;
+            ok = ok && std::fwrite(record.data.data(), 1, record.data.size(), file) == record.data.size();
+        }
+
+        return std::fclose(file) == 0 && ok;
+    }
+
+    PacketCapture::PacketCapture(std::size_t slots) {
+        if(slots > MAX_SLOTS) {
+            throw std::runtime_error("Capture rings hold at most " + std::to_string(MAX_SLOTS) + " datagrams");
+        }
+        m_slots_count = std::max<std::size_t>(slots, 1);
+        m_slots.reset(new(std::nothrow) Slot[m_slots_count]);
+        if(!m_slots) {
+            throw std::runtime_error("Failed to allocate " + std::to_string(m_slots_count) + " capture slots");
+        }
+    }
+}
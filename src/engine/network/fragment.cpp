@@ -0,0 +1,134 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <cstring>
+#include <blamite/network/fragment.hpp>
+
+namespace Blamite::Engine::Network {
+    void Reassembler::Message::copy_to(std::byte *output) const noexcept {
+        for(std::size_t i = 0; i < m_count; i++) {
+            auto &fragment = m_fragments[i];
+            std::memcpy(output, fragment.data(), fragment.size);
+            output += fragment.size;
+        }
+    }
+
+    bool Reassembler::push(BufferPool::Buffer &datagram, std::size_t offset, std::size_t size, const handler_t &handler) noexcept {
+        if(size < sizeof(FragmentHeader)) {
+            return false;
+        }
+
+        FragmentHeader header;
+        std::memcpy(&header, datagram.data() + offset, sizeof(header));
+        if(header.count == 0 || header.count > MAX_FRAGMENTS || header.index >= header.count) {
+            return false;
+        }
+
+        Fragment fragment;
+        fragment.offset = offset + sizeof(FragmentHeader);
+        fragment.size = size - sizeof(FragmentHeader);
+
+        // Unfragmented messages are handed out straight from the datagram
+        if(header.count == 1) {
+            fragment.datagram = std::move(datagram);
+
+            Message message;
+            message.m_fragments = &fragment;
+            message.m_count = 1;
+            message.m_size = fragment.size;
+            handler(message);
+
+            datagram = std::move(fragment.datagram);
+            return true;
+        }
+
+        Slot *slot = nullptr;
+        Slot *free_slot = nullptr;
+        for(auto &entry : m_slots) {
+            if(entry.active && entry.message_id == header.message_id) {
+                slot = &entry;
+                break;
+            }
+            if(!entry.active && !free_slot) {
+                free_slot = &entry;
+            }
+        }
+
+        if(!slot) {
+            // Too many messages in flight; the oldest ones have to complete or time out first
+            if(!free_slot) {
+                m_dropped_messages++;
+                return false;
+            }
+
+            slot = free_slot;
+            slot->active = true;
+            slot->message_id = header.message_id;
+            slot->count = header.count;
+            slot->received = 0;
+            slot->size = 0;
+            slot->timeout_timer = m_timers.schedule(m_timeout, [this, slot]() {
+                m_dropped_messages++;
+                release(*slot);
+            });
+        }
+
+        if(slot->count != header.count) {
+            return false;
+        }
+
+        auto &slot_fragment = slot->fragments[header.index];
+        if(slot_fragment.datagram) {
+            // Duplicate
+            return true;
+        }
+        if(m_held_fragments == c_max_held_fragments) {
+            return false;
+        }
+
+        fragment.datagram = std::move(datagram);
+        slot->size += fragment.size;
+        slot_fragment = std::move(fragment);
+        slot->received++;
+        m_held_fragments++;
+
+        if(slot->received == slot->count) {
+            Message message;
+            message.m_fragments = slot->fragments.data();
+            message.m_count = slot->count;
+            message.m_size = slot->size;
+            handler(message);
+
+            release(*slot);
+        }
+        return true;
+    }
+
+    std::size_t Reassembler::held_fragments() const noexcept {
+        return m_held_fragments;
+    }
+
+    std::size_t Reassembler::dropped_messages() const noexcept {
+        return m_dropped_messages;
+    }
+
+    Reassembler::Reassembler(TimerWheel &timers, timer_tick_t timeout) noexcept : m_timers(timers) {
+        m_timeout = timeout;
+    }
+
+    Reassembler::~Reassembler() noexcept {
+        for(auto &slot : m_slots) {
+            if(slot.active) {
+                m_timers.cancel(slot.timeout_timer);
+            }
+        }
+    }
+
+    void Reassembler::release(Slot &slot) noexcept {
+        m_timers.cancel(slot.timeout_timer);
+        for(std::size_t i = 0; i < slot.count; i++) {
+            slot.fragments[i].datagram.release();
+        }
+        m_held_fragments -= slot.received;
+        slot.active = false;
+    }
+}
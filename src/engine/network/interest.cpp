@@ -0,0 +1,278 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <cmath>
+#include <algorithm>
+#include <blamite/network/interest.hpp>
+
+namespace Blamite::Engine::Network {
+    void InterestManager::update_object(object_id_t object, const Vector3D &position) noexcept {
+        auto [it, inserted] = m_objects.try_emplace(object);
+        auto &entry = it->second;
+        auto cell_x = cell_coord(position.x);
+        auto cell_y = cell_coord(position.y);
+
+        entry.position = position;
+        if(inserted) {
+            entry.updated = false;
+        }
+        if(!entry.updated) {
+            entry.updated = true;
+            m_updated_objects.push_back(object);
+        }
+
+        if(!inserted) {
+            // Moving inside the same cell does not change relevance
+            if(entry.cell_x == cell_x && entry.cell_y == cell_y) {
+                return;
+            }
+
+            auto old_x = entry.cell_x;
+            auto old_y = entry.cell_y;
+            auto old_key = cell_key(old_x, old_y);
+            unlink_object(entry);
+
+            for(auto watcher : m_cells[old_key].watchers) {
+                auto &observer = m_observers[watcher];
+                if(!observer.range.contains(cell_x, cell_y)) {
+                    m_left.push_back({watcher, object});
+                    observer.relevant_count--;
+                }
+            }
+
+            auto &cell = m_cells[cell_key(cell_x, cell_y)];
+            for(auto watcher : cell.watchers) {
+                auto &observer = m_observers[watcher];
+                if(!observer.range.contains(old_x, old_y)) {
+                    m_entered.push_back({watcher, object});
+                    observer.relevant_count++;
+                }
+            }
+            collect_cell(old_key);
+        }
+        else {
+            auto &cell = m_cells[cell_key(cell_x, cell_y)];
+            for(auto watcher : cell.watchers) {
+                m_entered.push_back({watcher, object});
+                m_observers[watcher].relevant_count++;
+            }
+        }
+
+        auto &cell = m_cells[cell_key(cell_x, cell_y)];
+        entry.cell_x = cell_x;
+        entry.cell_y = cell_y;
+        entry.cell_index = cell.objects.size();
+        cell.objects.push_back(object);
+    }
+
+    void InterestManager::remove_object(object_id_t object) noexcept {
+        auto it = m_objects.find(object);
+        if(it == m_objects.end()) {
+            return;
+        }
+
+        auto &entry = it->second;
+        auto key = cell_key(entry.cell_x, entry.cell_y);
+        for(auto watcher : m_cells[key].watchers) {
+            m_left.push_back({watcher, object});
+            m_observers[watcher].relevant_count--;
+        }
+        unlink_object(entry);
+        collect_cell(key);
+
+        // Updated objects list may keep the id; users have to skip objects without watchers
+        m_objects.erase(it);
+    }
+
+    bool InterestManager::update_observer(observer_id_t observer, const Vector3D &position, float radius) noexcept {
+        if(!std::isfinite(position.x) || !std::isfinite(position.y) || !std::isfinite(radius) || radius < 0.0f) {
+            return false;
+        }
+
+        // Every query walks the watched cells, so views are kept to a bounded square
+        radius = std::min(radius, m_cell_size * (MAX_VIEW_CELLS - 1) / 2);
+
+        CellRange range;
+        range.min_x = cell_coord(position.x - radius);
+        range.min_y = cell_coord(position.y - radius);
+        range.max_x = cell_coord(position.x + radius);
+        range.max_y = cell_coord(position.y + radius);
+
+        auto [it, inserted] = m_observers.try_emplace(observer);
+        auto &entry = it->second;
+        entry.position = position;
+
+        if(inserted) {
+            entry.relevant_count = 0;
+            entry.range = range;
+            for(auto x = range.min_x; x <= range.max_x; x++) {
+                for(auto y = range.min_y; y <= range.max_y; y++) {
+                    watch_cell(observer, entry, x, y);
+                }
+            }
+            return true;
+        }
+
+        auto old_range = entry.range;
+        if(old_range.min_x == range.min_x && old_range.min_y == range.min_y && old_range.max_x == range.max_x && old_range.max_y == range.max_y) {
+            return true;
+        }
+
+        // Only cells at the edges of the view change hands
+        for(auto x = old_range.min_x; x <= old_range.max_x; x++) {
+            for(auto y = old_range.min_y; y <= old_range.max_y; y++) {
+                if(!range.contains(x, y)) {
+                    unwatch_cell(observer, entry, x, y);
+                }
+            }
+        }
+        for(auto x = range.min_x; x <= range.max_x; x++) {
+            for(auto y = range.min_y; y <= range.max_y; y++) {
+                if(!old_range.contains(x, y)) {
+                    watch_cell(observer, entry, x, y);
+                }
+            }
+        }
+        entry.range = range;
+        return true;
+    }
+
+    void InterestManager::remove_observer(observer_id_t observer) noexcept {
+        auto it = m_observers.find(observer);
+        if(it == m_observers.end()) {
+            return;
+        }
+
+        auto &entry = it->second;
+        auto range = entry.range;
+        for(auto x = range.min_x; x <= range.max_x; x++) {
+            for(auto y = range.min_y; y <= range.max_y; y++) {
+                unwatch_cell(observer, entry, x, y);
+            }
+        }
+        m_observers.erase(it);
+    }
+
+    bool InterestManager::relevant(observer_id_t observer, object_id_t object) const noexcept {
+        auto observer_it = m_observers.find(observer);
+        auto object_it = m_objects.find(object);
+        if(observer_it == m_observers.end() || object_it == m_objects.end()) {
+            return false;
+        }
+        return observer_it->second.range.contains(object_it->second.cell_x, object_it->second.cell_y);
+    }
+
+    std::size_t InterestManager::relevant_count(observer_id_t observer) const noexcept {
+        auto it = m_observers.find(observer);
+        return it != m_observers.end() ? it->second.relevant_count : 0;
+    }
+
+    float InterestManager::distance_squared(observer_id_t observer, object_id_t object) const noexcept {
+        auto observer_it = m_observers.find(observer);
+        auto object_it = m_objects.find(object);
+        if(observer_it == m_observers.end() || object_it == m_objects.end()) {
+            return 0.0f;
+        }
+        return (observer_it->second.position - object_it->second.position).length_squared();
+    }
+
+    const std::vector<InterestManager::observer_id_t> &InterestManager::watchers(object_id_t object) const noexcept {
+        static const std::vector<observer_id_t> no_watchers;
+
+        auto object_it = m_objects.find(object);
+        if(object_it == m_objects.end()) {
+            return no_watchers;
+        }
+        auto cell_it = m_cells.find(cell_key(object_it->second.cell_x, object_it->second.cell_y));
+        return cell_it != m_cells.end() ? cell_it->second.watchers : no_watchers;
+    }
+
+    const std::vector<InterestManager::object_id_t> &InterestManager::updated_objects() const noexcept {
+        return m_updated_objects;
+    }
+
+    const std::vector<InterestManager::Event> &InterestManager::entered() const noexcept {
+        return m_entered;
+    }
+
+    const std::vector<InterestManager::Event> &InterestManager::left() const noexcept {
+        return m_left;
+    }
+
+    void InterestManager::clear_changes() noexcept {
+        for(auto object : m_updated_objects) {
+            auto it = m_objects.find(object);
+            if(it != m_objects.end()) {
+                it->second.updated = false;
+            }
+        }
+        m_updated_objects.clear();
+        m_entered.clear();
+        m_left.clear();
+    }
+
+    InterestManager::InterestManager(float cell_size) noexcept {
+        m_cell_size = cell_size;
+    }
+
+    std::int32_t InterestManager::cell_coord(float value) const noexcept {
+        // Keep far away positions in range of the cell type, with room for a view around them; NaN goes to the low end
+        constexpr float limit = 1 << 30;
+        auto cell = std::floor(value / m_cell_size);
+        if(!(cell >= -limit)) {
+            cell = -limit;
+        }
+        return static_cast<std::int32_t>(std::min(cell, limit));
+    }
+
+    InterestManager::cell_key_t InterestManager::cell_key(std::int32_t x, std::int32_t y) noexcept {
+        return (static_cast<cell_key_t>(static_cast<std::uint32_t>(x)) << 32) | static_cast<std::uint32_t>(y);
+    }
+
+    void InterestManager::unlink_object(Object &entry) noexcept {
+        auto &objects = m_cells[cell_key(entry.cell_x, entry.cell_y)].objects;
+
+        // Swap with the last object so removal is O(1)
+        auto last = objects.back();
+        objects[entry.cell_index] = last;
+        m_objects[last].cell_index = entry.cell_index;
+        objects.pop_back();
+    }
+
+    void InterestManager::unwatch_cell(observer_id_t observer, Observer &entry, std::int32_t x, std::int32_t y) noexcept {
+        auto key = cell_key(x, y);
+        auto cell_it = m_cells.find(key);
+        if(cell_it == m_cells.end()) {
+            return;
+        }
+
+        auto &cell = cell_it->second;
+        auto watcher_it = std::find(cell.watchers.begin(), cell.watchers.end(), observer);
+        if(watcher_it != cell.watchers.end()) {
+            *watcher_it = cell.watchers.back();
+            cell.watchers.pop_back();
+        }
+
+        for(auto object : cell.objects) {
+            m_left.push_back({observer, object});
+        }
+        entry.relevant_count -= cell.objects.size();
+        collect_cell(key);
+    }
+
+    void InterestManager::watch_cell(observer_id_t observer, Observer &entry, std::int32_t x, std::int32_t y) noexcept {
+        auto &cell = m_cells[cell_key(x, y)];
+        cell.watchers.push_back(observer);
+
+        for(auto object : cell.objects) {
+            m_entered.push_back({observer, object});
+        }
+        entry.relevant_count += cell.objects.size();
+    }
+
+    void InterestManager::collect_cell(cell_key_t key) noexcept {
+        auto it = m_cells.find(key);
+        if(it != m_cells.end() && it->second.objects.empty() && it->second.watchers.empty()) {
+            m_cells.erase(it);
+        }
+    }
+}
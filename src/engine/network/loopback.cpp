@@ -0,0 +1,102 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#include <blamite/network/loopback.hpp>
+
+namespace Blamite::Engine::Network {
+    void LoopbackNetwork::set_conditions(const Conditions &conditions) noexcept {
+        m_conditions = conditions;
+    }
+
+    void LoopbackNetwork::advance(duration_t duration) noexcept {
+        m_now += duration;
+    }
+
+    LoopbackNetwork::duration_t LoopbackNetwork::now() const noexcept {
+        return m_now;
+    }
+
+    LoopbackNetwork::Stats LoopbackNetwork::stats() const noexcept {
+        return m_stats;
+    }
+
+    LoopbackNetwork::LoopbackNetwork(std::uint32_t seed) noexcept : m_random(seed) {}
+
+    std::uint64_t LoopbackNetwork::key(const sockpp::inet_address &address) noexcept {
+        return static_cast<std::uint64_t>(address.address()) << 16 | address.port();
+    }
+
+    void LoopbackNetwork::send(const sockpp::inet_address &sender, const void *data, std::size_t size, const sockpp::inet_address &address) noexcept {
+        m_stats.sent++;
+
+        if(m_conditions.loss > 0.0 && std::uniform_real_distribution<double>(0.0, 1.0)(m_random) < m_conditions.loss) {
+            m_stats.lost++;
+            return;
+        }
+
+        auto transport_it = m_transports.find(key(address));
+        if(transport_it == m_transports.end()) {
+            m_stats.unreachable++;
+            return;
+        }
+
+        auto arrival = m_now + m_conditions.latency;
+        if(m_conditions.jitter.count() > 0) {
+            arrival += duration_t(std::uniform_int_distribution<duration_t::rep>(0, m_conditions.jitter.count())(m_random));
+        }
+
+        std::vector<std::byte> buffer;
+        if(!m_free_buffers.empty()) {
+            buffer = std::move(m_free_buffers.back());
+            m_free_buffers.pop_back();
+        }
+        auto *bytes = static_cast<const std::byte *>(data);
+        buffer.assign(bytes, bytes + size);
+
+        transport_it->second->m_inbox.push({arrival, m_next_sequence++, sender, std::move(buffer)});
+    }
+
+    ssize_t LoopbackNetwork::receive(inbox_t &inbox, void *buffer, std::size_t capacity, sockpp::inet_address *sender) noexcept {
+        if(inbox.empty() || inbox.top().arrival > m_now) {
+            return 0;
+        }
+
+        // The queue only hands out const references; the datagram is popped right after, so moving from it is fine
+        auto &datagram = const_cast<Datagram &>(inbox.top());
+        auto size = std::min(capacity, datagram.data.size());
+        std::memcpy(buffer, datagram.data.data(), size);
+        if(sender) {
+            *sender = datagram.sender;
+        }
+        m_free_buffers.push_back(std::move(datagram.data));
+        inbox.pop();
+
+        m_stats.delivered++;
+        return static_cast<ssize_t>(size);
+    }
+
+    ssize_t LoopbackTransport::send_to(const void *data, std::size_t size, const sockpp::inet_address &address) noexcept {
+        m_network.send(m_address, data, size, address);
+        return static_cast<ssize_t>(size);
+    }
+
+    ssize_t LoopbackTransport::receive_from(void *buffer, std::size_t capacity, sockpp::inet_address *sender) noexcept {
+        return m_network.receive(m_inbox, buffer, capacity, sender);
+    }
+
+    sockpp::inet_address LoopbackTransport::address() const noexcept {
+        return m_address;
+    }
+
+    LoopbackTransport::LoopbackTransport(LoopbackNetwork &network, sockpp::inet_address address) : m_network(network), m_address(address) {
+        if(!m_network.m_transports.emplace(LoopbackNetwork::key(address), this).second) {
+            throw std::runtime_error("Loopback address " + address.to_string() + " is already taken");
+        }
+    }
+
+    LoopbackTransport::~LoopbackTransport() noexcept {
+        m_network.m_transports.erase(LoopbackNetwork::key(m_address));
+    }
+}
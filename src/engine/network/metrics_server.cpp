@@ -0,0 +1,103 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <chrono>
+#include <cstdio>
+#include <sstream>
+#include <stdexcept>
+#include <string_view>
+#ifdef _WIN32
+#include <winsock2.h>
+#define poll WSAPoll
+#else
+#include <poll.h>
+#endif
+#include <blamite/network/metrics_server.hpp>
+
+namespace Blamite::Engine::Network {
+    std::string MetricsServer::listening_address() const noexcept {
+        std::stringstream ss;
+        ss << m_acceptor.address();
+        return ss.str();
+    }
+
+    std::size_t MetricsServer::scrapes() const noexcept {
+        return m_scrapes;
+    }
+
+    MetricsServer::MetricsServer(const Metrics &metrics, in_port_t port) : m_metrics(metrics) {
+        if(!m_acceptor.open(sockpp::inet_address("localhost", port))) {
+            std::stringstream ss;
+            ss << "Error opening the metrics socket: " << m_acceptor.last_error_str();
+            throw std::runtime_error(ss.str());
+        }
+        m_thread = std::thread(&MetricsServer::run, this);
+    }
+
+    MetricsServer::~MetricsServer() noexcept {
+        m_stopping = true;
+        m_thread.join();
+        m_acceptor.close();
+    }
+
+    void MetricsServer::run() noexcept {
+        while(!m_stopping) {
+            pollfd descriptor = {m_acceptor.handle(), POLLIN, 0};
+            if(poll(&descriptor, 1, c_poll_interval) <= 0 || !(descriptor.revents & POLLIN)) {
+                continue;
+            }
+
+            auto socket = m_acceptor.accept();
+            if(socket) {
+                serve(socket);
+            }
+        }
+    }
+
+    void MetricsServer::serve(sockpp::tcp_socket &socket) noexcept {
+        // A client that stalls only holds up other scrapes
+        auto timeout = std::chrono::milliseconds(c_request_timeout);
+        socket.read_timeout(timeout);
+        socket.write_timeout(timeout);
+
+        // Only the request line matters; read up to the end of the headers
+        std::string request;
+        char buffer[1024];
+        while(request.find("\r\n\r\n") == std::string::npos && request.size() < c_max_request_size) {
+            auto size = socket.read(buffer, sizeof(buffer));
+            if(size <= 0) {
+                return;
+            }
+            request.append(buffer, size);
+        }
+
+        std::string_view line(request);
+        line = line.substr(0, line.find("\r\n"));
+        auto method = line.substr(0, line.find(' '));
+        auto path = line.size() > method.size() ? line.substr(method.size() + 1) : std::string_view();
+        path = path.substr(0, path.find(' '));
+        path = path.substr(0, path.find('?'));
+
+        const char *status = "200 OK";
+        std::string body;
+        if(method != "GET" && method != "HEAD") {
+            status = "405 Method Not Allowed";
+            body = "Only GET is supported.\n";
+        }
+        else if(path != "/metrics") {
+            status = "404 Not Found";
+            body = "Metrics are at /metrics.\n";
+        }
+        else {
+            body = m_metrics.render();
+            m_scrapes++;
+        }
+
+        char header[256];
+        auto length = std::snprintf(header, sizeof(header), "HTTP/1.1 %s\r\nContent-Type: text/plain; version=0.0.4; charset=utf-8\r\nContent-Length: %zu\r\nConnection: close\r\n\r\n", status, body.size());
+        std::string response(header, length);
+        if(method != "HEAD") {
+            response += body;
+        }
+        socket.write(response);
+    }
+}
@@ -0,0 +1,225 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <sstream>
+#include <algorithm>
+#ifdef _WIN32
+#include <winsock2.h>
+#define poll WSAPoll
+#else
+#include <poll.h>
+#endif
+#include <blamite/network/rcon.hpp>
+
+namespace Blamite::Engine::Network {
+    std::string RconServer::listening_address() const noexcept {
+        std::stringstream ss;
+        ss << m_acceptor.address();
+        return ss.str();
+    }
+
+    std::size_t RconServer::sessions() const noexcept {
+        return m_sessions_count;
+    }
+
+    RconServer::RconServer(Console &console, in_port_t port, std::string password) : m_console(console) {
+        if(!m_acceptor.open(sockpp::inet_address("localhost", port))) {
+            std::stringstream ss;
+            ss << "Error opening the RCON socket: " << m_acceptor.last_error_str();
+            throw std::runtime_error(ss.str());
+        }
+        m_acceptor.set_non_blocking(true);
+        m_password = std::move(password);
+        m_thread = std::thread(&RconServer::run, this);
+    }
+
+    RconServer::~RconServer() noexcept {
+        m_stopping = true;
+        m_thread.join();
+        m_acceptor.close();
+    }
+
+    void RconServer::run() noexcept {
+        std::vector<pollfd> descriptors;
+        while(!m_stopping) {
+            descriptors.clear();
+            descriptors.push_back({m_acceptor.handle(), POLLIN, 0});
+            for(auto &session : m_sessions) {
+                short events = session->closing ? 0 : POLLIN;
+                if(!session->output.empty()) {
+                    events |= POLLOUT;
+                }
+                descriptors.push_back({session->socket.handle(), events, 0});
+            }
+
+            // Time out regularly since command outputs finish on other threads
+            if(poll(descriptors.data(), descriptors.size(), c_poll_interval) < 0) {
+                continue;
+            }
+
+            if(descriptors[0].revents & POLLIN) {
+                accept_sessions();
+            }
+
+            for(std::size_t i = 0; i < m_sessions.size(); i++) {
+                auto &session = *m_sessions[i];
+                auto revents = i + 1 < descriptors.size() ? descriptors[i + 1].revents : 0;
+                if(revents & (POLLIN | POLLHUP | POLLERR)) {
+                    read_session(session);
+                }
+                collect_output(session);
+                flush_session(session);
+            }
+
+            // Drop sessions that are done
+            auto it = std::remove_if(m_sessions.begin(), m_sessions.end(), [](auto &session) {
+                return session->closing && session->output.empty() && session->pending.empty();
+            });
+            for(auto session = it; session != m_sessions.end(); session++) {
+                CONSOLE_INFO(m_console, "RCON session from %s closed.", (*session)->address.c_str());
+            }
+            m_sessions.erase(it, m_sessions.end());
+            m_sessions_count = m_sessions.size();
+        }
+    }
+
+    void RconServer::accept_sessions() noexcept {
+        while(true) {
+            sockpp::inet_address address;
+            auto socket = m_acceptor.accept(&address);
+            if(!socket) {
+                break;
+            }
+
+            if(m_sessions.size() == c_max_sessions) {
+                CONSOLE_WARNING(m_console, "Refused RCON session from %s. Too many sessions.", address.to_string().c_str());
+                continue;
+            }
+
+            auto session = std::make_unique<Session>();
+            session->socket = std::move(socket);
+            session->socket.set_non_blocking(true);
+            session->address = address.to_string();
+            CONSOLE_INFO(m_console, "RCON session from %s opened.", session->address.c_str());
+            m_sessions.push_back(std::move(session));
+        }
+        m_sessions_count = m_sessions.size();
+    }
+
+    void RconServer::read_session(Session &session) noexcept {
+        char buffer[4096];
+        while(!session.closing) {
+            auto size = session.socket.read(buffer, sizeof(buffer));
+            // Peer is done sending; answer what it sent and close
+            if(size == 0) {
+                session.closing = true;
+                break;
+            }
+            if(size < 0) {
+                auto error = session.socket.last_error();
+                if(error != EAGAIN && error != EWOULDBLOCK) {
+                    session.closing = true;
+                    session.output.clear();
+                    session.pending.clear();
+                }
+                break;
+            }
+            session.input.append(buffer, size);
+
+            // Handle complete lines
+            std::size_t start = 0;
+            std::size_t end;
+            while(!session.closing && (end = session.input.find('\n', start)) != std::string::npos) {
+                std::string_view line(session.input.data() + start, end - start);
+                if(!line.empty() && line.back() == '\r') {
+                    line.remove_suffix(1);
+                }
+                process_line(session, line);
+                start = end + 1;
+            }
+            session.input.erase(0, start);
+
+            if(session.input.size() > c_max_line_length) {
+                append_frame(session, "Line too long.\n");
+                session.closing = true;
+            }
+        }
+    }
+
+    void RconServer::process_line(Session &session, std::string_view line) noexcept {
+        if(!session.authenticated) {
+            // Compare every byte so timing does not tell how much of the password matched
+            bool match = line.size() == m_password.size();
+            unsigned char difference = 0;
+            for(std::size_t i = 0; i < m_password.size(); i++) {
+                difference |= m_password[i] ^ (i < line.size() ? line[i] : 0);
+            }
+            match = match && difference == 0;
+
+            if(!match) {
+                CONSOLE_WARNING(m_console, "RCON session from %s sent a wrong password.", session.address.c_str());
+                append_frame(session, "Wrong password.\n");
+                session.closing = true;
+                return;
+            }
+            session.authenticated = true;
+            append_frame(session, "Authenticated.\n");
+            return;
+        }
+
+        if(line.empty()) {
+            return;
+        }
+        if(session.pending.size() == c_max_pending_commands) {
+            append_frame(session, "Too many pending commands.\n");
+            return;
+        }
+
+        std::string command(line);
+        CONSOLE_INFO(m_console, "RCON %s: %s", session.address.c_str(), command.c_str());
+        auto output = std::make_shared<CommandOutput>();
+        session.pending.push_back(output);
+        m_console.execute(command, std::move(output));
+    }
+
+    void RconServer::collect_output(Session &session) noexcept {
+        // Frames go out in command order, so stop at the first unfinished command
+        while(!session.pending.empty()) {
+            if(!session.pending.front()->take(session.frame)) {
+                break;
+            }
+            append_frame(session, session.frame);
+            session.frame.clear();
+            session.pending.pop_front();
+        }
+    }
+
+    void RconServer::flush_session(Session &session) noexcept {
+        while(!session.output.empty()) {
+            auto size = session.socket.write(session.output.data(), session.output.size());
+            if(size <= 0) {
+                auto error = session.socket.last_error();
+                if(size < 0 && error != EAGAIN && error != EWOULDBLOCK) {
+                    session.closing = true;
+                    session.output.clear();
+                    session.pending.clear();
+                }
+                break;
+            }
+            session.output.erase(0, size);
+        }
+
+        if(session.output.size() > c_max_output_size) {
+            CONSOLE_WARNING(m_console, "RCON session from %s is not reading its output.", session.address.c_str());
+            session.closing = true;
+            session.output.clear();
+            session.pending.clear();
+        }
+    }
+
+    void RconServer::append_frame(Session &session, std::string_view text) noexcept {
+        char header[32];
+        auto length = std::snprintf(header, sizeof(header), "#%u %zu\n", session.sequence++, text.size());
+        session.output.append(header, length);
+        session.output.append(text);
+    }
+}
@@ -0,0 +1,216 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <algorithm>
+#include <stdexcept>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+#include <blamite/network/replay.hpp>
+
+namespace Blamite::Engine::Network {
+    namespace {
+        /** Recorder stdio buffer size */
+        constexpr std::size_t c_recorder_buffer_size = 1024 * 1024;
+    }
+
+    void TrafficRecorder::record(std::uint32_t tick, std::uint32_t offset, const sockpp::inet_address &sender, const void *data, std::size_t size) noexcept {
+        TrafficRecordHeader header;
+        header.type = TrafficRecordHeader::TYPE_DATAGRAM;
+        header.tick = tick;
+        header.offset = offset;
+        header.address = sender.address();
+        header.port = sender.port();
+        header.size = static_cast<std::uint16_t>(std::min<std::size_t>(size, UINT16_MAX));
+
+        std::fwrite(&header, sizeof(header), 1, m_file);
+        std::fwrite(data, 1, header.size, m_file);
+        m_recorded++;
+    }
+
+    void TrafficRecorder::record_tick_rate(std::uint32_t tick, std::uint16_t tick_rate) noexcept {
+        TrafficRecordHeader header = {};
+        header.type = TrafficRecordHeader::TYPE_TICK_RATE;
+        header.tick = tick;
+        header.size = sizeof(tick_rate);
+
+        std::fwrite(&header, sizeof(header), 1, m_file);
+        std::fwrite(&tick_rate, sizeof(tick_rate), 1, m_file);
+    }
+
+    std::size_t TrafficRecorder::recorded() const noexcept {
+        return m_recorded;
+    }
+
+    const std::string &TrafficRecorder::path() const noexcept {
+        return m_path;
+    }
+
+    TrafficRecorder::TrafficRecorder(std::string path, std::uint32_t seed, std::uint16_t tick_rate) : m_path(std::move(path)) {
+        m_file = std::fopen(m_path.c_str(), "wb");
+        if(!m_file) {
+            throw std::runtime_error("Failed to create traffic recording " + m_path + ": " + std::strerror(errno));
+        }
+        m_buffer = std::make_unique<char[]>(c_recorder_buffer_size);
+        std::setvbuf(m_file, m_buffer.get(), _IOFBF, c_recorder_buffer_size);
+
+        TrafficFileHeader header;
+        std::copy(std::begin(TrafficFileHeader::MAGIC), std::end(TrafficFileHeader::MAGIC), header.magic);
+        header.version = TrafficFileHeader::VERSION;
+        header.tick_rate = tick_rate;
+        header.seed = seed;
+        std::fwrite(&header, sizeof(header), 1, m_file);
+    }
+
+    TrafficRecorder::~TrafficRecorder() noexcept {
+        std::fclose(m_file);
+    }
+
+    bool TrafficReplay::next(Datagram &datagram) noexcept {
+        if(m_size - m_position < sizeof(TrafficRecordHeader)) {
+            return false;
+        }
+        std::memcpy(&datagram.header, m_data + m_position, sizeof(TrafficRecordHeader));
+        if(m_size - m_position - sizeof(TrafficRecordHeader) < datagram.header.size) {
+            // The server was probably killed halfway through a write
+            m_position = m_size;
+            return false;
+        }
+        datagram.data = m_data + m_position + sizeof(TrafficRecordHeader);
+        m_position += sizeof(TrafficRecordHeader) + datagram.header.size;
+        return true;
+    }
+
+    const TrafficFileHeader &TrafficReplay::header() const noexcept {
+        return m_header;
+    }
+
+    TrafficReplay::TrafficReplay(const std::string &path) {
+        #ifdef _WIN32
+        std::ifstream file(path, std::ios::binary);
+        if(!file) {
+            throw std::runtime_error("Failed to open traffic recording " + path);
+        }
+        file.seekg(0, std::ios::end);
+        m_contents.resize(static_cast<std::size_t>(file.tellg()));
+        file.seekg(0);
+        file.read(reinterpret_cast<char *>(m_contents.data()), m_contents.size());
+        m_data = m_contents.data();
+        m_size = m_contents.size();
+        #else
+        int fd = open(path.c_str(), O_RDONLY);
+        if(fd < 0) {
+            throw std::runtime_error("Failed to open traffic recording " + path + ": " + std::strerror(errno));
+        }
+        struct stat status;
+        if(fstat(fd, &status) == 0 && status.st_size > 0) {
+            void *mapping = mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if(mapping != MAP_FAILED) {
+                m_data = static_cast<const std::byte *>(mapping);
+                m_size = status.st_size;
+                madvise(mapping, m_size, MADV_SEQUENTIAL);
+            }
+        }
+        close(fd);
+        #endif
+
+        if(m_size < sizeof(TrafficFileHeader)) {
+            unmap();
+            throw std::runtime_error(path + " is not a traffic recording");
+        }
+        std::memcpy(&m_header, m_data, sizeof(m_header));
+        if(std::memcmp(m_header.magic, TrafficFileHeader::MAGIC, sizeof(m_header.magic)) != 0 || m_header.version != TrafficFileHeader::VERSION) {
+            unmap();
+            throw std::runtime_error(path + " is not a traffic recording or has an unsupported version");
+        }
+    }
+
+    TrafficReplay::~TrafficReplay() noexcept {
+        unmap();
+    }
+
+    void TrafficReplay::unmap() noexcept {
+        #ifndef _WIN32
+        if(m_data) {
+            munmap(const_cast<std::byte *>(m_data), m_size);
+        }
+        #endif
+        m_data = nullptr;
+        m_size = 0;
+    }
+
+    ssize_t ReplayTransport::send_to(const void *, std::size_t size, const sockpp::inet_address &) noexcept {
+        m_sent++;
+        return static_cast<ssize_t>(size);
+    }
+
+    ssize_t ReplayTransport::receive_from(void *buffer, std::size_t capacity, sockpp::inet_address *sender) noexcept {
+        // Rate changes are taken on advance, before the tick they apply to
+        if(!m_has_next || m_next.header.tick > m_tick || m_next.header.type != TrafficRecordHeader::TYPE_DATAGRAM) {
+            return 0;
+        }
+
+        auto size = std::min<std::size_t>(capacity, m_next.header.size);
+        std::memcpy(buffer, m_next.data, size);
+        if(sender) {
+            *sender = sockpp::inet_address(m_next.header.address, m_next.header.port);
+        }
+
+        m_received++;
+        m_has_next = m_replay->next(m_next);
+        return static_cast<ssize_t>(size);
+    }
+
+    sockpp::inet_address ReplayTransport::address() const noexcept {
+        return m_address;
+    }
+
+    void ReplayTransport::advance() noexcept {
+        // Start where the recording starts, so idle time before the first datagram is skipped
+        if(!m_started) {
+            m_tick = m_has_next ? m_next.header.tick : 0;
+            m_started = true;
+        }
+        else {
+            m_tick++;
+        }
+
+        while(m_has_next && m_next.header.tick <= m_tick && m_next.header.type == TrafficRecordHeader::TYPE_TICK_RATE) {
+            if(m_next.header.size == sizeof(m_tick_rate)) {
+                std::memcpy(&m_tick_rate, m_next.data, sizeof(m_tick_rate));
+            }
+            m_has_next = m_replay->next(m_next);
+        }
+    }
+
+    std::uint16_t ReplayTransport::tick_rate() const noexcept {
+        return m_tick_rate;
+    }
+
+    bool ReplayTransport::finished() const noexcept {
+        return !m_has_next;
+    }
+
+    std::size_t ReplayTransport::received() const noexcept {
+        return m_received;
+    }
+
+    std::size_t ReplayTransport::sent() const noexcept {
+        return m_sent;
+    }
+
+    const TrafficReplay &ReplayTransport::replay() const noexcept {
+        return *m_replay;
+    }
+
+    ReplayTransport::ReplayTransport(std::unique_ptr<TrafficReplay> replay, sockpp::inet_address address) noexcept : m_replay(std::move(replay)), m_address(address) {
+        m_tick_rate = m_replay->header().tick_rate;
+        m_has_next = m_replay->next(m_next);
+    }
+}
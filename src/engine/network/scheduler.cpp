@@ -0,0 +1,107 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <algorithm>
+#include <blamite/network/scheduler.hpp>
+
+namespace Blamite::Engine::Network {
+    void OutboundScheduler::set_bandwidth(std::size_t bytes_per_second) noexcept {
+        m_bandwidth = bytes_per_second;
+    }
+
+    std::size_t OutboundScheduler::bandwidth() const noexcept {
+        return m_bandwidth;
+    }
+
+    void OutboundScheduler::set_tick_rate(std::uint16_t ticks_per_second) noexcept {
+        m_tick_rate = std::max<std::uint16_t>(ticks_per_second, 1);
+    }
+
+    bool OutboundScheduler::queue_update(object_id_t object, float priority, const std::byte *data, std::size_t size) noexcept {
+        if(size > MAX_PAYLOAD_SIZE) {
+            return false;
+        }
+
+        auto [it, inserted] = m_entries.try_emplace(object);
+        auto &entry = it->second;
+        if(inserted) {
+            entry.object = object;
+            entry.accumulator = 0.0f;
+        }
+        entry.priority = priority;
+        entry.pending = true;
+        entry.payload.assign(data, data + size);
+        return true;
+    }
+
+    void OutboundScheduler::remove_object(object_id_t object) noexcept {
+        m_entries.erase(object);
+    }
+
+    void OutboundScheduler::consume(std::size_t bytes) noexcept {
+        m_credit -= bytes;
+        m_consumed += bytes;
+        m_stats.total_sent += bytes;
+    }
+
+    std::size_t OutboundScheduler::build(raw_packet_t &packet, std::size_t mtu) noexcept {
+        // Close stats of the previous tick
+        m_stats.budget = m_tick_budget;
+        m_stats.sent = m_consumed;
+        m_consumed = 0;
+
+        // Earn this tick's share of the budget; unused credit carries over up to one extra tick
+        std::int64_t tick_budget = m_bandwidth / m_tick_rate;
+        m_credit = std::min(m_credit + tick_budget, tick_budget * 2);
+        m_tick_budget = std::max<std::int64_t>(m_credit, 0);
+
+        // Accumulate priority of waiting updates
+        m_candidates.clear();
+        for(auto &[object, entry] : m_entries) {
+            if(entry.pending) {
+                entry.accumulator += entry.priority;
+                m_candidates.push_back(&entry);
+            }
+        }
+        std::sort(m_candidates.begin(), m_candidates.end(), [](Entry *a, Entry *b) {
+            return a->accumulator > b->accumulator;
+        });
+
+        // Pack the most starving updates that fit; the packet is charged to the budget when it is sent
+        std::int64_t room = std::min<std::int64_t>(m_credit, mtu) - packet.size();
+        std::int64_t packet_room = static_cast<std::int64_t>(mtu) - packet.size();
+        std::size_t packed = 0;
+        m_stats.deferred_updates = 0;
+        for(auto *entry : m_candidates) {
+            std::int64_t update_size = sizeof(UpdateHeader) + entry->payload.size();
+            if(packet_room < update_size) {
+                entry->accumulator = 0.0f;
+                entry->pending = false;
+                m_stats.dropped_updates++;
+                continue;
+            }
+            if(room < update_size) {
+                m_stats.deferred_updates++;
+                continue;
+            }
+
+            UpdateHeader header;
+            header.object = entry->object;
+            header.size = entry->payload.size();
+            auto *header_data = reinterpret_cast<std::byte *>(&header);
+            packet.insert(packet.end(), header_data, header_data + sizeof(header));
+            packet.insert(packet.end(), entry->payload.begin(), entry->payload.end());
+
+            room -= update_size;
+            entry->accumulator = 0.0f;
+            entry->pending = false;
+            packed++;
+        }
+        m_stats.sent_updates = packed;
+
+        return packed;
+    }
+
+    const OutboundScheduler::Stats &OutboundScheduler::stats() const noexcept {
+        return m_stats;
+    }
+}
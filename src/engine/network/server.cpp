@@ -3,6 +3,11 @@
 #include <iostream>
 #include <exception>
 #include <sstream>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iterator>
+#include <blamite/core/trace.hpp>
 #include <blamite/core/version.hpp>
 #include <blamite/engine.hpp>
 #include <blamite/memory/bitstream.hpp>
@@ -12,7 +17,69 @@
 #include <aluigi/gssdkcr.h>
 
 namespace Blamite::Engine::Network {
-    Server::Client::Client(sockpp::inet_address address, std::uint8_t *client_public_key) noexcept {
+    namespace {
+        /** Packet types told apart by metrics */
+        constexpr std::pair<std::uint8_t, const char *> c_packet_type_labels[] = {
+            {PACKET_TYPE_ENCRYPTED, "encrypted"},
+            {PACKET_TYPE_HANDSHAKE_CLIENT_CHALLENGE, "handshake_client_challenge"},
+            {PACKET_TYPE_HANDSHAKE_SERVER_RESPONSE_CHALLENGE, "handshake_server_response_challenge"},
+            {PACKET_TYPE_HANDSHAKE_CLIENT_RESPONSE, "handshake_client_response"},
+            {PACKET_TYPE_HANDSHAKE_SUCCESS, "handshake_success"},
+            {PACKET_TYPE_HANDSHAKE_FAILED, "handshake_failed"},
+            {PACKET_TYPE_CLIENT_CONNECTION_ESTABLISHED, "client_connection_established"},
+            {PACKET_TYPE_DISCONNECTION, "disconnection"}
+        };
+
+        /** Refusal reasons told apart by metrics, in reason order */
+        constexpr const char *c_refusal_labels[] = {
+            "incompatible_network_protocol_version",
+            "older_client_version",
+            "newer_client_version",
+            "server_full"
+        };
+
+        /**
+         * Get metric index of a datagram packet type
+         * @return      Index in c_packet_type_labels, or its size for anything else
+         */
+        std::size_t packet_type_index(const void *data, std::size_t size) noexcept {
+            constexpr std::size_t count = std::size(c_packet_type_labels);
+            if(size < sizeof(PacketHeader)) {
+                return count;
+            }
+            PacketHeader header;
+            std::memcpy(&header, data, sizeof(header));
+            if(header.gssdk_header != PacketHeader::GSSDK_HEADER) {
+                return count;
+            }
+            for(std::size_t i = 0; i < count; i++) {
+                if(c_packet_type_labels[i].first == header.type) {
+                    return i;
+                }
+            }
+            return count;
+        }
+
+        /**
+         * Make a key pair like halo_generate_keys, but from a seed instead of the clock
+         * @param private_key   Private key output, 16 hex digits and a terminator
+         * @param public_key    Public key output
+         */
+        void generate_private_key(std::uint32_t seed, std::uint8_t *private_key, std::uint8_t *public_key) noexcept {
+            static constexpr char hex[] = "0123456789ABCDEF";
+            for(int i = 0; i < 16; i++) {
+                seed = seed * 0x343FD + 0x269EC3;
+                private_key[i] = hex[(seed >> 16) & 15];
+            }
+            private_key[16] = 0;
+
+            std::uint8_t key[] = "3";
+            std::uint8_t fixed_key[] = "10001";
+            halo_create_key(key, private_key, fixed_key, public_key);
+        }
+    }
+
+    Server::Client::Client(sockpp::inet_address address, std::uint8_t *client_public_key, std::uint32_t key_seed, TimerWheel &timers, timer_tick_t fragment_timeout) noexcept : m_reassembler(timers, fragment_timeout) {
         m_address = address;
 
         // Set packet counts
@@ -20,40 +87,75 @@ namespace Blamite::Engine::Network {
         m_server_packet_count = 1;
 
         // Create keys
-        halo_generate_keys(m_private_key, NULL, m_public_key);
+        TRACE_SCOPE("generate keys");
+        generate_private_key(key_seed, m_private_key, m_public_key);
         halo_generate_keys(m_private_key, client_public_key, m_dec_key);
         halo_generate_keys(m_private_key, client_public_key, m_enc_key);
     }
 
     std::string Server::listening_address() noexcept {
         std::stringstream ss;
-        ss << m_socket.address();
+        ss << m_transport->address();
         return ss.str();
     }
 
     void Server::read_data() noexcept {
-        ssize_t data_length;
-        std::byte data_buffer[1024 * 4]; // Allocate 4 kb
-        sockpp::inet_address sender_address;
-
-        while((data_length = m_socket.recv_from(data_buffer, sizeof(data_buffer), &sender_address)) > 0) {
-            m_received_raw_data.push({sender_address, raw_packet_t(data_buffer, data_buffer + data_length)});
+        TRACE_SCOPE("read data");
+        while(m_received_datagrams.size() < c_max_datagrams_per_tick) {
+            sockpp::inet_address sender_address;
+            auto buffer = m_datagram_pool->acquire();
+            auto data_length = m_transport->receive_from(buffer.data(), buffer.capacity(), &sender_address);
+            if(data_length <= 0) {
+                break;
+            }
+            m_metrics.packets_received[packet_type_index(buffer.data(), data_length)]->add();
+            m_metrics.bytes_received->add(data_length);
+            if(m_capture) {
+                m_capture->record(PacketCapture::DIRECTION_IN, sender_address, buffer.data(), data_length);
+            }
+            if(m_recorder) {
+                auto offset = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_engine.tick_start());
+                m_recorder->record(static_cast<std::uint32_t>(m_engine.tick_count()), static_cast<std::uint32_t>(offset.count()), sender_address, buffer.data(), data_length);
+            }
+            m_received_datagrams.push_back({sender_address, std::move(buffer), static_cast<std::size_t>(data_length)});
         }
+        m_received_count = m_received_datagrams.size();
+        m_metrics.received_queue->set(m_received_count);
     }
 
     void Server::process_received_data() noexcept {
-        auto &engine = Engine::get();
-        auto &console = engine.console();
-
-        for(std::size_t i = 0; i < m_received_raw_data.size(); i++) {
-            auto &[sender_address, raw_data] = m_received_raw_data.front();
-            auto *packet_header = reinterpret_cast<PacketHeader *>(raw_data.data());
+        TRACE_SCOPE("process received data");
+        auto &console = m_engine.console();
+
+        for(auto &datagram : m_received_datagrams) {
+            auto &sender_address = datagram.address;
+            auto *raw_data = datagram.buffer.data();
+            auto *packet_header = reinterpret_cast<PacketHeader *>(raw_data);
+
+            if(datagram.size >= sizeof(PacketHeader) && packet_header->gssdk_header == PacketHeader::GSSDK_HEADER) {
+                auto *sender = get_client(sender_address);
+                if(sender) {
+                    touch_client(*sender);
+
+                    // Anything but a repeated handshake acknowledges our handshake response
+                    if(packet_header->type != PACKET_TYPE_HANDSHAKE_CLIENT_RESPONSE) {
+                        m_timers.cancel(sender->m_retransmit_timer);
+                    }
+                }
 
-            if(packet_header->gssdk_header == PacketHeader::GSSDK_HEADER) {
-                if(packet_header->type == PACKET_TYPE_HANDSHAKE_CLIENT_CHALLENGE) {
-                    auto *packet = reinterpret_cast<ClientChallengePacket *>(raw_data.data());
+                if(packet_header->type == PACKET_TYPE_ENCRYPTED) {
+                    if(sender && datagram.size > sizeof(Packet)) {
+                        sender->m_reassembler.push(datagram.buffer, sizeof(Packet), datagram.size - sizeof(Packet), [this, sender](auto &message) {
+                            process_message(*sender, message);
+                        });
+                    }
+                }
+                else if(packet_header->type == PACKET_TYPE_HANDSHAKE_CLIENT_CHALLENGE) {
+                    TRACE_SCOPE("handshake challenge");
+                    auto *packet = reinterpret_cast<ClientChallengePacket *>(raw_data);
 
-                    console.printf("Connection request from %s. Sending challenge...", sender_address.to_string().c_str());
+                    CONSOLE_INFO(console, "Connection request from %s. Sending challenge...", sender_address.to_string().c_str());
+                    m_metrics.challenges->add();
                     
                     // Response header
                     ServerChallengeResponsePacket response;
@@ -69,29 +171,41 @@ namespace Blamite::Engine::Network {
                     auto server_challenge = resolve_handshake_challenge(response.client_challenge_response);
                     std::copy(server_challenge.begin(), server_challenge.end(), response.challenge);
 
-                    m_socket.send_to(response.data(), sizeof(response), sender_address);
+                    transmit(response.data(), sizeof(response), sender_address);
                 }
                 else if(packet_header->type == PACKET_TYPE_HANDSHAKE_CLIENT_RESPONSE) {
-                    auto *packet = reinterpret_cast<ClientHandshake *>(raw_data.data());
+                    TRACE_SCOPE("handshake response");
+                    auto *packet = reinterpret_cast<ClientHandshake *>(raw_data);
 
-                    if(packet->version == CLIENT_VERSION) {
-                        console.printf("Connection from %s accepted. Generating keys...", sender_address.to_string().c_str());
+                    if(sender) {
+                        // Our response got lost, send it again
+                        send_handshake(*sender);
+                    }
+                    else if(packet->version == CLIENT_VERSION) {
+                        CONSOLE_INFO(console, "Connection from %s accepted. Generating keys...", sender_address.to_string().c_str());
 
                         // Create client
                         if(m_clients.size() == c_max_client_number) {
                             refuse_connection(sender_address, ConnectionRefusePacket::REASON_SERVER_FULL);
                         }
                         else {
-                            auto &client = m_clients.emplace_back(sender_address, packet->enc_key);
-
-                            ServerHandshake response;
-                            response.header.type = PACKET_TYPE_HANDSHAKE_SUCCESS;
-                            response.server_packet_count = htons(1);
-                            response.client_packet_count = htons(2);
-
-                            std::copy(client.m_public_key, client.m_public_key + sizeof(client.m_public_key), response.enc_key);
-
-                            send_packet(sender_address, raw_packet_t(response.data(), response.data() + sizeof(ServerHandshake)));
+                            auto keys_start = std::chrono::steady_clock::now();
+                            auto &client = *m_clients.emplace_back(std::make_unique<Client>(sender_address, packet->enc_key, m_random(), m_timers, c_fragment_timeout));
+                            m_metrics.key_time->observe(std::chrono::duration<double>(std::chrono::steady_clock::now() - keys_start).count());
+                            m_metrics.handshakes->add();
+                            client.m_id = m_next_client_id++;
+                            client.m_scheduler.set_bandwidth(m_client_bandwidth);
+                            client.m_scheduler.set_tick_rate(m_tick_rate);
+                            touch_client(client);
+                            send_handshake(client);
+
+                            if(auto *event_log = m_engine.event_log()) {
+                                ConnectEvent event;
+                                event.client_id = client.m_id;
+                                event.address = sender_address.address();
+                                event.port = sender_address.port();
+                                event_log->write(event);
+                            }
                         }
                     }
                     else {
@@ -104,57 +218,266 @@ namespace Blamite::Engine::Network {
                     }
                 }
                 else if(packet_header->type == PACKET_TYPE_DISCONNECTION) {
-                    auto client_it = m_clients.begin();
-                    while(client_it != m_clients.end()) {
-                        if(client_it->m_address == sender_address) {
-                            m_clients.erase(client_it);
-                            break;
-                        }
-                        client_it++;
+                    if(sender) {
+                        drop_client(*sender, DISCONNECT_REASON_CLIENT);
                     }
-                    
-                    // Who are you?
-                    if(client_it == m_clients.end()) {
+                    else {
+                        // Who are you?
                         auto client_ip = sender_address.to_string();
-                        console.printf("Disconnection signal received from unknown client (%s).", client_ip.c_str());
+                        CONSOLE_DEBUG(console, "Disconnection signal received from unknown client (%s).", client_ip.c_str());
                     }
                 }
             }
-            m_received_raw_data.pop();
         }
+        m_received_datagrams.clear();
     }
 
-    Server::Server(in_port_t port) {
-        if(!m_socket) {
-            std::stringstream ss;
-            ss << "Error creating the UDP v4 socket: " << m_socket.last_error_str();
-            throw std::runtime_error(ss.str());
+    void Server::process_timers(std::size_t steps) noexcept {
+        TRACE_SCOPE("timers");
+        for(std::size_t i = 0; i < steps; i++) {
+            m_timers.advance();
         }
+    }
 
-        if(!m_socket.bind(sockpp::inet_address("localhost", port))) {
-            std::stringstream ss;
-		    ss << "Error binding the UDP v4 socket: " << m_socket.last_error_str();
-            throw std::runtime_error(ss.str());
+    void Server::set_tick_rate(std::uint16_t ticks_per_second) noexcept {
+        if(m_recorder && ticks_per_second != m_tick_rate) {
+            m_recorder->record_tick_rate(static_cast<std::uint32_t>(m_engine.tick_count()), ticks_per_second);
         }
+        m_tick_rate = ticks_per_second;
+        for(auto &client : m_clients) {
+            client->m_scheduler.set_tick_rate(ticks_per_second);
+        }
+    }
 
-        m_socket.set_non_blocking(true);
+    bool Server::queue_update(sockpp::inet_address address, object_id_t object, float priority, const std::byte *data, std::size_t size) noexcept {
+        auto *client = get_client(address);
+        if(!client) {
+            return false;
+        }
+
+        // Updates are not fragmented, so one that cannot fit a packet would never be sent
+        if(sizeof(Packet) + sizeof(FragmentHeader) + sizeof(OutboundScheduler::UpdateHeader) + size > m_path_mtu || !client->m_scheduler.queue_update(object, priority, data, size)) {
+            CONSOLE_WARNING(m_engine.console(), "Update of object %u is %zu bytes, too large for a %zu byte path MTU; not queued.", object, size, m_path_mtu);
+            return false;
+        }
+        return true;
     }
 
-    Server::~Server() noexcept {
-        // Shut down socket reads
-        m_socket.shutdown(SHUT_RD);
+    void Server::update_object(object_id_t object, const Vector3D &position, float priority, const std::byte *state, std::size_t size) noexcept {
+        auto &entry = m_objects[object];
+        entry.priority = priority;
+        entry.state.assign(state, state + size);
+        m_interest.update_object(object, position);
+    }
 
-        // Send disconnection signal before close server
-        disconnect_clients();
+    void Server::remove_object(object_id_t object) noexcept {
+        m_objects.erase(object);
+        m_interest.remove_object(object);
+    }
+
+    bool Server::set_client_view(std::uint32_t client_id, const Vector3D &position, float radius) noexcept {
+        return get_client(client_id) && m_interest.update_observer(client_id, position, radius);
+    }
+
+    bool Server::send_message(sockpp::inet_address address, const std::byte *data, std::size_t size) noexcept {
+        auto *client = get_client(address);
+        if(client) {
+            return send_message(*client, data, size);
+        }
+        return false;
+    }
+
+    void Server::set_path_mtu(std::size_t mtu) noexcept {
+        m_path_mtu = std::clamp(mtu, MIN_PATH_MTU, MAX_DATAGRAM_SIZE);
+    }
+
+    std::size_t Server::path_mtu() const noexcept {
+        return m_path_mtu;
+    }
+
+    void Server::send_scheduled_updates(JobSystem *jobs) noexcept {
+        TRACE_SCOPE("send updates");
+        replicate_objects();
+
+        // Packing only touches the client's own scheduler, so clients can be packed in parallel
+        auto pack = [this](std::size_t begin, std::size_t end) {
+            TRACE_SCOPE("pack updates");
+            for(auto i = begin; i < end; i++) {
+                auto &client = *m_clients[i];
+                Packet header;
+                header.header.type = PACKET_TYPE_ENCRYPTED;
+                header.server_packet_count = htons(client.m_server_packet_count);
+                header.client_packet_count = htons(client.m_packet_count);
+
+                // Updates go out as single-fragment messages, like every other encrypted payload
+                FragmentHeader fragment_header;
+                fragment_header.message_id = client.m_next_message_id;
+                fragment_header.index = 0;
+                fragment_header.count = 1;
+                auto *fragment_header_data = reinterpret_cast<std::byte *>(&fragment_header);
+
+                auto &packet_data = client.m_outbound_packet;
+                packet_data.assign(header.data(), header.data() + sizeof(Packet));
+                packet_data.insert(packet_data.end(), fragment_header_data, fragment_header_data + sizeof(FragmentHeader));
+                if(client.m_scheduler.build(packet_data, m_path_mtu) == 0) {
+                    packet_data.clear();
+                }
+                else {
+                    client.m_next_message_id++;
+                }
+            }
+        };
+
+        if(jobs && m_clients.size() > 1) {
+            m_send_graph.clear();
+            m_send_graph.add_range(m_clients.size(), 1, pack);
+            jobs->run(m_send_graph);
+        }
+        else {
+            pack(0, m_clients.size());
+        }
 
-        // Close socket
-        m_socket.close();
+        // Sending reschedules timers, which are shared
+        std::size_t deferred_updates = 0;
+        for(auto &client : m_clients) {
+            if(!client->m_outbound_packet.empty()) {
+                send_packet(*client, client->m_outbound_packet);
+            }
+            deferred_updates += client->m_scheduler.stats().deferred_updates;
+        }
+        m_metrics.deferred_updates->set(deferred_updates);
+    }
+
+    void Server::set_client_bandwidth(std::size_t bytes_per_second) noexcept {
+        m_client_bandwidth = bytes_per_second;
+        for(auto &client : m_clients) {
+            client->m_scheduler.set_bandwidth(bytes_per_second);
+        }
+    }
+
+    std::size_t Server::client_bandwidth() const noexcept {
+        return m_client_bandwidth;
+    }
+
+    std::size_t Server::clients_count() const noexcept {
+        return m_clients.size();
+    }
+
+    std::size_t Server::received_count() const noexcept {
+        return m_received_count;
+    }
+
+    std::vector<Server::ClientInfo> Server::clients_info() const noexcept {
+        std::vector<ClientInfo> info;
+        for(auto &client : m_clients) {
+            auto &reassembler = client->m_reassembler;
+            info.push_back({client->m_id, client->m_address.to_string(), client->m_scheduler.bandwidth(), client->m_scheduler.stats(), 
+                client->m_received_messages, reassembler.held_fragments(), reassembler.dropped_messages(), 
+                m_interest.relevant_count(client->m_id)});
+        }
+        return info;
+    }
+
+    void Server::start_capture(std::size_t slots) {
+        // Drop the old ring first so both are never held at once
+        m_capture.reset();
+        m_capture = std::make_unique<PacketCapture>(slots);
+    }
+
+    void Server::stop_capture() noexcept {
+        m_capture.reset();
+    }
+
+    PacketCapture *Server::capture() noexcept {
+        return m_capture.get();
+    }
+
+    bool Server::dump_capture(const std::string &path, bool decrypt, CaptureDump &dump) noexcept {
+        if(!m_capture) {
+            return false;
+        }
+
+        auto records = m_capture->snapshot();
+        dump = {records.size(), 0};
+
+        // Clients encrypt the message payload and its checksum after the headers; a matching checksum tells
+        // the key was right. Clients that left since have taken their keys with them.
+        constexpr std::size_t headers_size = sizeof(Packet) + sizeof(FragmentHeader);
+        if(decrypt) {
+            for(auto &record : records) {
+                auto *header = reinterpret_cast<PacketHeader *>(record.data.data());
+                bool complete = record.data.size() == record.size && record.size >= headers_size + 8;
+                if(record.direction != PacketCapture::DIRECTION_IN || !complete || header->type != PACKET_TYPE_ENCRYPTED) {
+                    continue;
+                }
+                auto *client = get_client(record.peer);
+                if(!client) {
+                    continue;
+                }
+
+                std::vector<std::byte> payload(record.data.begin() + headers_size, record.data.end());
+                auto *payload_data = reinterpret_cast<std::uint8_t *>(payload.data());
+                halo_tea_decrypt(payload_data, payload.size(), client->m_dec_key);
+
+                crc32_t crc;
+                auto crc_offset = payload.size() - sizeof(crc);
+                std::memcpy(&crc, payload_data + crc_offset, sizeof(crc));
+                if(crc == halo_crc32(payload_data, crc_offset)) {
+                    std::copy(payload.begin(), payload.end(), record.data.begin() + headers_size);
+                    dump.decrypted++;
+                }
+            }
+        }
+
+        return PacketCapture::write_pcap(path, m_transport->address(), records);
+    }
+
+    void Server::start_recording(std::string path) {
+        std::uint32_t seed = std::random_device{}();
+        m_recorder = std::make_unique<TrafficRecorder>(std::move(path), seed, m_tick_rate);
+        m_random.seed(seed);
+    }
+
+    void Server::stop_recording() noexcept {
+        m_recorder.reset();
+    }
+
+    TrafficRecorder *Server::recorder() noexcept {
+        return m_recorder.get();
+    }
+
+    void Server::set_random_seed(std::uint32_t seed) noexcept {
+        m_random.seed(seed);
+    }
+
+    Server::Server(Engine &engine, in_port_t port, BufferPool *datagram_pool) : Server(engine, std::make_unique<UdpTransport>(port), datagram_pool) {}
+
+    Server::Server(Engine &engine, std::unique_ptr<Transport> transport, BufferPool *datagram_pool) noexcept : m_engine(engine), m_transport(std::move(transport)), m_datagram_pool(datagram_pool) {
+        register_metrics();
+        if(!m_datagram_pool) {
+            m_own_datagram_pool = std::make_unique<BufferPool>(MAX_DATAGRAM_SIZE, 64);
+            m_datagram_pool = m_own_datagram_pool.get();
+        }
+    }
+
+    Server::~Server() noexcept {
+        // Send disconnection signal before the transport goes away
+        disconnect_clients();
     }
 
     Server::Client *Server::get_client(sockpp::inet_address address) noexcept {
         for(auto &client : m_clients) {
-            if(client.m_address == address) {
-                return &client;
+            if(client->m_address == address) {
+                return client.get();
+            }
+        }
+        return nullptr;
+    }
+
+    Server::Client *Server::get_client(std::uint32_t id) noexcept {
+        for(auto &client : m_clients) {
+            if(client->m_id == id) {
+                return client.get();
             }
         }
         return nullptr;
@@ -163,20 +486,151 @@ namespace Blamite::Engine::Network {
     bool Server::send_packet(sockpp::inet_address address, raw_packet_t packet_data) noexcept {
         auto *client = get_client(address);
         if(client) {
-            m_socket.send_to(packet_data.data(), packet_data.size(), client->m_address);
-            auto &console = Engine::get().console();
-            console.printf("Sent %d bytes to %s", packet_data.size(), address.to_string().c_str());
-            client->m_server_packet_count++;
+            send_packet(*client, packet_data);
             return true;
         }
         return false;
     }
 
-    std::vector<std::byte> Server::resolve_handshake_challenge(std::byte *challenge) noexcept {
-        std::vector<std::byte> output;
-        output.assign(32, std::byte(0));
+    void Server::send_packet(Client &client, const raw_packet_t &packet_data) noexcept {
+        send_packet(client, packet_data.data(), packet_data.size());
+    }
+
+    void Server::send_packet(Client &client, const std::byte *data, std::size_t size) noexcept {
+        transmit(data, size, client.m_address);
+        auto &console = m_engine.console();
+        CONSOLE_TRACE(console, "Sent %zu bytes to client %u", size, client.m_id);
+        client.m_server_packet_count++;
+        client.m_scheduler.consume(size);
+
+        // Push keepalive back since the client just heard from us
+        m_timers.cancel(client.m_keepalive_timer);
+        client.m_keepalive_timer = m_timers.schedule(c_keepalive_interval, [this, &client]() {
+            send_keepalive(client);
+        });
+    }
+
+    bool Server::send_message(Client &client, const std::byte *data, std::size_t size) noexcept {
+        std::size_t fragment_size = m_path_mtu - sizeof(Packet) - sizeof(FragmentHeader);
+        std::size_t fragment_count = size > 0 ? (size + fragment_size - 1) / fragment_size : 1;
+        if(fragment_count > Reassembler::MAX_FRAGMENTS) {
+            return false;
+        }
+
+        FragmentHeader fragment_header;
+        fragment_header.message_id = client.m_next_message_id++;
+        fragment_header.count = fragment_count;
+
+        std::pmr::vector<std::byte> packet_data(&m_engine.frame_arena());
+        packet_data.reserve(m_path_mtu);
+        for(std::size_t i = 0; i < fragment_count; i++) {
+            Packet header;
+            header.header.type = PACKET_TYPE_ENCRYPTED;
+            header.server_packet_count = htons(client.m_server_packet_count);
+            header.client_packet_count = htons(client.m_packet_count);
+            fragment_header.index = i;
+
+            auto *fragment_header_data = reinterpret_cast<std::byte *>(&fragment_header);
+            auto *fragment_data = data + i * fragment_size;
+            auto fragment_length = std::min(fragment_size, size - i * fragment_size);
+
+            packet_data.assign(header.data(), header.data() + sizeof(Packet));
+            packet_data.insert(packet_data.end(), fragment_header_data, fragment_header_data + sizeof(FragmentHeader));
+            packet_data.insert(packet_data.end(), fragment_data, fragment_data + fragment_length);
+            send_packet(client, packet_data.data(), packet_data.size());
+        }
+        return true;
+    }
+
+    void Server::replicate_objects() noexcept {
+        for(auto &event : m_interest.left()) {
+            auto *client = get_client(event.observer);
+            if(client) {
+                client->m_scheduler.remove_object(event.object);
+            }
+        }
+
+        // Objects can enter and leave a view within a tick; only those still in it are sent
+        for(auto &event : m_interest.entered()) {
+            auto *client = get_client(event.observer);
+            if(client && m_interest.relevant(event.observer, event.object)) {
+                queue_object(*client, event.object);
+            }
+        }
+
+        // Only clients watching the cell of an updated object get its new state
+        for(auto object : m_interest.updated_objects()) {
+            for(auto watcher : m_interest.watchers(object)) {
+                auto *client = get_client(watcher);
+                if(client) {
+                    queue_object(*client, object);
+                }
+            }
+        }
+
+        m_interest.clear_changes();
+    }
+
+    void Server::queue_object(Client &client, object_id_t object) noexcept {
+        auto it = m_objects.find(object);
+        if(it == m_objects.end()) {
+            return;
+        }
+
+        // Closer objects earn priority faster
+        auto &entry = it->second;
+        float distance = std::sqrt(m_interest.distance_squared(client.m_id, object));
+        float priority = entry.priority / (1.0f + distance);
+        client.m_scheduler.queue_update(object, priority, entry.state.data(), entry.state.size());
+    }
+
+    void Server::process_message(Client &client, const Reassembler::Message &) noexcept {
+        // Game messages are not decoded yet
+        client.m_received_messages++;
+    }
+
+    void Server::register_metrics() noexcept {
+        auto &metrics = m_engine.metrics();
+        for(auto &[type, label] : c_packet_type_labels) {
+            auto labels = std::string("type=\"") + label + "\"";
+            m_metrics.packets_received.push_back(&metrics.counter("blamite_packets_received_total", "Datagrams received by packet type.", labels));
+            m_metrics.packets_sent.push_back(&metrics.counter("blamite_packets_sent_total", "Datagrams sent by packet type.", labels));
+        }
+        m_metrics.packets_received.push_back(&metrics.counter("blamite_packets_received_total", "Datagrams received by packet type.", "type=\"unknown\""));
+        m_metrics.packets_sent.push_back(&metrics.counter("blamite_packets_sent_total", "Datagrams sent by packet type.", "type=\"unknown\""));
+
+        m_metrics.bytes_received = &metrics.counter("blamite_received_bytes_total", "Bytes received.");
+        m_metrics.bytes_sent = &metrics.counter("blamite_sent_bytes_total", "Bytes sent.");
+        m_metrics.challenges = &metrics.counter("blamite_handshake_challenges_total", "Handshake challenges answered.");
+        m_metrics.handshakes = &metrics.counter("blamite_handshakes_total", "Handshakes accepted.");
+        for(auto *label : c_refusal_labels) {
+            m_metrics.refusals.push_back(&metrics.counter("blamite_connections_refused_total", "Refused connections by reason.", std::string("reason=\"") + label + "\""));
+        }
+
+        std::vector<double> crypto_buckets = {0.00001, 0.000025, 0.00005, 0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01};
+        m_metrics.challenge_time = &metrics.histogram("blamite_crypto_duration_seconds", "Time spent on handshake cryptography.", crypto_buckets, "operation=\"challenge\"");
+        m_metrics.key_time = &metrics.histogram("blamite_crypto_duration_seconds", "Time spent on handshake cryptography.", crypto_buckets, "operation=\"keys\"");
+
+        m_metrics.received_queue = &metrics.gauge("blamite_received_datagrams", "Datagrams read on the last tick, waiting to be processed.");
+        m_metrics.deferred_updates = &metrics.gauge("blamite_deferred_updates", "Object updates deferred by client bandwidth budgets on the last tick.");
+    }
+
+    std::pmr::vector<std::byte> Server::resolve_handshake_challenge(std::byte *challenge) noexcept {
+        TRACE_SCOPE("resolve challenge");
+        auto start = std::chrono::steady_clock::now();
+        std::pmr::vector<std::byte> output(32, std::byte(0), &m_engine.frame_arena());
         gssdkcr(reinterpret_cast<unsigned char *>(output.data()), reinterpret_cast<unsigned char *>(challenge), NULL);
-        return std::move(output);
+        m_metrics.challenge_time->observe(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+        return output;
+    }
+
+    void Server::transmit(const void *data, std::size_t size, const sockpp::inet_address &address) noexcept {
+        m_transport->send_to(data, size, address);
+        m_metrics.packets_sent[packet_type_index(data, size)]->add();
+        m_metrics.bytes_sent->add(size);
+        if(m_capture) {
+            m_capture->record(PacketCapture::DIRECTION_OUT, address, data, size);
+        }
     }
 
     void Server::refuse_connection(sockpp::inet_address address, ConnectionRefusePacket::Reason reason) noexcept {
@@ -186,12 +640,85 @@ namespace Blamite::Engine::Network {
         response.client_packet_count = htons(2);
         response.reason = reason;
 
-        m_socket.send_to(&response, sizeof(response), address);
+        transmit(&response, sizeof(response), address);
+        m_metrics.refusals[reason - ConnectionRefusePacket::REASON_INCOMPATIBLE_NETWORK_PROTOCOL_VERSION]->add();
 
-        auto &console = Engine::get().console();
+        auto &console = m_engine.console();
         auto address_str = address.to_string();
         auto reason_str = ConnectionRefusePacket::get_reason_string(reason);
-        console.printf("Refused connection from %s. Reason: %s", address_str.c_str(), reason_str.c_str());
+        CONSOLE_WARNING(console, "Refused connection from %s. Reason: %s", address_str.c_str(), reason_str.c_str());
+
+        if(auto *event_log = m_engine.event_log()) {
+            RefuseEvent event;
+            event.address = address.address();
+            event.port = address.port();
+            event.reason = reason;
+            event_log->write(event);
+        }
+    }
+
+    void Server::send_handshake(Client &client) noexcept {
+        ServerHandshake response;
+        response.header.type = PACKET_TYPE_HANDSHAKE_SUCCESS;
+        response.server_packet_count = htons(1);
+        response.client_packet_count = htons(2);
+
+        std::copy(client.m_public_key, client.m_public_key + sizeof(client.m_public_key), response.enc_key);
+
+        send_packet(client, response.data(), sizeof(ServerHandshake));
+
+        // Keep resending until the client answers
+        m_timers.cancel(client.m_retransmit_timer);
+        client.m_retransmit_timer = m_timers.schedule(c_retransmit_interval, [this, &client]() {
+            if(client.m_retransmit_count == c_max_retransmits) {
+                auto &console = m_engine.console();
+                CONSOLE_INFO(console, "Client %s did not complete handshake.", client.m_address.to_string().c_str());
+                drop_client(client, DISCONNECT_REASON_HANDSHAKE_TIMEOUT);
+                return;
+            }
+            client.m_retransmit_count++;
+            send_handshake(client);
+        });
+    }
+
+    void Server::send_keepalive(Client &client) noexcept {
+        Packet keepalive;
+        keepalive.header.type = PACKET_TYPE_ENCRYPTED;
+        keepalive.server_packet_count = htons(client.m_server_packet_count);
+        keepalive.client_packet_count = htons(client.m_packet_count);
+
+        // Sending reschedules the next keepalive
+        send_packet(client, keepalive.data(), sizeof(Packet));
+    }
+
+    void Server::touch_client(Client &client) noexcept {
+        m_timers.cancel(client.m_timeout_timer);
+        client.m_timeout_timer = m_timers.schedule(c_client_timeout, [this, &client]() {
+            auto &console = m_engine.console();
+            CONSOLE_INFO(console, "Client %s timed out.", client.m_address.to_string().c_str());
+            drop_client(client, DISCONNECT_REASON_TIMEOUT);
+        });
+    }
+
+    void Server::drop_client(Client &client, DisconnectReason reason) noexcept {
+        if(auto *event_log = m_engine.event_log()) {
+            DisconnectEvent event;
+            event.client_id = client.m_id;
+            event.reason = reason;
+            event_log->write(event);
+        }
+
+        m_interest.remove_observer(client.m_id);
+        m_timers.cancel(client.m_timeout_timer);
+        m_timers.cancel(client.m_keepalive_timer);
+        m_timers.cancel(client.m_retransmit_timer);
+
+        auto client_it = std::find_if(m_clients.begin(), m_clients.end(), [&client](auto &entry) {
+            return entry.get() == &client;
+        });
+        if(client_it != m_clients.end()) {
+            m_clients.erase(client_it);
+        }
     }
 
     void Server::disconnect_clients() noexcept {
@@ -200,10 +727,10 @@ namespace Blamite::Engine::Network {
         auto *packet_data = reinterpret_cast<std::byte *>(&disconnection_packet);
 
         // Disconnect clients
-        auto client_it = m_clients.begin();
-        while(client_it != m_clients.end()) {
-            send_packet(client_it->m_address, raw_packet_t(packet_data, packet_data + sizeof(disconnection_packet)));
-            client_it = m_clients.erase(client_it);
+        while(!m_clients.empty()) {
+            auto &client = *m_clients.back();
+            send_packet(client, packet_data, sizeof(disconnection_packet));
+            drop_client(client, DISCONNECT_REASON_SHUTDOWN);
         }
     }
 }
@@ -0,0 +1,40 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <sstream>
+#include <stdexcept>
+#include <blamite/network/transport.hpp>
+
+namespace Blamite::Engine::Network {
+    ssize_t UdpTransport::send_to(const void *data, std::size_t size, const sockpp::inet_address &address) noexcept {
+        return m_socket.send_to(data, size, address);
+    }
+
+    ssize_t UdpTransport::receive_from(void *buffer, std::size_t capacity, sockpp::inet_address *sender) noexcept {
+        return m_socket.recv_from(buffer, capacity, sender);
+    }
+
+    sockpp::inet_address UdpTransport::address() const noexcept {
+        return m_socket.address();
+    }
+
+    UdpTransport::UdpTransport(in_port_t port) {
+        if(!m_socket) {
+            std::stringstream ss;
+            ss << "Error creating the UDP v4 socket: " << m_socket.last_error_str();
+            throw std::runtime_error(ss.str());
+        }
+
+        if(!m_socket.bind(sockpp::inet_address("localhost", port))) {
+            std::stringstream ss;
+            ss << "Error binding the UDP v4 socket: " << m_socket.last_error_str();
+            throw std::runtime_error(ss.str());
+        }
+
+        m_socket.set_non_blocking(true);
+    }
+
+    UdpTransport::~UdpTransport() noexcept {
+        m_socket.shutdown(SHUT_RD);
+        m_socket.close();
+    }
+}
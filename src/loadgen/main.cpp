@@ -0,0 +1,452 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <map>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include <algorithm>
+#ifdef _WIN32
+#include <winsock2.h>
+#define poll WSAPoll
+#else
+#include <poll.h>
+#include <sys/resource.h>
+#endif
+#include <sockpp/udp_socket.h>
+#include <blamite/core/version.hpp>
+#include <blamite/network/fragment.hpp>
+#include <blamite/network/packet.hpp>
+#include <aluigi/pck_algo.h>
+#include <aluigi/gssdkcr.h>
+
+using namespace Blamite::Engine;
+using namespace Blamite::Engine::Network;
+using steady_clock = std::chrono::steady_clock;
+
+struct Options {
+    /** Server address */
+    std::string host = "127.0.0.1";
+    in_port_t port = 2302;
+
+    /** Simulated clients */
+    std::size_t clients = 100;
+
+    /** Handshakes started per second */
+    double connect_rate = 100.0;
+
+    /** Encrypted packets sent per second by each connected client */
+    double packet_rate = 30.0;
+
+    /** Encrypted payload size */
+    std::size_t payload = 64;
+
+    /** Seconds to run */
+    double duration = 10.0;
+
+    /** Print report as JSON */
+    bool json = false;
+};
+
+struct Client {
+    enum State {
+        STATE_IDLE,
+        STATE_CHALLENGING,
+        STATE_HANDSHAKING,
+        STATE_CONNECTED,
+        STATE_REFUSED,
+        STATE_TIMED_OUT,
+        STATE_DISCONNECTED
+    };
+
+    /** Client socket; each client has its own port, which is how the server tells them apart */
+    sockpp::udp_socket socket;
+
+    /** Handshake state */
+    State state = STATE_IDLE;
+
+    /** Handshake start */
+    steady_clock::time_point started;
+
+    /** Last handshake request, resent if unanswered */
+    std::vector<std::byte> request;
+
+    /** Last time the request was sent */
+    steady_clock::time_point request_sent;
+
+    /** Times the request was sent again */
+    std::size_t retries = 0;
+
+    /** Next encrypted packet time */
+    steady_clock::time_point next_packet;
+
+    /** Challenge sent to the server */
+    std::byte challenge[32];
+
+    /** Keys */
+    std::uint8_t private_key[17];
+    std::uint8_t public_key[16];
+    std::uint8_t enc_key[16];
+    std::uint8_t dec_key[16];
+
+    /** Packet counts */
+    std::uint16_t packet_count = 1;
+    std::uint16_t server_packet_count = 0;
+
+    /** Next message identifier */
+    std::uint16_t next_message_id = 0;
+};
+
+struct Report {
+    std::size_t started = 0;
+    std::size_t connected = 0;
+    std::size_t timed_out = 0;
+    std::size_t disconnected = 0;
+    std::size_t bad_challenges = 0;
+    std::map<std::uint32_t, std::size_t> refusals;
+
+    /** Handshake latencies in microseconds */
+    std::vector<double> latencies;
+
+    std::size_t packets_sent = 0;
+    std::size_t bytes_sent = 0;
+    std::size_t packets_received = 0;
+    std::size_t bytes_received = 0;
+};
+
+/** Time to wait for a handshake answer before asking again */
+static constexpr auto c_retransmit_interval = std::chrono::seconds(1);
+
+/** Handshake requests sent before giving up */
+static constexpr std::size_t c_max_retries = 5;
+
+static void send_request(Client &client, const sockpp::inet_address &server, Report &report, steady_clock::time_point now) {
+    client.socket.send_to(client.request.data(), client.request.size(), server);
+    client.request_sent = now;
+    report.packets_sent++;
+    report.bytes_sent += client.request.size();
+}
+
+template<typename T> static void set_request(Client &client, T &packet) {
+    auto *data = reinterpret_cast<std::byte *>(&packet);
+    client.request.assign(data, data + sizeof(T));
+}
+
+static void start_handshake(Client &client, const sockpp::inet_address &server, Report &report, std::mt19937 &random, steady_clock::time_point now) {
+    ClientChallengePacket packet = {};
+    packet.header.type = PACKET_TYPE_HANDSHAKE_CLIENT_CHALLENGE;
+    packet.server_packet_count = htons(0);
+    packet.client_packet_count = htons(client.packet_count);
+
+    // Real clients send a printable hex challenge
+    static constexpr char hex[] = "0123456789abcdef";
+    for(auto &byte : client.challenge) {
+        byte = static_cast<std::byte>(hex[random() % 16]);
+    }
+    client.challenge[sizeof(client.challenge) - 1] = std::byte(0);
+    std::copy(std::begin(client.challenge), std::end(client.challenge), packet.challenge);
+
+    client.state = Client::STATE_CHALLENGING;
+    client.started = now;
+    client.retries = 0;
+    set_request(client, packet);
+    send_request(client, server, report, now);
+    report.started++;
+}
+
+/**
+ * Send a message the way the server fragments its own: packet header and fragment header in clear, followed by
+ * the payload and its checksum encrypted with the negotiated key. The server does not decrypt inbound messages
+ * yet, so only the payload is encrypted.
+ */
+static void send_message(Client &client, const sockpp::inet_address &server, const Options &options, Report &report) {
+    std::vector<std::byte> datagram(sizeof(Packet) + sizeof(FragmentHeader) + options.payload + sizeof(crc32_t));
+
+    auto &header = *reinterpret_cast<Packet *>(datagram.data());
+    header.header = PacketHeader();
+    header.header.type = PACKET_TYPE_ENCRYPTED;
+    header.server_packet_count = htons(client.server_packet_count);
+    header.client_packet_count = htons(++client.packet_count);
+
+    auto &fragment = *reinterpret_cast<FragmentHeader *>(datagram.data() + sizeof(Packet));
+    fragment.message_id = client.next_message_id++;
+    fragment.index = 0;
+    fragment.count = 1;
+
+    auto *payload = reinterpret_cast<std::uint8_t *>(datagram.data() + sizeof(Packet) + sizeof(FragmentHeader));
+    for(std::size_t i = 0; i < options.payload; i++) {
+        payload[i] = static_cast<std::uint8_t>(i);
+    }
+    crc32_t crc = halo_crc32(payload, options.payload);
+    std::memcpy(payload + options.payload, &crc, sizeof(crc));
+    halo_tea_encrypt(payload, options.payload + sizeof(crc), client.enc_key);
+
+    client.socket.send_to(datagram.data(), datagram.size(), server);
+    report.packets_sent++;
+    report.bytes_sent += datagram.size();
+}
+
+static void receive(Client &client, const sockpp::inet_address &server, Report &report, steady_clock::time_point now) {
+    std::byte buffer[4096];
+    while(true) {
+        auto size = client.socket.recv_from(buffer, sizeof(buffer));
+        if(size <= 0) {
+            return;
+        }
+        report.packets_received++;
+        report.bytes_received += size;
+
+        if(static_cast<std::size_t>(size) < sizeof(PacketHeader)) {
+            continue;
+        }
+        auto *header = reinterpret_cast<PacketHeader *>(buffer);
+        if(size >= static_cast<ssize_t>(sizeof(Packet))) {
+            client.server_packet_count = ntohs(reinterpret_cast<Packet *>(buffer)->server_packet_count);
+        }
+
+        switch(header->type) {
+            case PACKET_TYPE_HANDSHAKE_SERVER_RESPONSE_CHALLENGE: {
+                if(client.state != Client::STATE_CHALLENGING || size < static_cast<ssize_t>(sizeof(ServerChallengeResponsePacket))) {
+                    break;
+                }
+                auto *response = reinterpret_cast<ServerChallengeResponsePacket *>(buffer);
+
+                // The server must have solved our challenge
+                std::byte expected[32] = {};
+                gssdkcr(reinterpret_cast<unsigned char *>(expected), reinterpret_cast<unsigned char *>(client.challenge), NULL);
+                if(std::memcmp(expected, response->client_challenge_response, sizeof(expected)) != 0) {
+                    report.bad_challenges++;
+                }
+
+                ClientHandshake packet = {};
+                packet.header.type = PACKET_TYPE_HANDSHAKE_CLIENT_RESPONSE;
+                packet.server_packet_count = htons(client.server_packet_count);
+                packet.client_packet_count = htons(++client.packet_count);
+                gssdkcr(reinterpret_cast<unsigned char *>(packet.server_challenge_response), reinterpret_cast<unsigned char *>(response->challenge), NULL);
+                halo_generate_keys(client.private_key, NULL, client.public_key);
+                std::copy(std::begin(client.public_key), std::end(client.public_key), packet.enc_key);
+                packet.version = CLIENT_VERSION;
+
+                client.state = Client::STATE_HANDSHAKING;
+                client.retries = 0;
+                set_request(client, packet);
+                send_request(client, server, report, now);
+                break;
+            }
+
+            case PACKET_TYPE_HANDSHAKE_SUCCESS: {
+                if(client.state != Client::STATE_HANDSHAKING || size < static_cast<ssize_t>(sizeof(ServerHandshake))) {
+                    break;
+                }
+                auto *response = reinterpret_cast<ServerHandshake *>(buffer);
+                halo_generate_keys(client.private_key, response->enc_key, client.dec_key);
+                halo_generate_keys(client.private_key, response->enc_key, client.enc_key);
+
+                client.state = Client::STATE_CONNECTED;
+                client.next_packet = now;
+                report.connected++;
+                report.latencies.push_back(std::chrono::duration<double, std::micro>(now - client.started).count());
+                break;
+            }
+
+            case PACKET_TYPE_HANDSHAKE_FAILED: {
+                if(client.state == Client::STATE_REFUSED || size < static_cast<ssize_t>(sizeof(ConnectionRefusePacket))) {
+                    break;
+                }
+                client.state = Client::STATE_REFUSED;
+                report.refusals[reinterpret_cast<ConnectionRefusePacket *>(buffer)->reason]++;
+                break;
+            }
+
+            case PACKET_TYPE_DISCONNECTION:
+                if(client.state == Client::STATE_CONNECTED) {
+                    client.state = Client::STATE_DISCONNECTED;
+                    report.disconnected++;
+                }
+                break;
+
+            default:
+                break;
+        }
+    }
+}
+
+static double percentile(const std::vector<double> &sorted, double fraction) {
+    if(sorted.empty()) {
+        return 0.0;
+    }
+    auto index = static_cast<std::size_t>(fraction * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+static void print_report(Report &report, const Options &options, double elapsed) {
+    std::sort(report.latencies.begin(), report.latencies.end());
+    double p50 = percentile(report.latencies, 0.50) / 1000.0;
+    double p90 = percentile(report.latencies, 0.90) / 1000.0;
+    double p99 = percentile(report.latencies, 0.99) / 1000.0;
+    double max = report.latencies.empty() ? 0.0 : report.latencies.back() / 1000.0;
+    std::size_t refused = 0;
+    for(auto &[reason, count] : report.refusals) {
+        refused += count;
+    }
+
+    if(options.json) {
+        std::printf(R"({"elapsed":%.3f,"started":%zu,"connected":%zu,"refused":%zu,"timed_out":%zu,"disconnected":%zu,"bad_challenges":%zu,)", elapsed, report.started, report.connected, refused, report.timed_out, report.disconnected, report.bad_challenges);
+        std::printf(R"("latency_ms":{"p50":%.3f,"p90":%.3f,"p99":%.3f,"max":%.3f},)", p50, p90, p99, max);
+        std::printf(R"("sent":{"packets":%zu,"bytes":%zu},"received":{"packets":%zu,"bytes":%zu},"refusals":{)", report.packets_sent, report.bytes_sent, report.packets_received, report.bytes_received);
+        bool first = true;
+        for(auto &[reason, count] : report.refusals) {
+            std::printf(R"(%s"%u":%zu)", first ? "" : ",", reason, count);
+            first = false;
+        }
+        std::printf("}}\n");
+        return;
+    }
+
+    std::printf("Clients: %zu started, %zu connected, %zu refused, %zu timed out, %zu disconnected by server\n", report.started, report.connected, refused, report.timed_out, report.disconnected);
+    for(auto &[reason, count] : report.refusals) {
+        auto reason_str = ConnectionRefusePacket::get_reason_string(static_cast<ConnectionRefusePacket::Reason>(reason));
+        std::printf("  refused %zu times: %s (%u)\n", count, reason_str.empty() ? "unknown" : reason_str.c_str(), reason);
+    }
+    if(report.bad_challenges > 0) {
+        std::printf("Wrong challenge answers: %zu\n", report.bad_challenges);
+    }
+    std::printf("Handshake latency: p50 %.3fms, p90 %.3fms, p99 %.3fms, max %.3fms\n", p50, p90, p99, max);
+    std::printf("Sent: %zu packets (%.0f/s, %.1f KiB/s)\n", report.packets_sent, report.packets_sent / elapsed, report.bytes_sent / elapsed / 1024.0);
+    std::printf("Received: %zu packets (%.0f/s, %.1f KiB/s)\n", report.packets_received, report.packets_received / elapsed, report.bytes_received / elapsed / 1024.0);
+}
+
+int main(int argc, const char **argv) {
+    Options options;
+    std::vector<const char *> args;
+    for(int i = 1; i < argc; i++) {
+        if(std::strcmp(argv[i], "--host") == 0 && i + 1 < argc) {
+            options.host = argv[++i];
+        }
+        else if(std::strcmp(argv[i], "--clients") == 0 && i + 1 < argc) {
+            options.clients = std::max(atoi(argv[++i]), 1);
+        }
+        else if(std::strcmp(argv[i], "--connect-rate") == 0 && i + 1 < argc) {
+            options.connect_rate = std::max(atof(argv[++i]), 0.001);
+        }
+        else if(std::strcmp(argv[i], "--packet-rate") == 0 && i + 1 < argc) {
+            options.packet_rate = std::max(atof(argv[++i]), 0.0);
+        }
+        else if(std::strcmp(argv[i], "--payload") == 0 && i + 1 < argc) {
+            // TEA works on 8 byte blocks
+            options.payload = std::clamp(atoi(argv[++i]), 8, 1024);
+        }
+        else if(std::strcmp(argv[i], "--duration") == 0 && i + 1 < argc) {
+            options.duration = std::max(atof(argv[++i]), 0.1);
+        }
+        else if(std::strcmp(argv[i], "--json") == 0) {
+            options.json = true;
+        }
+        else if(argv[i][0] == '-') {
+            std::fprintf(stderr, "Usage: %s [--host <address>] [--clients <n>] [--connect-rate <n/s>] [--packet-rate <n/s>] [--payload <bytes>] [--duration <s>] [--json] [port]\n", argv[0]);
+            return 1;
+        }
+        else {
+            args.push_back(argv[i]);
+        }
+    }
+    if(args.size() > 0) {
+        options.port = atoi(args[0]);
+    }
+
+    // One socket per client; thousands of them need more descriptors than the usual default
+    #ifndef _WIN32
+    rlimit limit;
+    if(getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+    #endif
+
+    sockpp::socket_initializer sock_init;
+    sockpp::inet_address server(options.host, options.port);
+    std::vector<std::unique_ptr<Client>> clients;
+    std::vector<pollfd> poll_fds;
+    for(std::size_t i = 0; i < options.clients; i++) {
+        auto &client = *clients.emplace_back(std::make_unique<Client>());
+        if(!client.socket || !client.socket.bind(sockpp::inet_address("localhost", 0))) {
+            std::fprintf(stderr, "Failed to open socket for client %zu: %s\n", i, client.socket.last_error_str().c_str());
+            return 1;
+        }
+        client.socket.set_non_blocking(true);
+        poll_fds.push_back({client.socket.handle(), POLLIN, 0});
+    }
+
+    Report report;
+    std::mt19937 random(std::random_device{}());
+    // A rate of 0 only connects clients and keeps them quiet
+    bool send_packets = options.packet_rate > 0.0;
+    auto packet_interval = send_packets ? std::chrono::duration_cast<steady_clock::duration>(std::chrono::duration<double>(1.0 / options.packet_rate)) : steady_clock::duration::zero();
+    auto start = steady_clock::now();
+    auto end = start + std::chrono::duration_cast<steady_clock::duration>(std::chrono::duration<double>(options.duration));
+    std::size_t next_client = 0;
+
+    if(!options.json) {
+        std::printf("Simulating %zu clients against %s for %.1fs\n", options.clients, server.to_string().c_str(), options.duration);
+    }
+
+    auto now = start;
+    while(now < end) {
+        // New handshakes at the connection rate
+        std::size_t due = std::min<std::size_t>(options.clients, std::chrono::duration<double>(now - start).count() * options.connect_rate + 1);
+        while(next_client < due) {
+            start_handshake(*clients[next_client++], server, report, random, now);
+        }
+
+        for(auto &client_ptr : clients) {
+            auto &client = *client_ptr;
+            if(client.state == Client::STATE_CHALLENGING || client.state == Client::STATE_HANDSHAKING) {
+                if(now - client.request_sent < c_retransmit_interval) {
+                    continue;
+                }
+                if(client.retries == c_max_retries) {
+                    client.state = Client::STATE_TIMED_OUT;
+                    report.timed_out++;
+                    continue;
+                }
+                client.retries++;
+                send_request(client, server, report, now);
+            }
+            else if(send_packets && client.state == Client::STATE_CONNECTED && now >= client.next_packet) {
+                send_message(client, server, options, report);
+                client.next_packet += packet_interval;
+
+                // Do not burst to catch up after a stall
+                if(client.next_packet < now) {
+                    client.next_packet = now + packet_interval;
+                }
+            }
+        }
+
+        if(poll(poll_fds.data(), poll_fds.size(), 1) > 0) {
+            now = steady_clock::now();
+            for(std::size_t i = 0; i < poll_fds.size(); i++) {
+                if(poll_fds[i].revents & POLLIN) {
+                    receive(*clients[i], server, report, now);
+                }
+            }
+        }
+        now = steady_clock::now();
+    }
+
+    // Leave so the server frees the slots right away
+    PacketHeader disconnection;
+    disconnection.type = PACKET_TYPE_DISCONNECTION;
+    for(auto &client : clients) {
+        if(client->state == Client::STATE_CONNECTED) {
+            client->socket.send_to(&disconnection, sizeof(disconnection), server);
+        }
+    }
+
+    print_report(report, options, std::chrono::duration<double>(now - start).count());
+    return 0;
+}
@@ -0,0 +1,190 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <vector>
+#include <blamite/core/event_log.hpp>
+#include <blamite/network/packet.hpp>
+
+using namespace Blamite::Engine;
+
+/**
+ * Format an IPv4 address in host order
+ */
+static std::string format_address(std::uint32_t address, std::uint16_t port) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%u.%u.%u.%u:%u", address >> 24, (address >> 16) & 0xFF, (address >> 8) & 0xFF, address & 0xFF, port);
+    return buffer;
+}
+
+/**
+ * Format a Unix time in microseconds as UTC
+ */
+static std::string format_time(std::uint64_t time) {
+    std::time_t seconds = time / 1000000;
+    std::tm calendar;
+    #ifdef _WIN32
+    gmtime_s(&calendar, &seconds);
+    #else
+    gmtime_r(&seconds, &calendar);
+    #endif
+
+    char buffer[64];
+    auto length = std::strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", &calendar);
+    std::snprintf(buffer + length, sizeof(buffer) - length, ".%06u", static_cast<unsigned>(time % 1000000));
+    return buffer;
+}
+
+template<typename T> static bool read_payload(const std::vector<std::byte> &payload, T &event) {
+    if(payload.size() < sizeof(T)) {
+        return false;
+    }
+    std::memcpy(&event, payload.data(), sizeof(T));
+    return true;
+}
+
+/**
+ * Print a record
+ * @return  False if the payload is too short for its type
+ */
+static bool print_record(const EventHeader &header, const std::vector<std::byte> &payload, bool json) {
+    auto type = static_cast<EventType>(header.type);
+    char buffer[256];
+
+    switch(type) {
+        case EVENT_TYPE_CONNECT: {
+            ConnectEvent event;
+            if(!read_payload(payload, event)) {
+                return false;
+            }
+            auto address = format_address(event.address, event.port);
+            std::snprintf(buffer, sizeof(buffer), json ? R"("client":%u,"address":"%s")" : "client=%u address=%s", event.client_id, address.c_str());
+            break;
+        }
+
+        case EVENT_TYPE_REFUSE: {
+            RefuseEvent event;
+            if(!read_payload(payload, event)) {
+                return false;
+            }
+            auto address = format_address(event.address, event.port);
+            auto reason = Network::ConnectionRefusePacket::get_reason_string(static_cast<Network::ConnectionRefusePacket::Reason>(event.reason));
+            std::snprintf(buffer, sizeof(buffer), json ? R"("address":"%s","reason":%u,"reason_name":"%s")" : "address=%s reason=%u (%s)", address.c_str(), event.reason, reason.c_str());
+            break;
+        }
+
+        case EVENT_TYPE_DISCONNECT: {
+            DisconnectEvent event;
+            if(!read_payload(payload, event)) {
+                return false;
+            }
+            auto reason = disconnect_reason_name(static_cast<DisconnectReason>(event.reason));
+            std::snprintf(buffer, sizeof(buffer), json ? R"("client":%u,"reason":"%s")" : "client=%u reason=%s", event.client_id, reason);
+            break;
+        }
+
+        case EVENT_TYPE_TICK_STATS: {
+            TickStatsEvent event;
+            if(!read_payload(payload, event)) {
+                return false;
+            }
+            std::snprintf(buffer, sizeof(buffer), json ? R"("tick":%llu,"duration_us":%u,"clients":%u,"entities":%u)" : "tick=%llu duration=%uus clients=%u entities=%u", static_cast<unsigned long long>(event.tick), event.duration, event.clients, event.entities);
+            break;
+        }
+
+        case EVENT_TYPE_DROPPED: {
+            DroppedEvent event;
+            if(!read_payload(payload, event)) {
+                return false;
+            }
+            std::snprintf(buffer, sizeof(buffer), json ? R"("count":%llu)" : "count=%llu", static_cast<unsigned long long>(event.count));
+            break;
+        }
+
+        default:
+            std::snprintf(buffer, sizeof(buffer), json ? R"("type_id":%u,"size":%u)" : "type=%u size=%u", header.type, header.size);
+            break;
+    }
+
+    if(json) {
+        std::printf(R"({"time":%llu,"type":"%s",%s})" "\n", static_cast<unsigned long long>(header.time), event_type_name(type), buffer);
+    }
+    else {
+        std::printf("%s %-10s %s\n", format_time(header.time).c_str(), event_type_name(type), buffer);
+    }
+    return true;
+}
+
+/**
+ * Decode a log file
+ * @return  False if the file is unreadable or damaged
+ */
+static bool dump_file(const char *path, bool json) {
+    auto *file = std::fopen(path, "rb");
+    if(!file) {
+        std::fprintf(stderr, "%s: %s\n", path, std::strerror(errno));
+        return false;
+    }
+
+    EventLogHeader file_header;
+    if(std::fread(&file_header, sizeof(file_header), 1, file) != 1 || std::memcmp(file_header.magic, EventLogHeader::MAGIC, sizeof(file_header.magic)) != 0) {
+        std::fprintf(stderr, "%s: not an event log\n", path);
+        std::fclose(file);
+        return false;
+    }
+    if(file_header.version != EventLogHeader::VERSION) {
+        std::fprintf(stderr, "%s: unsupported version %u\n", path, file_header.version);
+        std::fclose(file);
+        return false;
+    }
+
+    bool ok = true;
+    std::size_t records = 0;
+    std::vector<std::byte> payload;
+    EventHeader header;
+    while(std::fread(&header, sizeof(header), 1, file) == 1) {
+        payload.resize(header.size);
+        if(std::fread(payload.data(), 1, payload.size(), file) != payload.size()) {
+            // The server was probably killed halfway through a write
+            std::fprintf(stderr, "%s: truncated record after %zu records\n", path, records);
+            ok = false;
+            break;
+        }
+        if(!print_record(header, payload, json)) {
+            std::fprintf(stderr, "%s: record %zu is too short for its type\n", path, records);
+            ok = false;
+        }
+        records++;
+    }
+
+    std::fclose(file);
+    return ok;
+}
+
+int main(int argc, const char **argv) {
+    bool json = false;
+    std::vector<const char *> paths;
+    for(int i = 1; i < argc; i++) {
+        if(std::strcmp(argv[i], "--json") == 0) {
+            json = true;
+        }
+        else {
+            paths.push_back(argv[i]);
+        }
+    }
+
+    if(paths.empty()) {
+        std::fprintf(stderr, "Usage: %s [--json] <event log>...\n", argv[0]);
+        return 1;
+    }
+
+    // Rotated files should be given oldest first
+    bool ok = true;
+    for(auto *path : paths) {
+        ok = dump_file(path, json) && ok;
+    }
+    return ok ? 0 : 1;
+}
@@ -1,17 +1,177 @@
 // SPDX-License-Identifier: GPL-3.0-only
 
-#include <blamite/engine.hpp>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include <cpp-terminal/base.hpp>
+#include <blamite/host.hpp>
 
-Blamite::Engine::Engine blamite_engine;    
+/**
+ * Feed a traffic recording to a server, as fast as possible or at the tick rate, and report throughput
+ */
+static int replay(const char *path, bool realtime, bool headless, int port) {
+    using namespace Blamite::Engine;
+    using steady_clock = std::chrono::steady_clock;
+
+    std::unique_ptr<Network::TrafficReplay> recording;
+    try {
+        recording = std::make_unique<Network::TrafficReplay>(path);
+    }
+    catch(std::runtime_error &error) {
+        std::fprintf(stderr, "%s\n", error.what());
+        return 1;
+    }
+    auto seed = recording->header().seed;
+    auto recording_tick_rate = recording->header().tick_rate;
+
+    std::size_t cores = std::max(std::thread::hardware_concurrency(), 1u);
+    JobSystem jobs(cores - 1);
+    Engine engine;
+    engine.bind();
+    engine.set_job_system(&jobs);
+    engine.init_console(headless);
+
+    auto transport = std::make_unique<Network::ReplayTransport>(std::move(recording), sockpp::inet_address("127.0.0.1", port));
+    auto &replay = *transport;
+    engine.init_server(std::move(transport));
+    engine.server().set_random_seed(seed);
+
+    engine.set_tick_rate(recording_tick_rate);
+
+    auto &console = engine.console();
+    console.printf("Replaying %s at %u ticks per second %s", path, recording_tick_rate, realtime ? "in real time" : "as fast as possible");
+
+    auto start = steady_clock::now();
+    auto next_tick = start;
+    std::size_t ticks = 0;
+    while(!replay.finished() && !engine.stopped()) {
+        replay.advance();
+        if(replay.tick_rate() != engine.tick_rate()) {
+            engine.set_tick_rate(replay.tick_rate());
+        }
+        engine.tick();
+        ticks++;
+        if(realtime) {
+            next_tick += engine.tick_period();
+            std::this_thread::sleep_until(next_tick);
+        }
+    }
+    std::chrono::duration<double> elapsed = steady_clock::now() - start;
+
+    console.printf("Replayed %zu datagrams over %zu ticks in %.3fs: %.0f datagrams/s, %.0f ticks/s, %.1fus per tick", 
+        replay.received(), ticks, elapsed.count(), replay.received() / elapsed.count(), ticks / elapsed.count(), elapsed.count() * 1000000.0 / std::max<std::size_t>(ticks, 1));
+    console.printf("Server sent %zu datagrams", replay.sent());
+    console.render();
+    return 0;
+}
 
 int main(int argc, const char **argv) {
+    // Options can go anywhere; everything else is positional
+    bool headless = !Term::Private::is_stdout_a_tty();
+    const char *command_fifo = nullptr;
+    const char *event_log = nullptr;
+    const char *record = nullptr;
+    const char *replay_path = nullptr;
+    int metrics_port = 0;
+    int tick_rate = Blamite::Engine::DEFAULT_TICK_RATE;
+    int idle_tick_rate = 0;
+    bool replay_realtime = false;
+    std::size_t instances = 1;
+    std::vector<const char *> args;
+    for(int i = 1; i < argc; i++) {
+        if(std::strcmp(argv[i], "--headless") == 0) {
+            headless = true;
+        }
+        else if(std::strcmp(argv[i], "--command-fifo") == 0 && i + 1 < argc) {
+            headless = true;
+            command_fifo = argv[++i];
+        }
+        else if(std::strcmp(argv[i], "--event-log") == 0 && i + 1 < argc) {
+            event_log = argv[++i];
+        }
+        else if(std::strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            record = argv[++i];
+        }
+        else if(std::strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            replay_path = argv[++i];
+        }
+        else if(std::strcmp(argv[i], "--replay-realtime") == 0) {
+            replay_realtime = true;
+        }
+        else if(std::strcmp(argv[i], "--metrics-port") == 0 && i + 1 < argc) {
+            metrics_port = atoi(argv[++i]);
+        }
+        else if(std::strcmp(argv[i], "--tick-rate") == 0 && i + 1 < argc) {
+            tick_rate = std::clamp(atoi(argv[++i]), 1, static_cast<int>(Blamite::Engine::TIMER_RATE));
+        }
+        else if(std::strcmp(argv[i], "--idle-tick-rate") == 0 && i + 1 < argc) {
+            idle_tick_rate = std::clamp(atoi(argv[++i]), 0, static_cast<int>(Blamite::Engine::TIMER_RATE));
+        }
+        else if(std::strcmp(argv[i], "--instances") == 0 && i + 1 < argc) {
+            instances = std::max(atoi(argv[++i]), 1);
+        }
+        else {
+            args.push_back(argv[i]);
+        }
+    }
+
     int port = 2302;
-    if(argc > 1) {
-        port = atoi(argv[1]);
+    if(args.size() > 0) {
+        port = atoi(args[0]);
+    }
+
+    if(replay_path) {
+        return replay(replay_path, replay_realtime, headless, port);
+    }
+
+    // Instances share stdout, so only a single one can drive the terminal
+    if(instances > 1) {
+        headless = true;
+    }
+
+    // Cores not ticking an engine help engines with their ticks
+    std::size_t cores = std::max(std::thread::hardware_concurrency(), 1u);
+    auto threads = std::min(instances, cores);
+    Blamite::Engine::EngineHost host(threads, cores - threads);
+
+    for(std::size_t i = 0; i < instances; i++) {
+        auto &engine = host.add();
+        auto instance_port = port + static_cast<int>(i);
+
+        // Commands are read by the first instance; the others take them through RCON
+        engine.init_console(headless, i == 0 ? command_fifo : nullptr, i == 0);
+        if(instances > 1) {
+            engine.console().set_line_prefix("[" + std::to_string(instance_port) + "] ");
+        }
+        engine.set_tick_rate(tick_rate);
+        engine.set_idle_tick_rate(idle_tick_rate);
+        engine.init_server(instance_port);
+
+        // Password comes from the environment so it does not show up in process lists
+        if(args.size() > 1) {
+            auto *password = std::getenv("BLAMITE_RCON_PASSWORD");
+            engine.start_rcon(atoi(args[1]) + static_cast<int>(i), password ? password : "");
+        }
+
+        if(metrics_port > 0) {
+            engine.start_metrics(metrics_port + static_cast<int>(i));
+        }
+
+        if(event_log) {
+            engine.start_event_log(instances > 1 ? std::string(event_log) + "-" + std::to_string(instance_port) : event_log);
+        }
+
+        if(record) {
+            engine.start_traffic_recording(instances > 1 ? std::string(record) + "-" + std::to_string(instance_port) : record);
+        }
     }
 
-    blamite_engine.init_server(port);
-    blamite_engine.start();
+    host.run();
 
     return 0;
 }